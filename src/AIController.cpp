@@ -5,17 +5,25 @@
 #include "Ship.h"
 #include <algorithm>
 #include <cmath>
-#include <cstdlib>
 
 AIController::AIController()
 {
     wanderTarget = { 0, 0 };
+}
+
+void AIController::reset (uint64_t matchSeed, int shipIndex)
+{
+    random.seed (matchSeed, (uint64_t) RandomStream::AI + (uint64_t) shipIndex);
+
+    moveInput = { 0, 0 };
+    aimInput = { 0, 0 };
+    fireInput = false;
+    wanderTarget = { 0, 0 };
+    wanderTimer = 0.0f;
+    currentMode = AIMode::Normal;
 
     // Generate random personality factor between 0.95 and 1.05
-    static std::random_device rd;
-    static std::mt19937 gen (rd());
-    std::uniform_real_distribution<float> dist (0.95f, 1.05f);
-    personalityFactor = dist (gen);
+    personalityFactor = random.nextFloat (params.personalityMin, params.personalityMax);
 }
 
 void AIController::update (float dt, Ship& myShip, const std::vector<const Ship*>& enemies, const std::vector<const Ship*>& friendlies, const std::vector<Shell>& shells, const std::vector<Island>& islands, float arenaWidth, float arenaHeight)
@@ -34,14 +42,14 @@ AIMode AIController::determineMode (const Ship& myShip, const std::vector<const
     float myHealthPercent = myHealth / myMaxHealth;
 
     // Scared mode: health below 25%
-    if (myHealthPercent < 0.25f)
+    if (myHealthPercent < params.scaredHealth)
         return AIMode::Scared;
 
     // Check if any enemy has much less health (below 30% of my health)
     for (const Ship* enemy : enemies)
     {
         float enemyHealthPercent = enemy->getHealth() / enemy->getMaxHealth();
-        if (enemyHealthPercent < myHealthPercent * 0.5f)
+        if (enemyHealthPercent < myHealthPercent * params.aggressiveHealthRatio)
             return AIMode::Aggressive;
     }
 
@@ -56,28 +64,21 @@ const Ship* AIController::findTarget (const Ship& myShip, const std::vector<cons
     Vec2 myPos = myShip.getPosition();
     float firingRange = myShip.getMaxRange() * personalityFactor;
 
-    // Separate enemies into in-range and out-of-range
-    std::vector<const Ship*> inRange;
-    std::vector<const Ship*> outOfRange;
-    for (const Ship* enemy : enemies)
-    {
-        float dist = (enemy->getPosition() - myPos).length();
-        if (dist <= firingRange)
-            inRange.push_back (enemy);
-        else
-            outOfRange.push_back (enemy);
-    }
-
-    // Prefer in-range enemies, fall back to out-of-range if none
-    const std::vector<const Ship*>& candidates = inRange.empty() ? outOfRange : inRange;
+    // Prefer in-range enemies, fall back to out-of-range if none. Filtered in
+    // place rather than copied out, as this runs for every AI ship each decision
+    auto isInRange = [&] (const Ship* enemy) { return (enemy->getPosition() - myPos).length() <= firingRange; };
+    bool anyInRange = std::any_of (enemies.begin(), enemies.end(), isInRange);
 
     // In aggressive mode, target the weakest enemy
     if (currentMode == AIMode::Aggressive)
     {
         const Ship* weakest = nullptr;
         float lowestHealth = 999999.0f;
-        for (const Ship* enemy : candidates)
+        for (const Ship* enemy : enemies)
         {
+            if (isInRange (enemy) != anyInRange)
+                continue;
+
             if (enemy->getHealth() < lowestHealth)
             {
                 lowestHealth = enemy->getHealth();
@@ -90,9 +91,12 @@ const Ship* AIController::findTarget (const Ship& myShip, const std::vector<cons
     // Otherwise target the nearest enemy
     const Ship* nearest = nullptr;
     float nearestDist = 999999.0f;
-    for (const Ship* enemy : candidates)
+    for (const Ship* enemy : enemies)
     {
         float dist = (enemy->getPosition() - myPos).length();
+        if ((dist <= firingRange) != anyInRange)
+            continue;
+
         if (dist < nearestDist)
         {
             nearestDist = dist;
@@ -112,7 +116,7 @@ void AIController::updateMovement (float dt, const Ship& myShip, const std::vect
 
     // Check if crashed into edge - only trigger if stuck and facing the wall
     float margin = shipLength * 0.5f;
-    Vec2 shipForward = Vec2::fromAngle (shipAngle);
+    Vec2 shipForward = myShip.getHeading();
     Vec2 toCenter = Vec2 (arenaWidth / 2.0f, arenaHeight / 2.0f) - myPos;
     bool facingWall = shipForward.dot (toCenter.normalized()) < 0.0f;  // Facing away from center
 
@@ -124,7 +128,7 @@ void AIController::updateMovement (float dt, const Ship& myShip, const std::vect
     {
         // Actually crashed into edge and facing wall - reverse and turn away
         moveInput.y = 0.5f;
-        moveInput.x = (rand() % 2 == 0) ? 1.0f : -1.0f;
+        moveInput.x = random.nextBool() ? 1.0f : -1.0f;
         wanderTarget = { arenaWidth / 2.0f, arenaHeight / 2.0f };
         wanderTimer = 2.0f;
         return;
@@ -172,9 +176,9 @@ void AIController::updateMovement (float dt, const Ship& myShip, const std::vect
         if (wanderTimer <= 0.0f)
         {
             float wanderMargin = config.aiWanderMargin;
-            wanderTarget.x = wanderMargin + (rand() / (float) RAND_MAX) * (arenaWidth - 2 * wanderMargin);
-            wanderTarget.y = wanderMargin + (rand() / (float) RAND_MAX) * (arenaHeight - 2 * wanderMargin);
-            wanderTimer = config.aiWanderInterval + (rand() / (float) RAND_MAX) * 2.0f;
+            wanderTarget.x = wanderMargin + random.nextFloat() * (arenaWidth - 2 * wanderMargin);
+            wanderTarget.y = wanderMargin + random.nextFloat() * (arenaHeight - 2 * wanderMargin);
+            wanderTimer = config.aiWanderInterval + random.nextFloat() * 2.0f;
         }
         desiredDir = (wanderTarget - myPos).normalized();
     }
@@ -207,7 +211,7 @@ void AIController::updateMovement (float dt, const Ship& myShip, const std::vect
             float myRange = myShip.getMaxRange();
 
             // Get close but not too close (stay at half firing range)
-            float idealDist = myRange * 0.5f * personalityFactor;
+            float idealDist = myRange * params.aggressiveRange * personalityFactor;
             if (dist > idealDist)
             {
                 desiredDir = toTarget.normalized();
@@ -230,7 +234,6 @@ void AIController::updateMovement (float dt, const Ship& myShip, const std::vect
         {
             Vec2 toEnemy = target->getPosition() - myPos;
             float dist = toEnemy.length();
-            float enemyAngle = target->getAngle();
             float myRange = myShip.getMaxRange();
 
             // Check how many enemies are nearby - don't try broadside maneuvers in a crowded fight
@@ -247,7 +250,7 @@ void AIController::updateMovement (float dt, const Ship& myShip, const std::vect
             if (nearbyEnemies > 1)
             {
                 // Just approach/maintain distance from target without fancy maneuvering
-                float idealDist = myRange * 0.7f * personalityFactor;
+                float idealDist = myRange * params.crowdedRange * personalityFactor;
                 if (dist > idealDist)
                 {
                     desiredDir = toEnemy.normalized();
@@ -265,20 +268,20 @@ void AIController::updateMovement (float dt, const Ship& myShip, const std::vect
             {
                 // Single enemy - use broadside tactics
                 // Calculate if we're in the enemy's firing arc (front 180 degrees)
-                Vec2 enemyForward = Vec2::fromAngle (enemyAngle);
+                Vec2 enemyForward = target->getHeading();
                 Vec2 enemyToUs = (myPos - target->getPosition()).normalized();
                 float dotProduct = enemyForward.dot (enemyToUs);
                 bool inEnemyFiringArc = dotProduct > 0.0f;  // Enemy can see us
 
                 // Ideal distance - stay just inside our max range, but outside if enemy is aiming at us
-                float idealDist = myRange * 0.9f * personalityFactor;
+                float idealDist = myRange * params.broadsideRange * personalityFactor;
                 if (inEnemyFiringArc && dist < myRange * personalityFactor)
                 {
                     // Enemy can shoot at us - prefer to stay further back
-                    idealDist = myRange * 1.05f * personalityFactor;
+                    idealDist = myRange * params.exposedRange * personalityFactor;
                 }
 
-                float tolerance = 40.0f * personalityFactor;
+                float tolerance = params.rangeTolerance * personalityFactor;
 
                 // Calculate perpendicular direction for circling (to get broadside)
                 Vec2 perpendicular = { -toEnemy.y, toEnemy.x };
@@ -375,7 +378,7 @@ void AIController::avoidEdges (const Ship& myShip, float arenaWidth, float arena
     float shipLength = myShip.getLength();
 
     // Look ahead based on speed
-    float lookAheadTime = config.aiLookAheadTime;
+    float lookAheadTime = config.aiLookAheadTime * params.lookAheadScale;
     Vec2 futurePos = pos + vel * lookAheadTime;
 
     float dangerMargin = shipLength * 2.0f + speed * 1.5f;
@@ -441,7 +444,7 @@ void AIController::avoidShips (const Ship& myShip, const std::vector<const Ship*
             continue;
 
         // Check if we're heading toward this ship
-        Vec2 myDir = mySpeed > 0.1f ? myVel.normalized() : Vec2::fromAngle (myShip.getAngle());
+        Vec2 myDir = mySpeed > 0.1f ? myVel.normalized() : myShip.getHeading();
         float dotProduct = myDir.dot (toOther.normalized());
 
         // Only avoid if we're heading toward the other ship
@@ -509,7 +512,7 @@ void AIController::avoidIslands (const Ship& myShip, const std::vector<Island>&
         else if (dist < dangerDist * 2.0f)
         {
             // Check if heading toward island
-            Vec2 myDir = mySpeed > 0.1f ? myVel.normalized() : Vec2::fromAngle (myShip.getAngle());
+            Vec2 myDir = mySpeed > 0.1f ? myVel.normalized() : myShip.getHeading();
             float dotProduct = myDir.dot (toIsland.normalized());
 
             if (dotProduct > 0.2f) // Heading somewhat toward island
@@ -600,7 +603,7 @@ void AIController::updateAim (const Ship& myShip, const Ship* targetShip)
             }
 
             // Fire if crosshair is close to predicted position and in range
-            fireInput = crosshairDist < config.aiCrosshairTolerance * personalityFactor &&
+            fireInput = crosshairDist < config.aiCrosshairTolerance * params.crosshairToleranceScale * personalityFactor &&
                         distance < myShip.getMaxRange() * personalityFactor &&
                         myShip.isReadyToFire();
         }
@@ -668,10 +671,10 @@ Vec2 AIController::getDodgeDirection (const Ship& myShip, const std::vector<Shel
             float timeToImpact = projDist / shellSpeed;
 
             // Only worry about shells arriving soon
-            if (timeToImpact < 2.0f)
+            if (timeToImpact < params.dodgeHorizon)
             {
                 // Calculate urgency based on time and proximity
-                float timeUrgency = 1.0f - (timeToImpact / 2.0f);
+                float timeUrgency = 1.0f - (timeToImpact / params.dodgeHorizon);
                 float proxUrgency = 1.0f - (perpDist / dangerRadius);
                 float shellUrgency = std::max (timeUrgency, proxUrgency);
 
@@ -699,3 +702,15 @@ Vec2 AIController::getDodgeDirection (const Ship& myShip, const std::vector<Shel
 
     return { 0, 0 };
 }
+
+void AIController::hashState (StateHasher& hasher) const
+{
+    hasher.add ("moveInput", moveInput);
+    hasher.add ("aimInput", aimInput);
+    hasher.add ("fireInput", fireInput);
+    hasher.add ("wanderTarget", wanderTarget);
+    hasher.add ("wanderTimer", wanderTimer);
+    hasher.add ("personality", personalityFactor);
+    hasher.add ("mode", (int) currentMode);
+    hasher.add ("random", random.getState());
+}
@@ -1,14 +1,34 @@
 #pragma once
 
 #include "Config.h"
+#include "Random.h"
+#include "StateHash.h"
 #include "Vec2.h"
-#include <random>
 #include <vector>
 
 class Ship;
 class Shell;
 class Island;
 
+// Tuning values behind the AI's decisions. The defaults are the hand tuned
+// ones; Optimiser evolves stronger sets. Plain data, so it can be copied into
+// world snapshots and match specs
+struct AIParams
+{
+    float scaredHealth = 0.25f;             // Flee below this fraction of health
+    float aggressiveHealthRatio = 0.5f;     // Move in when an enemy's health fraction is below ours times this
+    float aggressiveRange = 0.5f;           // Fractions of firing range to keep from the target:
+    float crowdedRange = 0.7f;              //   when moving in, with several enemies nearby,
+    float broadsideRange = 0.9f;            //   when circling for a broadside,
+    float exposedRange = 1.05f;             //   and when inside the enemy's firing arc
+    float rangeTolerance = 40.0f;           // Pixels either side of the broadside distance that are close enough
+    float dodgeHorizon = 2.0f;              // Seconds ahead incoming shells are dodged
+    float crosshairToleranceScale = 1.0f;   // Multiplies config aiCrosshairTolerance
+    float lookAheadScale = 1.0f;            // Multiplies config aiLookAheadTime
+    float personalityMin = 0.95f;           // Range the personality factor is drawn from
+    float personalityMax = 1.05f;
+};
+
 enum class AIMode
 {
     Aggressive,  // Enemy has much less health - move in for the kill
@@ -21,7 +41,14 @@ class AIController
 public:
     AIController();
 
-    // Get this AI's personality factor (0.95 to 1.05)
+    // Prepare for a new match: seeds this AI's random stream and rolls a new personality
+    void reset (uint64_t matchSeed, int shipIndex);
+
+    // Takes effect from the next reset()
+    void setParams (const AIParams& newParams) { params = newParams; }
+    const AIParams& getParams() const { return params; }
+
+    // Get this AI's personality factor (0.95 to 1.05 by default)
     float getPersonality() const { return personalityFactor; }
 
     void update (float dt, Ship& myShip, const std::vector<const Ship*>& enemies, const std::vector<const Ship*>& friendlies, const std::vector<Shell>& shells, const std::vector<Island>& islands, float arenaWidth, float arenaHeight);
@@ -30,6 +57,8 @@ public:
     Vec2 getAimInput() const { return aimInput; }
     bool getFireInput() const { return fireInput; }
 
+    void hashState (StateHasher& hasher) const;
+
 private:
     Vec2 moveInput;
     Vec2 aimInput;
@@ -38,11 +67,15 @@ private:
     Vec2 wanderTarget;
     float wanderTimer = 0.0f;
 
+    AIParams params;
+
     // Personality factor (0.95 to 1.05) - makes each AI slightly different
     float personalityFactor = 1.0f;
 
     AIMode currentMode = AIMode::Normal;
 
+    Random random;
+
     AIMode determineMode (const Ship& myShip, const std::vector<const Ship*>& enemies);
     const Ship* findTarget (const Ship& myShip, const std::vector<const Ship*>& enemies);
     void updateMovement (float dt, const Ship& myShip, const std::vector<const Ship*>& enemies, const std::vector<const Ship*>& friendlies, const std::vector<Shell>& shells, const std::vector<Island>& islands, float arenaWidth, float arenaHeight);
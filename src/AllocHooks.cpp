@@ -0,0 +1,39 @@
+#include "AllocTracker.h"
+#include <cstdlib>
+#include <new>
+
+// Only built with HELIGOLAND_TRACK_ALLOCATIONS, and only into the game
+// executable: replaces the global operator new/delete so every heap allocation
+// is counted by AllocTracker. The sized, nothrow and array forms all forward to
+// these by default. Over-aligned allocations keep the library's own pair and
+// aren't counted.
+
+namespace
+{
+    const bool installed = (AllocTracker::setActive(), true);
+}
+
+void* operator new (size_t size)
+{
+    AllocTracker::recordAllocation (size);
+
+    if (void* memory = std::malloc (size != 0 ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (size_t size)
+{
+    return operator new (size);
+}
+
+void operator delete (void* memory) noexcept
+{
+    std::free (memory);
+}
+
+void operator delete[] (void* memory) noexcept
+{
+    std::free (memory);
+}
@@ -0,0 +1,75 @@
+#include "AllocTracker.h"
+#include <atomic>
+
+namespace
+{
+    std::atomic<bool> active { false };
+
+    // Constant initialised, so they're safe to touch from inside operator new
+    thread_local AllocTracker::Counts counts;
+    thread_local AllocTracker::Tag currentTag = AllocTracker::Tag::Other;
+}
+
+uint64_t AllocTracker::Counts::getTotal() const
+{
+    uint64_t total = 0;
+    for (uint64_t n : allocations)
+        total += n;
+    return total;
+}
+
+AllocTracker::Counts AllocTracker::Counts::operator- (const Counts& earlier) const
+{
+    Counts difference;
+    for (size_t i = 0; i < allocations.size(); ++i)
+        difference.allocations[i] = allocations[i] - earlier.allocations[i];
+    difference.bytes = bytes - earlier.bytes;
+    return difference;
+}
+
+bool AllocTracker::isActive()
+{
+    return active.load (std::memory_order_relaxed);
+}
+
+const AllocTracker::Counts& AllocTracker::getCounts()
+{
+    return counts;
+}
+
+const char* AllocTracker::getTagName (Tag tag)
+{
+    switch (tag)
+    {
+        case Tag::Other:        return "other";
+        case Tag::Simulation:   return "sim";
+        case Tag::AI:           return "ai";
+        case Tag::Rendering:    return "render";
+        case Tag::Interface:    return "ui";
+        case Tag::Audio:        return "audio";
+        case Tag::numTags:      break;
+    }
+    return "?";
+}
+
+AllocTracker::Scope::Scope (Tag tag)
+    : previous (currentTag)
+{
+    currentTag = tag;
+}
+
+AllocTracker::Scope::~Scope()
+{
+    currentTag = previous;
+}
+
+void AllocTracker::setActive()
+{
+    active.store (true, std::memory_order_relaxed);
+}
+
+void AllocTracker::recordAllocation (size_t bytes)
+{
+    counts.allocations[(size_t) currentTag]++;
+    counts.bytes += bytes;
+}
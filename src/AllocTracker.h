@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// =============================================================================
+// AllocTracker
+// Opt-in counts of heap allocations, split by the subsystem that made them,
+// for keeping steady-state frames allocation free. Building with
+// HELIGOLAND_TRACK_ALLOCATIONS replaces the global operator new/delete
+// (AllocHooks.cpp) to feed it. Otherwise isActive() is false and nothing is
+// counted. Counts are per thread, so background writers don't show up in a frame.
+// =============================================================================
+
+namespace AllocTracker
+{
+    enum class Tag
+    {
+        Other,
+        Simulation,
+        AI,
+        Rendering,
+        Interface,      // HUD, title and menus
+        Audio,
+        numTags
+    };
+
+    struct Counts
+    {
+        std::array<uint64_t, (size_t) Tag::numTags> allocations = {};
+        uint64_t bytes = 0;
+
+        uint64_t getTotal() const;
+        Counts operator- (const Counts& earlier) const;
+    };
+
+    // True when the hooks are built in
+    bool isActive();
+
+    // This thread's allocations since it started
+    const Counts& getCounts();
+
+    const char* getTagName (Tag tag);
+
+    // Attributes this thread's allocations to a subsystem until it goes out of scope
+    class Scope
+    {
+    public:
+        explicit Scope (Tag tag);
+        ~Scope();
+
+        Scope (const Scope&) = delete;
+        Scope& operator= (const Scope&) = delete;
+
+    private:
+        Tag previous;
+    };
+
+    // Called by the hooks
+    void setActive();
+    void recordAllocation (size_t bytes);
+}
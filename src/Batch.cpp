@@ -0,0 +1,286 @@
+#include "Batch.h"
+#include "Config.h"
+#include "Dataset.h"
+#include "EventLog.h"
+#include "Ship.h"
+#include "StateStream.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    bool writeCsv (const std::string& path, const std::vector<MatchResult>& results)
+    {
+        std::ofstream file (path);
+        if (! file)
+            return false;
+
+        int maxShips = 0;
+        for (const auto& result : results)
+            maxShips = std::max (maxShips, result.numShips);
+
+        file << "match,seed,mode,winner,timed_out,duration,ticks";
+        for (int i = 1; i <= maxShips; ++i)
+            file << ",ship" << i << "_type,ship" << i << "_damage,ship" << i << "_shots,ship" << i << "_survived";
+        file << "\n";
+
+        for (size_t m = 0; m < results.size(); ++m)
+        {
+            const auto& result = results[m];
+            file << m + 1 << ',' << result.seed << ',' << Batch::getModeName (result.mode) << ','
+                 << Batch::describeWinner (result.mode, result.winnerIndex) << ',' << (result.timedOut ? 1 : 0) << ','
+                 << result.duration << ',' << result.ticks;
+
+            for (int i = 0; i < maxShips; ++i)
+            {
+                if (i < result.numShips)
+                    file << ',' << result.shipTypes[i] << ',' << result.damageDealt[i] << ',' << result.shotsFired[i]
+                         << ',' << (result.survived[i] ? 1 : 0);
+                else
+                    file << ",,,,";
+            }
+            file << "\n";
+        }
+
+        return (bool) file;
+    }
+
+    nlohmann::json toJson (const MatchResult& result)
+    {
+        nlohmann::json ships = nlohmann::json::array();
+        for (int i = 0; i < result.numShips; ++i)
+            ships.push_back ({
+                { "type", result.shipTypes[i] },
+                { "damageDealt", result.damageDealt[i] },
+                { "shotsFired", result.shotsFired[i] },
+                { "survived", result.survived[i] }
+            });
+
+        return {
+            { "seed", result.seed },
+            { "mode", Batch::getModeName (result.mode) },
+            { "winner", result.winnerIndex },
+            { "timedOut", result.timedOut },
+            { "duration", result.duration },
+            { "ticks", result.ticks },
+            { "ships", ships }
+        };
+    }
+
+    bool writeJson (const std::string& path, const std::vector<MatchResult>& results)
+    {
+        nlohmann::json matches = nlohmann::json::array();
+        for (const auto& result : results)
+            matches.push_back (toJson (result));
+
+        std::ofstream file (path);
+        if (! file)
+            return false;
+
+        file << matches.dump (2) << "\n";
+        return (bool) file;
+    }
+}
+
+MatchResult Batch::runMatch (World& world, const MatchSpec& spec, const MatchRecorders& recorders)
+{
+    // Same fixed step as the game loop
+    float stepTime = 1.0f / std::max (1.0f, config.simPhysicsRate);
+    World::ShipInputs inputs = {};  // No humans, every ship is AI controlled
+
+    for (int i = 0; i < World::MAX_SHIPS; ++i)
+        world.setAIParams (i, spec.aiParams[i]);
+
+    world.start (spec.mode, spec.shipTypes, spec.seed);
+
+    MatchResult result;
+    result.mode = spec.mode;
+    result.seed = spec.seed;
+
+    while (! world.isOver())
+    {
+        if (world.getMatchTime() >= spec.maxMatchTime)
+        {
+            result.timedOut = true;
+            break;
+        }
+        world.update (stepTime, inputs);
+        result.ticks++;
+
+        if (recorders.stateStream != nullptr)
+            recorders.stateStream->addFrame (world, result.ticks, true);
+        if (recorders.dataset != nullptr)
+            recorders.dataset->addFrame (world, result.ticks, true);
+        if (recorders.events != nullptr)
+            recorders.events->addEvents (world, result.ticks, true);
+    }
+
+    result.winnerIndex = result.timedOut ? -1 : world.getWinnerIndex();
+    result.duration = world.getMatchTime();
+    result.numShips = world.getNumShips();
+
+    const auto& ships = world.getShips();
+    for (int i = 0; i < result.numShips; ++i)
+    {
+        if (! ships[i])
+            continue;
+
+        result.shipTypes[i] = ships[i]->getShipType();
+        result.damageDealt[i] = ships[i]->getDamageDealt();
+        result.shotsFired[i] = ships[i]->getShotsFired();
+        result.survived[i] = ships[i]->isAlive();
+    }
+
+    return result;
+}
+
+std::vector<MatchResult> Batch::runMatches (const ShipHulls& hulls, const std::vector<MatchSpec>& specs, int numThreads,
+                                            const std::function<void (size_t index, const MatchResult&)>& onResult)
+{
+    // No point in more worlds than matches
+    if (numThreads <= 0)
+        numThreads = getDefaultNumThreads();
+
+    BatchRunner runner (hulls, (int) std::min ((size_t) numThreads, std::max ((size_t) 1, specs.size())));
+    return runner.run (specs, onResult);
+}
+
+int Batch::getDefaultNumThreads()
+{
+    return (int) std::max (1u, std::thread::hardware_concurrency());
+}
+
+const char* Batch::getModeName (GameMode mode)
+{
+    switch (mode)
+    {
+        case GameMode::FFA:    return "ffa";
+        case GameMode::Teams:  return "teams";
+        case GameMode::Duel:   return "duel";
+        case GameMode::Triple: return "triple";
+        case GameMode::Battle: return "battle";
+    }
+    return "?";
+}
+
+std::string Batch::describeWinner (GameMode mode, int winnerIndex)
+{
+    if (winnerIndex < 0)
+        return "draw";
+    if (mode == GameMode::Teams || mode == GameMode::Battle)
+        return "team " + std::to_string (winnerIndex + 1);
+    return "P" + std::to_string (winnerIndex + 1);
+}
+
+bool Batch::parseMode (const std::string& text, GameMode& mode)
+{
+    for (GameMode m : { GameMode::FFA, GameMode::Teams, GameMode::Duel, GameMode::Triple, GameMode::Battle })
+    {
+        if (text == getModeName (m))
+        {
+            mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string Batch::resultToJson (const MatchResult& result)
+{
+    return toJson (result).dump();
+}
+
+bool Batch::resultFromJson (const std::string& text, MatchResult& result)
+{
+    try
+    {
+        auto j = nlohmann::json::parse (text);
+
+        result = {};
+        result.seed = j.at ("seed").get<uint64_t>();
+        result.winnerIndex = j.at ("winner").get<int>();
+        result.timedOut = j.at ("timedOut").get<bool>();
+        result.duration = j.at ("duration").get<float>();
+        result.ticks = j.at ("ticks").get<uint32_t>();
+
+        if (! parseMode (j.at ("mode").get<std::string>(), result.mode))
+            return false;
+
+        const auto& ships = j.at ("ships");
+        result.numShips = std::min ((int) ships.size(), World::MAX_SHIPS);
+        for (int i = 0; i < result.numShips; ++i)
+        {
+            result.shipTypes[i] = ships[i].at ("type").get<int>();
+            result.damageDealt[i] = ships[i].at ("damageDealt").get<float>();
+            result.shotsFired[i] = ships[i].at ("shotsFired").get<int>();
+            result.survived[i] = ships[i].at ("survived").get<bool>();
+        }
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool Batch::writeResults (const std::string& path, const std::vector<MatchResult>& results)
+{
+    if (path.size() >= 5 && path.compare (path.size() - 5, 5, ".json") == 0)
+        return writeJson (path, results);
+
+    return writeCsv (path, results);
+}
+
+//==============================================================================
+BatchRunner::BatchRunner (const ShipHulls& hulls, int numThreads)
+{
+    if (numThreads <= 0)
+        numThreads = Batch::getDefaultNumThreads();
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        worlds.push_back (std::make_unique<World> (hulls));
+        worlds.back()->setCosmeticsEnabled (false);
+    }
+}
+
+std::vector<MatchResult> BatchRunner::run (const std::vector<MatchSpec>& specs,
+                                           const std::function<void (size_t index, const MatchResult&)>& onResult)
+{
+    std::vector<MatchResult> results (specs.size());
+    std::atomic<size_t> nextMatch = 0;
+    std::mutex resultLock;
+
+    // Each worker takes the next match until none are left
+    auto work = [&] (World& world)
+    {
+        for (size_t i = nextMatch++; i < specs.size(); i = nextMatch++)
+        {
+            results[i] = Batch::runMatch (world, specs[i]);
+
+            if (onResult)
+            {
+                std::lock_guard<std::mutex> lock (resultLock);
+                onResult (i, results[i]);
+            }
+        }
+    };
+
+    size_t numThreads = std::min (worlds.size(), std::max ((size_t) 1, specs.size()));
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < numThreads; ++i)
+        workers.emplace_back (work, std::ref (*worlds[i]));
+
+    work (*worlds[0]);
+
+    for (auto& worker : workers)
+        worker.join();
+
+    return results;
+}
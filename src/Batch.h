@@ -0,0 +1,101 @@
+#pragma once
+
+#include "World.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ShipHulls;
+class StateStreamWriter;
+class DatasetWriter;
+class EventLogWriter;
+
+// =============================================================================
+// Batch
+// Runs many independent AI-only matches spread over worker threads, for
+// balance reviews. Each match only touches its own World. The config and hull
+// masks are shared but only read while matches run, so the results are the
+// same whatever the number of threads.
+// =============================================================================
+
+// One AI-only match to simulate
+struct MatchSpec
+{
+    GameMode mode = GameMode::FFA;
+    uint64_t seed = 0;
+    World::ShipTypes shipTypes;     // 0-3, or -1 to pick at random
+    float maxMatchTime = 300.0f;    // Seconds of game time before the match is called a draw
+    std::array<AIParams, World::MAX_SHIPS> aiParams;  // Per ship. Farm workers always use the defaults
+
+    MatchSpec() { shipTypes.fill (-1); }
+};
+
+struct MatchResult
+{
+    GameMode mode = GameMode::FFA;
+    uint64_t seed = 0;
+    int winnerIndex = -1;           // As World::getWinnerIndex(), -1 = draw
+    bool timedOut = false;
+    float duration = 0.0f;          // Game time in seconds
+    uint32_t ticks = 0;
+    int numShips = 0;
+
+    // Per ship
+    std::array<int, World::MAX_SHIPS> shipTypes = {};
+    std::array<float, World::MAX_SHIPS> damageDealt = {};
+    std::array<int, World::MAX_SHIPS> shotsFired = {};
+    std::array<bool, World::MAX_SHIPS> survived = {};
+};
+
+// Runs lists of matches on a fixed set of threads, keeping one world per
+// thread from one run to the next (sweeps and optimisers run many batches)
+class BatchRunner
+{
+public:
+    explicit BatchRunner (const ShipHulls& hulls, int numThreads = 0);  // 0 = one per core
+
+    int getNumThreads() const { return (int) worlds.size(); }
+
+    // Returns the results in spec order. onResult is called from the worker threads, one at a time
+    std::vector<MatchResult> run (const std::vector<MatchSpec>& specs,
+                                  const std::function<void (size_t index, const MatchResult&)>& onResult = {});
+
+private:
+    std::vector<std::unique_ptr<World>> worlds;
+};
+
+// Optional recordings of a match run by Batch::runMatch. Any can be null or closed
+struct MatchRecorders
+{
+    StateStreamWriter* stateStream = nullptr;
+    DatasetWriter* dataset = nullptr;
+    EventLogWriter* events = nullptr;
+};
+
+namespace Batch
+{
+    // Simulates a match to the end (or the time limit) using the given world,
+    // recording every tick to any open recorders
+    MatchResult runMatch (World& world, const MatchSpec& spec, const MatchRecorders& recorders = {});
+
+    // Runs every spec on numThreads threads (0 = one per core) and returns the
+    // results in spec order. onResult is called from the worker threads, one at a time
+    std::vector<MatchResult> runMatches (const ShipHulls& hulls, const std::vector<MatchSpec>& specs, int numThreads,
+                                         const std::function<void (size_t index, const MatchResult&)>& onResult = {});
+
+    int getDefaultNumThreads();
+
+    const char* getModeName (GameMode mode);  // "ffa", "teams", "duel", "triple" or "battle"
+    bool parseMode (const std::string& text, GameMode& mode);
+    std::string describeWinner (GameMode mode, int winnerIndex);  // "team 1", "P3" or "draw"
+
+    // Writes one row per match to a .csv file, or an array of objects to a .json file
+    bool writeResults (const std::string& path, const std::vector<MatchResult>& results);
+
+    // One result as a JSON object, as in a .json results file
+    std::string resultToJson (const MatchResult& result);
+    bool resultFromJson (const std::string& text, MatchResult& result);
+}
@@ -0,0 +1,115 @@
+#include "BinaryIO.h"
+#include <fstream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool readFile (const std::string& path, std::vector<uint8_t>& bytes)
+{
+    std::ifstream file (path, std::ios::binary | std::ios::ate);
+    if (! file.is_open())
+        return false;
+
+    std::streamsize size = file.tellg();
+    if (size < 0)
+        return false;
+
+    bytes.resize ((size_t) size);
+    file.seekg (0);
+    return size == 0 || (bool) file.read ((char*) bytes.data(), size);
+}
+
+bool writeFile (const std::string& path, const std::vector<uint8_t>& bytes)
+{
+    std::ofstream file (path, std::ios::binary | std::ios::trunc);
+    if (! file.is_open())
+        return false;
+
+    file.write ((const char*) bytes.data(), (std::streamsize) bytes.size());
+    return (bool) file;
+}
+
+//==============================================================================
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open (const std::string& path)
+{
+    close();
+
+   #if defined(_WIN32)
+    HANDLE file = CreateFileA (path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (! GetFileSizeEx (file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle (file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA (file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping != nullptr ? MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr)
+    {
+        if (mapping != nullptr)
+            CloseHandle (mapping);
+        CloseHandle (file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = (const uint8_t*) view;
+    size = (size_t) fileSize.QuadPart;
+   #else
+    int fd = ::open (path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat (fd, &info) != 0 || info.st_size == 0)
+    {
+        ::close (fd);
+        return false;
+    }
+
+    void* view = mmap (nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close (fd);  // The mapping keeps the file alive
+    if (view == MAP_FAILED)
+        return false;
+
+    data = (const uint8_t*) view;
+    size = (size_t) info.st_size;
+   #endif
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data == nullptr)
+        return;
+
+   #if defined(_WIN32)
+    UnmapViewOfFile (data);
+    CloseHandle ((HANDLE) mappingHandle);
+    CloseHandle ((HANDLE) fileHandle);
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+   #else
+    munmap ((void*) data, size);
+   #endif
+
+    data = nullptr;
+    size = 0;
+}
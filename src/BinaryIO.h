@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// Little-endian byte streams with LEB128 varints and zigzag signed values.
+// Shared by the replay and recording formats.
+// =============================================================================
+
+// Map signed to unsigned so small negative numbers stay small as varints
+inline uint64_t zigzagEncode (int64_t v) { return ((uint64_t) v << 1) ^ (uint64_t) (v >> 63); }
+inline int64_t zigzagDecode (uint64_t v) { return (int64_t) (v >> 1) ^ -(int64_t) (v & 1); }
+
+class ByteWriter
+{
+public:
+    void writeU8 (uint8_t v)            { bytes.push_back (v); }
+
+    void writeU16 (uint16_t v)
+    {
+        writeU8 ((uint8_t) v);
+        writeU8 ((uint8_t) (v >> 8));
+    }
+
+    void writeU32 (uint32_t v)
+    {
+        for (int i = 0; i < 4; ++i)
+            writeU8 ((uint8_t) (v >> (i * 8)));
+    }
+
+    void writeU64 (uint64_t v)
+    {
+        for (int i = 0; i < 8; ++i)
+            writeU8 ((uint8_t) (v >> (i * 8)));
+    }
+
+    void writeFloat (float v)
+    {
+        uint32_t bits;
+        memcpy (&bits, &v, sizeof (bits));
+        writeU32 (bits);
+    }
+
+    void writeVarint (uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            writeU8 ((uint8_t) (v | 0x80));
+            v >>= 7;
+        }
+        writeU8 ((uint8_t) v);
+    }
+
+    void writeSigned (int64_t v)        { writeVarint (zigzagEncode (v)); }
+
+    void writeBytes (const void* data, size_t size)
+    {
+        auto p = (const uint8_t*) data;
+        bytes.insert (bytes.end(), p, p + size);
+    }
+
+    void clear()                        { bytes.clear(); }
+    void reserve (size_t size)          { bytes.reserve (size); }
+    size_t size() const                 { return bytes.size(); }
+    const std::vector<uint8_t>& data() const { return bytes; }
+    std::vector<uint8_t>& data()        { return bytes; }
+
+private:
+    std::vector<uint8_t> bytes;
+};
+
+// Reads from a borrowed buffer. Reading past the end returns zeros and clears ok()
+class ByteReader
+{
+public:
+    ByteReader() = default;
+    ByteReader (const uint8_t* data_, size_t size_) : data (data_), size (size_) {}
+
+    uint8_t readU8()
+    {
+        if (pos >= size)
+        {
+            valid = false;
+            return 0;
+        }
+        return data[pos++];
+    }
+
+    uint16_t readU16()
+    {
+        uint16_t v = readU8();
+        return (uint16_t) (v | (readU8() << 8));
+    }
+
+    uint32_t readU32()
+    {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i)
+            v |= (uint32_t) readU8() << (i * 8);
+        return v;
+    }
+
+    uint64_t readU64()
+    {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i)
+            v |= (uint64_t) readU8() << (i * 8);
+        return v;
+    }
+
+    float readFloat()
+    {
+        uint32_t bits = readU32();
+        float v;
+        memcpy (&v, &bits, sizeof (v));
+        return v;
+    }
+
+    uint64_t readVarint()
+    {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t b = readU8();
+            v |= (uint64_t) (b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+                return v;
+        }
+        valid = false;  // Over-long varint
+        return v;
+    }
+
+    int64_t readSigned()                { return zigzagDecode (readVarint()); }
+
+    bool readBytes (void* dest, size_t count)
+    {
+        if (count > size - pos || pos > size)
+        {
+            valid = false;
+            return false;
+        }
+        memcpy (dest, data + pos, count);
+        pos += count;
+        return true;
+    }
+
+    bool ok() const                     { return valid; }
+    bool atEnd() const                  { return pos >= size; }
+    size_t position() const             { return pos; }
+    void seek (size_t newPos)           { pos = newPos; valid = newPos <= size; }
+    size_t getSize() const              { return size; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+    bool valid = true;
+};
+
+// Whole-file helpers
+bool readFile (const std::string& path, std::vector<uint8_t>& bytes);
+bool writeFile (const std::string& path, const std::vector<uint8_t>& bytes);
+
+// Read-only memory mapping of a whole file. Pages are loaded on demand, so
+// seeking around a large recording only touches the parts that are read.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile (const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    bool open (const std::string& path);
+    void close();
+
+    bool isOpen() const                 { return data != nullptr; }
+    const uint8_t* getData() const      { return data; }
+    size_t getSize() const              { return size; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+   #if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+   #endif
+};
@@ -2,6 +2,7 @@
 #include "Platform.h"
 
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <fstream>
 
 using json = nlohmann::json;
@@ -59,14 +60,35 @@ namespace
         if (j.contains (key))
             value = jsonToColor (j[key], value);
     }
+
+    bool readJsonFile (const std::string& path, json& j)
+    {
+        if (path.empty())
+            return false;
+
+        std::ifstream file (path);
+        if (! file.is_open())
+            return false;
+
+        try
+        {
+            file >> j;
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+        return true;
+    }
 }
 
-Config::Config()
+ConfigValues::ConfigValues()
 {
     initDefaultShipTypes();
 }
 
-void Config::initDefaultShipTypes()
+void ConfigValues::initDefaultShipTypes()
 {
     // Ship Type 1: Scout - 1 turret, fast but fragile, short range, low damage
     shipTypes[0].name = "Scout";
@@ -159,24 +181,42 @@ std::string Config::getConfigPath() const
 
 bool Config::load()
 {
-    std::string path = getConfigPath();
-    if (path.empty())
-        return false;
+    json j;
+    return readJsonFile (getConfigPath(), j) && loadFromJson (j);
+}
 
-    std::ifstream file (path);
-    if (! file.is_open())
+bool Config::loadFromString (const std::string& text)
+{
+    json j;
+    try
+    {
+        j = json::parse (text);
+    }
+    catch (...)
+    {
         return false;
+    }
 
-    json j;
+    return j.is_object() && loadFromJson (j);
+}
+
+bool ConfigValues::loadFromJson (const json& j)
+{
+    // A value of the wrong type throws
     try
     {
-        file >> j;
+        loadSections (j);
     }
     catch (...)
     {
         return false;
     }
 
+    return true;
+}
+
+void ConfigValues::loadSections (const json& j)
+{
     // Helper to get a section if it exists
     auto getSection = [&j] (const char* name) -> const json& {
         static const json empty = json::object();
@@ -271,6 +311,16 @@ bool Config::load()
         loadValue (s, "sinkMaxRadius", sinkExplosionMaxRadius);
     }
 
+    // Particle budgets
+    {
+        const auto& s = getSection ("particles");
+        loadValue (s, "maxBubbles", particleMaxBubbles);
+        loadValue (s, "maxSmoke", particleMaxSmoke);
+        loadValue (s, "maxExplosions", particleMaxExplosions);
+        loadValue (s, "emitterShare", particleEmitterShare);
+        loadValue (s, "throttleStart", particleThrottleStart);
+    }
+
     // Wind
     {
         const auto& s = getSection ("wind");
@@ -321,6 +371,26 @@ bool Config::load()
         loadValue (s, "overReturnDelay", gameOverReturnDelay);
     }
 
+    // Simulation
+    {
+        const auto& s = getSection ("simulation");
+        loadValue (s, "physicsRate", simPhysicsRate);
+        loadValue (s, "aiRate", simAIRate);
+        loadValue (s, "timeScale", simTimeScale);
+        loadValue (s, "cosmeticsMaxTimeScale", simCosmeticsMaxTimeScale);
+    }
+
+    // Replays
+    {
+        const auto& s = getSection ("replay");
+        loadValue (s, "record", replayRecord);
+        loadValue (s, "keepCount", replayKeepCount);
+        loadValue (s, "stateStream", replayStateStream);
+        loadValue (s, "keyframeInterval", replayKeyframeInterval);
+        loadValue (s, "dataset", replayDataset);
+        loadValue (s, "events", replayEvents);
+    }
+
     // Colors - Environment
     {
         const auto& s = getSection ("colorsEnvironment");
@@ -402,16 +472,10 @@ bool Config::load()
         loadColor (s, "border", colorWindBorder);
         loadColor (s, "arrow", colorWindArrow);
     }
-
-    return true;
 }
 
-bool Config::save() const
+json ConfigValues::toJson() const
 {
-    std::string path = getConfigPath();
-    if (path.empty())
-        return false;
-
     json j;
 
     // Version
@@ -497,6 +561,15 @@ bool Config::save() const
         { "sinkMaxRadius", sinkExplosionMaxRadius }
     };
 
+    // Particle budgets
+    j["particles"] = {
+        { "maxBubbles", particleMaxBubbles },
+        { "maxSmoke", particleMaxSmoke },
+        { "maxExplosions", particleMaxExplosions },
+        { "emitterShare", particleEmitterShare },
+        { "throttleStart", particleThrottleStart }
+    };
+
     // Wind
     j["wind"] = {
         { "changeInterval", windChangeInterval },
@@ -542,6 +615,24 @@ bool Config::save() const
         { "overReturnDelay", gameOverReturnDelay }
     };
 
+    // Simulation
+    j["simulation"] = {
+        { "physicsRate", simPhysicsRate },
+        { "aiRate", simAIRate },
+        { "timeScale", simTimeScale },
+        { "cosmeticsMaxTimeScale", simCosmeticsMaxTimeScale }
+    };
+
+    // Replays
+    j["replay"] = {
+        { "record", replayRecord },
+        { "keepCount", replayKeepCount },
+        { "stateStream", replayStateStream },
+        { "keyframeInterval", replayKeyframeInterval },
+        { "dataset", replayDataset },
+        { "events", replayEvents }
+    };
+
     // Colors - Environment
     j["colorsEnvironment"] = {
         { "ocean", colorToJson (colorOcean) },
@@ -616,11 +707,38 @@ bool Config::save() const
         { "arrow", colorToJson (colorWindArrow) }
     };
 
+    return j;
+}
+
+ConfigChanges ConfigChanges::between (const ConfigValues& before, const ConfigValues& after)
+{
+    json a = before.toJson();
+    json b = after.toJson();
+
+    ConfigChanges changes;
+    for (auto& [name, section] : b.items())
+        if (section.is_object() && section != a[name])
+            changes.sections.push_back (name);
+
+    return changes;
+}
+
+bool ConfigChanges::has (const char* section) const
+{
+    return std::find (sections.begin(), sections.end(), section) != sections.end();
+}
+
+bool Config::save() const
+{
+    std::string path = getConfigPath();
+    if (path.empty())
+        return false;
+
     std::ofstream file (path);
     if (! file.is_open())
         return false;
 
-    file << j.dump (4);
+    file << toJson().dump (4);
     return true;
 }
 
@@ -641,6 +759,30 @@ void Config::fileChanged (const std::string& file, FileSystemWatcher::Event even
     std::string configPath = getConfigPath();
     if (file == configPath && event == FileSystemWatcher::Event::fileModified)
     {
-        load();
+        // Parsed here, over the defaults, into values nothing else can see yet. A file
+        // caught half written doesn't parse and is skipped, the next write brings it
+        json j;
+        auto values = std::make_unique<ConfigValues>();
+        if (! readJsonFile (configPath, j) || ! values->loadFromJson (j))
+            return;
+
+        std::lock_guard<std::mutex> lock (reloadLock);
+        reloaded = std::move (values);
     }
 }
+
+ConfigChanges Config::applyReload()
+{
+    std::unique_ptr<ConfigValues> values;
+    {
+        std::lock_guard<std::mutex> lock (reloadLock);
+        values = std::move (reloaded);
+    }
+
+    if (! values)
+        return {};
+
+    ConfigChanges changes = ConfigChanges::between (*this, *values);
+    static_cast<ConfigValues&> (*this) = *values;
+    return changes;
+}
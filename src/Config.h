@@ -1,9 +1,11 @@
 #pragma once
 
 #include "FileSystemWatcher.h"
+#include <nlohmann/json_fwd.hpp>
 #include <raylib.h>
 #include <array>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -42,22 +44,21 @@ struct ShipType
 constexpr int NUM_SHIP_TYPES = 4;
 
 // =============================================================================
-// Game Configuration
-// All tweakable game constants in one place
+// Config Values
+// Every tweakable value, as plain data. A hot reload builds a whole new set on
+// the watcher thread, and the game copies it in between frames
 // =============================================================================
 
-class Config : public FileSystemWatcher::Listener
+struct ConfigValues
 {
-public:
-    Config();
-    ~Config();
+    ConfigValues();
 
-    bool load();
-    bool save() const;
-    void startWatching();
+    // Applies the values present in a JSON object laid out like config.json. False if
+    // a value has the wrong type, in which case the ones before it have been applied
+    bool loadFromJson (const nlohmann::json& j);
 
-    // FileSystemWatcher::Listener
-    void fileChanged (const std::string& file, FileSystemWatcher::Event event) override;
+    // All the values, laid out like config.json
+    nlohmann::json toJson() const;
 
     // -------------------------------------------------------------------------
     // Ship Physics
@@ -139,6 +140,15 @@ public:
     float sinkExplosionDuration       = 1.0f;
     float sinkExplosionMaxRadius      = 80.0f;
 
+    // -------------------------------------------------------------------------
+    // Particle Budgets
+    // -------------------------------------------------------------------------
+    int   particleMaxBubbles          = 4096;
+    int   particleMaxSmoke            = 12288;
+    int   particleMaxExplosions       = 256;       // Each for splashes and hit explosions
+    float particleEmitterShare        = 0.25f;     // Most of a budget one ship can hold
+    float particleThrottleStart       = 0.75f;     // How full a budget gets before spawns thin out
+
     // -------------------------------------------------------------------------
     // Wind
     // -------------------------------------------------------------------------
@@ -193,6 +203,24 @@ public:
     float gameOverTextDelay           = 5.0f;      // Delay before showing winner text
     float gameOverReturnDelay         = 13.0f;     // Total delay before returning to title
 
+    // -------------------------------------------------------------------------
+    // Simulation
+    // -------------------------------------------------------------------------
+    float simPhysicsRate              = 60.0f;     // Fixed physics steps per second (independent of display rate)
+    float simAIRate                   = 20.0f;     // AI decisions per second, ships hold the last decision in between
+    float simTimeScale                = 1.0f;      // Speed of matches with no human playing (0.25 to 50, -/= keys change it)
+    float simCosmeticsMaxTimeScale    = 4.0f;      // Above this speed bubbles, smoke, explosions and sounds are skipped
+
+    // -------------------------------------------------------------------------
+    // Replays
+    // -------------------------------------------------------------------------
+    bool  replayRecord                = true;      // Save an input replay of every match
+    int   replayKeepCount             = 20;        // Oldest replays are deleted beyond this many
+    bool  replayStateStream           = false;     // Also record a seekable state stream for viewers
+    float replayKeyframeInterval      = 5.0f;      // Seconds between full keyframes in state streams
+    bool  replayDataset               = false;     // Also record per-ship states and actions for training
+    bool  replayEvents                = false;     // Also log gameplay events for match analytics
+
     // -------------------------------------------------------------------------
     // Colors - Environment
     // -------------------------------------------------------------------------
@@ -299,12 +327,63 @@ public:
 
     void initDefaultShipTypes();
 
+private:
+    void loadSections (const nlohmann::json& j);
+};
+
+// The config.json sections (e.g. "shipPhysics") whose values differ between two sets
+struct ConfigChanges
+{
+    std::vector<std::string> sections;
+
+    static ConfigChanges between (const ConfigValues& before, const ConfigValues& after);
+
+    bool any() const    { return ! sections.empty(); }
+    bool has (const char* section) const;
+};
+
+// =============================================================================
+// Game Configuration
+// All tweakable game constants in one place, loaded from and saved to the user's
+// config.json and reloaded when that changes
+// =============================================================================
+
+class Config : public ConfigValues, public FileSystemWatcher::Listener
+{
+public:
+    ~Config();
+
+    bool load();
+    bool save() const;
+    void startWatching();
+
+    // Applies the values present in a JSON object laid out like config.json,
+    // e.g. {"shipHealth": {"shellDamage": 30}}. False if it doesn't parse or a value has the wrong type
+    bool loadFromString (const std::string& text);
+
+    // Copies in the values from config.json if it has changed since the last call, and
+    // returns which sections differ. The game calls it at the top of each update, so
+    // nothing sees the values change part way through a frame
+    ConfigChanges applyReload();
+
+    // FileSystemWatcher::Listener
+    void fileChanged (const std::string& file, FileSystemWatcher::Event event) override;
+
 private:
     std::string getConfigPath() const;
     std::string getConfigDirectory() const;
 
     std::unique_ptr<FileSystemWatcher> watcher;
+
+    // The last complete parse of config.json on the watcher thread, waiting for applyReload
+    std::mutex reloadLock;
+    std::unique_ptr<ConfigValues> reloaded;
 };
 
-// Global config instance
+// Global config instance. Only these write it:
+// - The game thread: applyReload() at the top of Game::update, and the volume setting
+// - Startup code before any simulation thread runs: command line overrides (headless
+//   --config, farm workers) and heligoland_env_create before any environment steps
+// - Balance sweeps (--sweep), between batches, while no match is running
+// The file watcher thread never writes it, it hands reloads to applyReload
 extern Config config;
@@ -0,0 +1,579 @@
+#include "Dataset.h"
+#include "Ship.h"
+#include <algorithm>
+#include <cmath>
+
+// File layout:
+//   "HLDS" u8 version, match header
+//   Schema: varint column count, then per column its name and f32 scale
+//   Chunks, appended as they fill:
+//     'C' varint size, varint row count, then per column: u8 encoding, varint size, block
+//     'E' end of chunks
+// Rows in a chunk are ordered by ship then tick, so each column block follows
+// one ship at a time and its deltas stay small. An unfinished file (no end
+// marker) is still readable up to its last whole chunk.
+
+namespace
+{
+    const uint8_t magic[4] = { 'H', 'L', 'D', 'S' };
+    constexpr uint8_t formatVersion = 1;
+
+    constexpr uint8_t dataChunk = 'C';
+    constexpr uint8_t endChunk = 'E';
+
+    // Column block encodings, the smallest is picked per block
+    enum Encoding : uint8_t
+    {
+        constantEncoding,   // One signed varint for every row
+        deltaEncoding,      // First value, then signed varint differences
+        plainEncoding,      // Signed varint per row
+        deltaRunEncoding    // Pairs of signed difference and varint repeat count
+    };
+
+    // Fixed point scales
+    constexpr float positionScale = 16.0f;    // 1/16 pixel
+    constexpr float velocityScale = 256.0f;
+    constexpr float angleScale = 4096.0f;     // ~0.014 degrees
+    constexpr float healthScale = 16.0f;
+    constexpr float unitScale = 4096.0f;      // Values in the 0-1 or -1-1 range
+
+    constexpr float twoPi = 6.28318530718f;
+
+    size_t getVarintSize (uint64_t value)
+    {
+        size_t size = 1;
+        for (; value >= 0x80; value >>= 7)
+            size++;
+        return size;
+    }
+
+    struct ColumnInfo
+    {
+        const char* name;
+        float scale;
+    };
+
+    const ColumnInfo columns[DatasetFrame::numColumns] = {
+        { "tick", 1.0f },
+        { "ship", 1.0f },
+        { "human", 1.0f },
+        { "alive", 1.0f },
+        { "x", positionScale },
+        { "y", positionScale },
+        { "velocityX", velocityScale },
+        { "velocityY", velocityScale },
+        { "angle", angleScale },
+        { "health", healthScale },
+        { "turretAngle0", angleScale },
+        { "turretAngle1", angleScale },
+        { "turretAngle2", angleScale },
+        { "turretAngle3", angleScale },
+        { "turretReload0", unitScale },
+        { "turretReload1", unitScale },
+        { "turretReload2", unitScale },
+        { "turretReload3", unitScale },
+        { "crosshairX", positionScale },
+        { "crosshairY", positionScale },
+        { "enemyDistance", positionScale },
+        { "enemyBearing", angleScale },
+        { "shellDistance", positionScale },
+        { "shellBearing", angleScale },
+        { "moveX", unitScale },
+        { "moveY", unitScale },
+        { "aimX", unitScale },
+        { "aimY", unitScale },
+        { "fire", 1.0f },
+    };
+
+    int32_t toFixed (float v, float scale)  { return (int32_t) std::lround (v * scale); }
+    int32_t toFixedAngle (float a)          { return toFixed (std::remainder (a, twoPi), angleScale); }
+
+    void writeBlock (ByteWriter& w, Encoding encoding, const ByteWriter& block)
+    {
+        w.writeU8 (encoding);
+        w.writeVarint (block.size());
+        w.writeBytes (block.data().data(), block.size());
+    }
+
+    void encodeBlock (ByteWriter& w, const std::vector<int32_t>& values, ByteWriter& scratch)
+    {
+        bool constant = std::all_of (values.begin(), values.end(), [&] (int32_t v) { return v == values.front(); });
+        if (constant)
+        {
+            scratch.clear();
+            scratch.writeSigned (values.empty() ? 0 : values.front());
+            writeBlock (w, constantEncoding, scratch);
+            return;
+        }
+
+        // Runs of equal differences: held inputs, counters and flags collapse to a few bytes
+        scratch.clear();
+        int64_t previous = 0;
+        for (size_t i = 0; i < values.size();)
+        {
+            int64_t delta = (int64_t) values[i] - previous;
+            size_t run = 1;
+            while (i + run < values.size() && (int64_t) values[i + run] - values[i + run - 1] == delta)
+                run++;
+
+            scratch.writeSigned (delta);
+            scratch.writeVarint (run);
+            previous = values[i + run - 1];
+            i += run;
+        }
+        size_t runSize = scratch.size();
+
+        // Otherwise one difference per row, or plain values for columns that jump about
+        size_t deltaSize = 0, plainSize = 0;
+        previous = 0;
+        for (int32_t v : values)
+        {
+            deltaSize += getVarintSize (zigzagEncode ((int64_t) v - previous));
+            plainSize += getVarintSize (zigzagEncode (v));
+            previous = v;
+        }
+
+        if (runSize <= deltaSize && runSize <= plainSize)
+        {
+            writeBlock (w, deltaRunEncoding, scratch);
+            return;
+        }
+
+        bool plain = plainSize < deltaSize;
+        scratch.clear();
+        previous = 0;
+        for (int32_t v : values)
+        {
+            scratch.writeSigned (plain ? (int64_t) v : (int64_t) v - previous);
+            previous = v;
+        }
+        writeBlock (w, plain ? plainEncoding : deltaEncoding, scratch);
+    }
+
+    bool decodeBlock (ByteReader& r, uint8_t encoding, uint32_t numRows, float scale, std::vector<float>& values)
+    {
+        if (encoding == constantEncoding)
+        {
+            float v = (float) r.readSigned() / scale;
+            values.insert (values.end(), numRows, v);
+            return r.ok();
+        }
+
+        int64_t previous = 0;
+        if (encoding == deltaRunEncoding)
+        {
+            for (uint32_t i = 0; i < numRows && r.ok();)
+            {
+                int64_t delta = r.readSigned();
+                uint64_t run = std::min<uint64_t> (r.readVarint(), numRows - i);
+                if (run == 0)
+                    return false;
+
+                for (uint64_t j = 0; j < run; ++j)
+                {
+                    previous += delta;
+                    values.push_back ((float) previous / scale);
+                }
+                i += (uint32_t) run;
+            }
+            return r.ok();
+        }
+
+        for (uint32_t i = 0; i < numRows; ++i)
+        {
+            int64_t v = r.readSigned();
+            if (encoding == deltaEncoding)
+                v += previous;
+            previous = v;
+            values.push_back ((float) v / scale);
+        }
+        return r.ok() && encoding <= plainEncoding;
+    }
+}
+
+const char* Dataset::getColumnName (int column)
+{
+    return columns[column].name;
+}
+
+float Dataset::getColumnScale (int column)
+{
+    return columns[column].scale;
+}
+
+//==============================================================================
+void DatasetFrame::capture (const World& world, uint32_t frameTick)
+{
+    tickNumber = frameTick;
+    shipMask = 0;
+
+    const auto& ships = world.getShips();
+    const auto& inputs = world.getAppliedInputs();
+    const auto& shells = world.getShells();
+
+    for (int i = 0; i < World::MAX_SHIPS; ++i)
+    {
+        const Ship* s = ships[i].get();
+        if (s == nullptr)
+            continue;
+
+        shipMask |= 1u << i;
+        Row& row = rows[i];
+
+        Vec2 pos = s->getPosition();
+        Vec2 velocity = s->getVelocity();
+        Vec2 crosshair = s->getCrosshairPosition() - pos;
+        float shipAngle = s->getAngle();
+
+        row[tick] = (int32_t) tickNumber;
+        row[ship] = i;
+        row[human] = inputs[i].human ? 1 : 0;
+        row[alive] = s->isAlive() ? 1 : 0;
+        row[x] = toFixed (pos.x, positionScale);
+        row[y] = toFixed (pos.y, positionScale);
+        row[velocityX] = toFixed (velocity.x, velocityScale);
+        row[velocityY] = toFixed (velocity.y, velocityScale);
+        row[angle] = toFixedAngle (shipAngle);
+        row[health] = toFixed (s->getHealth(), healthScale);
+        row[crosshairX] = toFixed (crosshair.x, positionScale);
+        row[crosshairY] = toFixed (crosshair.y, positionScale);
+
+        const auto& turrets = s->getTurrets();
+        for (int t = 0; t < 4; ++t)
+        {
+            bool used = t < s->getNumTurrets();
+            row[turretAngle + t] = used ? toFixedAngle (turrets[t].getAngle()) : 0;
+            row[turretReload + t] = used ? toFixed (turrets[t].getReloadProgress(), unitScale) : 0;
+        }
+
+        // Nearest living enemy
+        float nearestEnemy = -1.0f;
+        Vec2 toEnemy;
+        for (int j = 0; j < World::MAX_SHIPS; ++j)
+        {
+            const Ship* other = ships[j].get();
+            if (j == i || other == nullptr || ! other->isAlive() || ! world.areEnemies (i, j))
+                continue;
+
+            Vec2 offset = other->getPosition() - pos;
+            float distance = offset.length();
+            if (nearestEnemy < 0.0f || distance < nearestEnemy)
+            {
+                nearestEnemy = distance;
+                toEnemy = offset;
+            }
+        }
+
+        // Nearest enemy shell in flight
+        float nearestShell = -1.0f;
+        Vec2 toShell;
+        for (const Shell& shell : shells)
+        {
+            int owner = shell.getOwnerIndex();
+            if (! shell.isAlive() || shell.hasLanded() || owner == i || ! world.areEnemies (i, owner))
+                continue;
+
+            Vec2 offset = shell.getPosition() - pos;
+            float distance = offset.length();
+            if (nearestShell < 0.0f || distance < nearestShell)
+            {
+                nearestShell = distance;
+                toShell = offset;
+            }
+        }
+
+        row[enemyDistance] = nearestEnemy < 0.0f ? -(int32_t) positionScale : toFixed (nearestEnemy, positionScale);
+        row[enemyBearing] = nearestEnemy < 0.0f ? 0 : toFixedAngle (std::atan2 (toEnemy.y, toEnemy.x) - shipAngle);
+        row[shellDistance] = nearestShell < 0.0f ? -(int32_t) positionScale : toFixed (nearestShell, positionScale);
+        row[shellBearing] = nearestShell < 0.0f ? 0 : toFixedAngle (std::atan2 (toShell.y, toShell.x) - shipAngle);
+
+        const ShipInput& input = inputs[i];
+        row[moveX] = toFixed (input.move.x, unitScale);
+        row[moveY] = toFixed (input.move.y, unitScale);
+        row[aimX] = toFixed (input.aim.x, unitScale);
+        row[aimY] = toFixed (input.aim.y, unitScale);
+        row[fire] = input.fire ? 1 : 0;
+    }
+}
+
+//==============================================================================
+DatasetWriter::DatasetWriter()
+    : queue (128)  // ~2 seconds of ticks at 60Hz
+{
+    for (auto& shipColumns : staged)
+        for (auto& values : shipColumns)
+            values.reserve (TICKS_PER_CHUNK);
+}
+
+DatasetWriter::~DatasetWriter()
+{
+    close();
+}
+
+bool DatasetWriter::open (const std::string& path, const MatchHeader& header)
+{
+    close();
+
+    file.open (path, std::ios::binary | std::ios::trunc);
+    if (! file.is_open())
+        return false;
+
+    droppedFrames = 0;
+    numStagedTicks = 0;
+    for (auto& shipColumns : staged)
+        for (auto& values : shipColumns)
+            values.clear();
+
+    ByteWriter w;
+    header.write (w, magic, formatVersion);
+
+    w.writeVarint (DatasetFrame::numColumns);
+    for (const auto& column : columns)
+    {
+        size_t length = strlen (column.name);
+        w.writeVarint (length);
+        w.writeBytes (column.name, length);
+        w.writeFloat (column.scale);
+    }
+    file.write ((const char*) w.data().data(), (std::streamsize) w.size());
+
+    thread.start ([this] { drainQueue(); });
+    return true;
+}
+
+void DatasetWriter::addFrame (const World& world, uint32_t tick, bool waitIfFull)
+{
+    if (! isOpen())
+        return;
+
+    pending.capture (world, tick);
+    while (! queue.push (pending))
+    {
+        if (! waitIfFull)
+        {
+            droppedFrames++;
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void DatasetWriter::close()
+{
+    if (! isOpen())
+        return;
+
+    thread.stop();
+    writeChunk();
+
+    uint8_t end = endChunk;
+    file.write ((const char*) &end, 1);
+    file.close();
+}
+
+void DatasetWriter::drainQueue()
+{
+    while (const DatasetFrame* frame = queue.front())
+    {
+        for (int i = 0; i < World::MAX_SHIPS; ++i)
+            if ((frame->shipMask & (1u << i)) != 0)
+                for (int c = 0; c < DatasetFrame::numColumns; ++c)
+                    staged[i][c].push_back (frame->rows[i][c]);
+
+        queue.pop();
+
+        if (++numStagedTicks == TICKS_PER_CHUNK)
+            writeChunk();
+    }
+}
+
+void DatasetWriter::writeChunk()
+{
+    if (numStagedTicks == 0)
+        return;
+
+    size_t numRows = 0;
+    for (const auto& shipColumns : staged)
+        numRows += shipColumns[0].size();
+
+    // One block per column running through each ship in turn
+    chunk.clear();
+    std::vector<int32_t> column;
+    column.reserve (numRows);
+    for (int c = 0; c < DatasetFrame::numColumns; ++c)
+    {
+        column.clear();
+        for (const auto& shipColumns : staged)
+            column.insert (column.end(), shipColumns[c].begin(), shipColumns[c].end());
+
+        encodeBlock (chunk, column, block);
+    }
+
+    ByteWriter prefix;
+    prefix.writeU8 (dataChunk);
+    prefix.writeVarint (chunk.size());
+    prefix.writeVarint (numRows);
+    file.write ((const char*) prefix.data().data(), (std::streamsize) prefix.size());
+    file.write ((const char*) chunk.data().data(), (std::streamsize) chunk.size());
+
+    for (auto& shipColumns : staged)
+        for (auto& v : shipColumns)
+            v.clear();
+    numStagedTicks = 0;
+}
+
+//==============================================================================
+bool DatasetReader::open (const std::string& path)
+{
+    close();
+
+    if (! file.open (path))
+        return false;
+
+    ByteReader reader (file.getData(), file.getSize());
+    if (! readHeader (reader) || ! scanChunks (reader.position()))
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void DatasetReader::close()
+{
+    file.close();
+    header = {};
+    columnNames.clear();
+    columnScales.clear();
+    chunks.clear();
+    numRows = 0;
+}
+
+bool DatasetReader::readHeader (ByteReader& r)
+{
+    if (! header.read (r, magic, formatVersion))
+        return false;
+
+    uint64_t numColumns = r.readVarint();
+    if (numColumns > 1024)
+        return false;
+
+    for (uint64_t c = 0; c < numColumns && r.ok(); ++c)
+    {
+        // Checked before sizing the string, so a corrupt length can't ask for a huge one
+        uint64_t length = r.readVarint();
+        if (! r.ok() || length > 256 || length > r.getSize() - r.position())
+            return false;
+
+        std::string name ((size_t) length, '\0');
+        if (! r.readBytes (name.data(), name.size()))
+            return false;
+
+        float scale = r.readFloat();
+        if (! (scale > 0.0f))
+            return false;
+
+        columnNames.push_back (name);
+        columnScales.push_back (scale);
+    }
+
+    return r.ok();
+}
+
+bool DatasetReader::scanChunks (size_t start)
+{
+    ByteReader r (file.getData(), file.getSize());
+    r.seek (start);
+
+    while (! r.atEnd())
+    {
+        uint8_t type = r.readU8();
+        if (type == endChunk)
+            break;
+        if (type != dataChunk)
+            return false;
+
+        uint64_t size = r.readVarint();
+        uint64_t rows = r.readVarint();
+        size_t offset = r.position();
+
+        // A chunk cut short by a crash ends the readable part
+        if (! r.ok() || size > r.getSize() - offset)
+            break;
+
+        // Checked before anything is sized from it. A writer never puts more than a chunk's
+        // ticks of every ship in one, and each column's block takes at least 2 bytes
+        if (rows > (uint64_t) DatasetWriter::TICKS_PER_CHUNK * World::MAX_SHIPS || size < columnNames.size() * 2)
+            return false;
+
+        chunks.push_back ({ offset, (uint32_t) rows });
+        numRows += rows;
+        r.seek (offset + (size_t) size);
+    }
+
+    return true;
+}
+
+int DatasetReader::findColumn (const std::string& name) const
+{
+    for (size_t c = 0; c < columnNames.size(); ++c)
+        if (columnNames[c] == name)
+            return (int) c;
+    return -1;
+}
+
+bool DatasetReader::findBlock (const Chunk& chunk, int column, size_t& offset, size_t& size, uint8_t& encoding) const
+{
+    // Step over the blocks before it by their sizes alone
+    ByteReader r (file.getData(), file.getSize());
+    r.seek (chunk.offset);
+
+    for (int c = 0; c <= column; ++c)
+    {
+        encoding = r.readU8();
+        size = (size_t) r.readVarint();
+        offset = r.position();
+        if (! r.ok() || size > r.getSize() - offset)
+            return false;
+        r.seek (offset + size);
+    }
+
+    return true;
+}
+
+bool DatasetReader::readColumn (int column, std::vector<float>& values) const
+{
+    values.clear();
+    if (column < 0 || column >= getNumColumns())
+        return false;
+
+    values.reserve ((size_t) numRows);
+
+    for (const auto& chunk : chunks)
+    {
+        size_t offset, size;
+        uint8_t encoding;
+        if (! findBlock (chunk, column, offset, size, encoding))
+            return false;
+
+        ByteReader r (file.getData() + offset, size);
+        if (! decodeBlock (r, encoding, chunk.numRows, columnScales[(size_t) column], values))
+            return false;
+    }
+
+    return true;
+}
+
+uint64_t DatasetReader::getColumnBytes (int column) const
+{
+    uint64_t total = 0;
+    for (const auto& chunk : chunks)
+    {
+        size_t offset, size;
+        uint8_t encoding;
+        if (findBlock (chunk, column, offset, size, encoding))
+            total += size;
+    }
+    return total;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "BinaryIO.h"
+#include "Recording.h"
+#include "SpscQueue.h"
+#include "World.h"
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// Datasets
+// Per-tick, per-ship training data for imitation learning: the state an AI
+// sees (its ship, its turrets, the nearest enemy and incoming shell) next to
+// the action the ship took, whether a human or the AI chose it. Stored column
+// by column in chunks of a few seconds, each column block compressed on its
+// own, so scanning a few columns of a long session only reads those blocks.
+// Written append-only on a background thread like state streams.
+// =============================================================================
+
+struct DatasetFrame
+{
+    enum Column
+    {
+        tick,
+        ship,
+        human,                              // 1 if a human was steering
+        alive,
+        x, y,
+        velocityX, velocityY,
+        angle,
+        health,
+        turretAngle,                        // 4 turrets, relative to the hull
+        turretReload = turretAngle + 4,
+        crosshairX = turretReload + 4,      // Offset from the ship
+        crosshairY,
+        enemyDistance,                      // Nearest living enemy, -1 if none
+        enemyBearing,                       // Relative to the bow, -pi to pi
+        shellDistance,                      // Nearest enemy shell in flight, -1 if none
+        shellBearing,
+        moveX, moveY,                       // The action
+        aimX, aimY,
+        fire,
+        numColumns
+    };
+
+    using Row = std::array<int32_t, numColumns>;
+
+    uint32_t tickNumber = 0;
+    uint32_t shipMask = 0;                  // Ships with a row this tick
+    std::array<Row, World::MAX_SHIPS> rows = {};
+
+    // Copies every present ship's state and the inputs from the world's last step
+    void capture (const World& world, uint32_t frameTick);
+};
+
+namespace Dataset
+{
+    constexpr const char* fileExtension = ".hld";
+
+    // Values are stored as fixed point: the stored integer divided by the column's scale
+    const char* getColumnName (int column);
+    float getColumnScale (int column);
+}
+
+// Stages each captured ship's values by column and writes them out in chunks of
+// TICKS_PER_CHUNK ticks, one encoded block per column, on a RecordingThread
+class DatasetWriter
+{
+public:
+    static constexpr uint32_t TICKS_PER_CHUNK = 600;
+
+    DatasetWriter();
+    ~DatasetWriter();
+
+    bool open (const std::string& path, const MatchHeader& header);
+
+    // Game thread: queue the world's state and actions after a tick. If the
+    // writer falls behind the frame is dropped. Offline recordings can wait instead.
+    void addFrame (const World& world, uint32_t tick, bool waitIfFull = false);
+
+    // Flushes the queue and the last partial chunk, and closes the file
+    void close();
+
+    bool isOpen() const                     { return thread.isRunning(); }
+    uint32_t getNumDroppedFrames() const    { return droppedFrames; }
+
+private:
+    SpscQueue<DatasetFrame> queue;
+    DatasetFrame pending;               // Game thread scratch frame
+    uint32_t droppedFrames = 0;
+
+    RecordingThread thread;
+
+    // Writer thread. Rows wait here column by column, per ship, until the chunk is full
+    std::ofstream file;
+    std::array<std::array<std::vector<int32_t>, DatasetFrame::numColumns>, World::MAX_SHIPS> staged;
+    uint32_t numStagedTicks = 0;
+    ByteWriter chunk;
+    ByteWriter block;
+
+    void drainQueue();
+    void writeChunk();
+};
+
+// Reads a dataset through a memory mapping, a column at a time
+class DatasetReader
+{
+public:
+    bool open (const std::string& path);
+    void close();
+
+    const MatchHeader& getHeader() const    { return header; }
+    uint64_t getNumRows() const             { return numRows; }
+    size_t getNumChunks() const             { return chunks.size(); }
+
+    // Columns as stored in the file, which may be a different set to this build's
+    int getNumColumns() const               { return (int) columnNames.size(); }
+    const std::string& getColumnName (int column) const { return columnNames[(size_t) column]; }
+    int findColumn (const std::string& name) const;  // -1 if the file doesn't have it
+
+    // Decodes a whole column, every chunk in order. Rows are grouped by ship
+    // within each chunk, so pair columns up by row index (or use tick and ship)
+    bool readColumn (int column, std::vector<float>& values) const;
+
+    // Compressed bytes of a column across every chunk
+    uint64_t getColumnBytes (int column) const;
+
+private:
+    struct Chunk
+    {
+        size_t offset;      // First column block
+        uint32_t numRows;
+    };
+
+    MappedFile file;
+    MatchHeader header;
+    std::vector<std::string> columnNames;
+    std::vector<float> columnScales;
+    std::vector<Chunk> chunks;
+    uint64_t numRows = 0;
+
+    bool readHeader (ByteReader& reader);
+    bool scanChunks (size_t start);
+    bool findBlock (const Chunk& chunk, int column, size_t& offset, size_t& size, uint8_t& encoding) const;
+};
@@ -0,0 +1,193 @@
+#include "EventLog.h"
+#include <algorithm>
+#include <cmath>
+
+// File layout:
+//   "HLEV" u8 version, match header
+//   Events, appended as they happen:
+//     u8 type, varint ticks since the last event, varint ship + 1, varint other + 1,
+//     signed varint x and y in 1/16 pixels, f32 magnitude
+//   u8 end marker
+// An unfinished file (no end marker) is still readable up to its last whole event.
+
+namespace
+{
+    const uint8_t magic[4] = { 'H', 'L', 'E', 'V' };
+    constexpr uint8_t formatVersion = 1;
+    constexpr uint8_t endMarker = 0xff;
+
+    constexpr float positionScale = 16.0f;
+    constexpr int numTypes = (int) WorldEvent::Type::MatchEnd + 1;
+}
+
+const char* EventLog::getTypeName (WorldEvent::Type type)
+{
+    switch (type)
+    {
+        case WorldEvent::Type::Fire:        return "fire";
+        case WorldEvent::Type::Hit:         return "hit";
+        case WorldEvent::Type::Splash:      return "splash";
+        case WorldEvent::Type::Collision:   return "collision";
+        case WorldEvent::Type::Grounding:   return "grounding";
+        case WorldEvent::Type::Sink:        return "sink";
+        case WorldEvent::Type::MatchEnd:    return "matchEnd";
+    }
+    return "unknown";
+}
+
+//==============================================================================
+EventLogWriter::EventLogWriter()
+    : queue (4096)  // A busy battle fires a few hundred shells a second
+{
+}
+
+EventLogWriter::~EventLogWriter()
+{
+    close();
+}
+
+bool EventLogWriter::open (const std::string& path, const MatchHeader& header)
+{
+    close();
+
+    file.open (path, std::ios::binary | std::ios::trunc);
+    if (! file.is_open())
+        return false;
+
+    droppedEvents = 0;
+    lastTick = 0;
+
+    buffer.clear();
+
+    ByteWriter w;
+    header.write (w, magic, formatVersion);
+    file.write ((const char*) w.data().data(), (std::streamsize) w.size());
+
+    thread.start ([this] { drainQueue(); });
+    return true;
+}
+
+void EventLogWriter::addEvents (const World& world, uint32_t tick, bool waitIfFull)
+{
+    if (! isOpen())
+        return;
+
+    for (const WorldEvent& event : world.getEvents())
+    {
+        while (! queue.push ({ tick, event }))
+        {
+            if (! waitIfFull)
+            {
+                droppedEvents++;
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+void EventLogWriter::close()
+{
+    if (! isOpen())
+        return;
+
+    thread.stop();
+
+    uint8_t end = endMarker;
+    file.write ((const char*) &end, 1);
+    file.close();
+}
+
+void EventLogWriter::drainQueue()
+{
+    while (const LoggedEvent* logged = queue.front())
+    {
+        encode (*logged);
+        queue.pop();
+    }
+
+    if (buffer.size() > 0)
+    {
+        file.write ((const char*) buffer.data().data(), (std::streamsize) buffer.size());
+        buffer.clear();
+    }
+}
+
+void EventLogWriter::encode (const LoggedEvent& logged)
+{
+    const WorldEvent& event = logged.event;
+
+    buffer.writeU8 ((uint8_t) event.type);
+    buffer.writeVarint (logged.tick - lastTick);
+    buffer.writeVarint ((uint64_t) (event.ship + 1));
+    buffer.writeVarint ((uint64_t) (event.other + 1));
+    buffer.writeSigned (std::lround (event.position.x * positionScale));
+    buffer.writeSigned (std::lround (event.position.y * positionScale));
+    buffer.writeFloat (event.magnitude);
+
+    lastTick = logged.tick;
+}
+
+//==============================================================================
+bool EventLogReader::open (const std::string& path)
+{
+    header = {};
+    events.clear();
+    complete = false;
+
+    std::vector<uint8_t> bytes;
+    if (! readFile (path, bytes))
+        return false;
+
+    ByteReader r (bytes.data(), bytes.size());
+
+    if (! header.read (r, magic, formatVersion))
+        return false;
+
+    uint32_t tick = 0;
+    while (! r.atEnd())
+    {
+        uint8_t type = r.readU8();
+        if (type == endMarker)
+        {
+            complete = true;
+            break;
+        }
+        if (type >= numTypes)
+            return false;
+
+        LoggedEvent logged;
+        logged.event.type = (WorldEvent::Type) type;
+        tick += (uint32_t) r.readVarint();
+        logged.tick = tick;
+        logged.event.ship = (int) r.readVarint() - 1;
+        logged.event.other = (int) r.readVarint() - 1;
+        logged.event.position.x = (float) r.readSigned() / positionScale;
+        logged.event.position.y = (float) r.readSigned() / positionScale;
+        logged.event.magnitude = r.readFloat();
+
+        // A crash mid-event ends the readable part
+        if (! r.ok())
+            break;
+
+        events.push_back (logged);
+    }
+
+    return true;
+}
+
+bool EventLogReader::writeCsv (FILE* out) const
+{
+    float tickRate = std::max (1.0f, header.tickRate);
+
+    fprintf (out, "tick,time,type,ship,other,x,y,magnitude\n");
+    for (const LoggedEvent& logged : events)
+    {
+        const WorldEvent& event = logged.event;
+        fprintf (out, "%u,%.3f,%s,%d,%d,%.2f,%.2f,%g\n", logged.tick, logged.tick / tickRate,
+                 EventLog::getTypeName (event.type), event.ship, event.other,
+                 event.position.x, event.position.y, event.magnitude);
+    }
+
+    return ferror (out) == 0;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "BinaryIO.h"
+#include "Recording.h"
+#include "SpscQueue.h"
+#include "World.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// Event logs
+// The gameplay events of a match (shots, hits, splashes, collisions,
+// groundings, sinkings and the result) with the tick they happened on, for
+// per-match analytics. The simulating thread only copies events into its own
+// lock-free ring; a background thread encodes them and does all the file I/O,
+// so logging adds no disk waits to a frame.
+// =============================================================================
+
+struct LoggedEvent
+{
+    uint32_t tick = 0;
+    WorldEvent event;
+};
+
+namespace EventLog
+{
+    constexpr const char* fileExtension = ".hle";
+
+    const char* getTypeName (WorldEvent::Type type);
+}
+
+// One writer per simulating thread: addEvents() must always be called from the same thread
+class EventLogWriter
+{
+public:
+    EventLogWriter();
+    ~EventLogWriter();
+
+    bool open (const std::string& path, const MatchHeader& header);
+
+    // Simulating thread: queue the events from the world's last step. If the
+    // writer falls behind they are dropped. Offline recordings can wait instead.
+    void addEvents (const World& world, uint32_t tick, bool waitIfFull = false);
+
+    // Flushes the queue and closes the file
+    void close();
+
+    bool isOpen() const                     { return thread.isRunning(); }
+    uint32_t getNumDroppedEvents() const    { return droppedEvents; }
+
+private:
+    SpscQueue<LoggedEvent> queue;
+    uint32_t droppedEvents = 0;
+
+    RecordingThread thread;
+
+    // Writer thread
+    std::ofstream file;
+    ByteWriter buffer;
+    uint32_t lastTick = 0;
+
+    void drainQueue();
+    void encode (const LoggedEvent& logged);
+};
+
+// Reads a whole event log. A log cut short by a crash reads up to its last whole event
+class EventLogReader
+{
+public:
+    bool open (const std::string& path);
+
+    const MatchHeader& getHeader() const           { return header; }
+    const std::vector<LoggedEvent>& getEvents() const { return events; }
+    bool isComplete() const                         { return complete; }
+
+    // One line per event: tick, time, type, ship, other, x, y, magnitude
+    bool writeCsv (FILE* out) const;
+
+private:
+    MatchHeader header;
+    std::vector<LoggedEvent> events;
+    bool complete = false;
+};
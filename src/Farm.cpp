@@ -0,0 +1,451 @@
+#include "Farm.h"
+#include "Config.h"
+#include "ShipHulls.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#if ! defined(_WIN32)
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Protocol, one line each way per job:
+//   coordinator -> worker: the match spec as JSON {"mode", "seed", "shipTypes", "maxTime"}
+//   worker -> coordinator: "ok " + the result as JSON, or "error " + a message
+// A worker applies its config overrides once when it starts, so a worker is
+// replaced when the next job needs different overrides.
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Missing values keep their defaults
+    bool specFromJson (const nlohmann::json& j, MatchSpec& spec)
+    {
+        try
+        {
+            if (! j.is_object() || ! Batch::parseMode (j.value ("mode", "ffa"), spec.mode))
+                return false;
+
+            spec.seed = j.value ("seed", spec.seed);
+            spec.maxMatchTime = j.value ("maxTime", spec.maxMatchTime);
+
+            if (j.contains ("shipTypes"))
+            {
+                const auto& types = j["shipTypes"];
+                for (size_t i = 0; i < types.size() && i < spec.shipTypes.size(); ++i)
+                    spec.shipTypes[i] = std::clamp (types[i].get<int>(), -1, NUM_SHIP_TYPES - 1);
+            }
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+        return spec.maxMatchTime > 0.0f;
+    }
+
+   #if ! defined(_WIN32)
+    nlohmann::json specToJson (const MatchSpec& spec)
+    {
+        return {
+            { "mode", Batch::getModeName (spec.mode) },
+            { "seed", spec.seed },
+            { "shipTypes", spec.shipTypes },
+            { "maxTime", spec.maxMatchTime }
+        };
+    }
+
+    struct Worker
+    {
+        pid_t pid = -1;
+        int fd = -1;
+        std::string overrides;    // Config overrides it was started with
+        std::string input;        // Bytes received that don't make a whole line yet
+        int job = -1;             // Job in progress, -1 = idle
+        Clock::time_point jobStart;
+
+        bool isRunning() const { return pid > 0; }
+    };
+
+    bool writeAll (int fd, const std::string& text)
+    {
+        size_t written = 0;
+        while (written < text.size())
+        {
+            ssize_t n = write (fd, text.data() + written, text.size() - written);
+            if (n <= 0)
+                return false;
+            written += (size_t) n;
+        }
+        return true;
+    }
+
+    // Takes the next complete line out of the buffer
+    bool takeLine (std::string& buffer, std::string& line)
+    {
+        size_t newline = buffer.find ('\n');
+        if (newline == std::string::npos)
+            return false;
+
+        line = buffer.substr (0, newline);
+        buffer.erase (0, newline + 1);
+        return true;
+    }
+
+    // The worker process: runs matches until the coordinator closes the socket
+    [[noreturn]] void runWorker (int fd, const ShipHulls& hulls, const std::string& overrides)
+    {
+        bool configOk = overrides.empty() || config.loadFromString (overrides);
+
+        World world (hulls);
+        world.setCosmeticsEnabled (false);
+
+        std::string input, line;
+        char buffer[4096];
+
+        for (;;)
+        {
+            while (! takeLine (input, line))
+            {
+                ssize_t n = read (fd, buffer, sizeof (buffer));
+                if (n <= 0)
+                    _exit (0);
+                input.append (buffer, (size_t) n);
+            }
+
+            MatchSpec spec;
+            nlohmann::json j = nlohmann::json::parse (line, nullptr, false);
+
+            std::string reply;
+            if (! configOk)
+                reply = "error invalid config overrides";
+            else if (! specFromJson (j, spec))
+                reply = "error invalid match spec";
+            else
+                reply = "ok " + Batch::resultToJson (Batch::runMatch (world, spec));
+
+            if (! writeAll (fd, reply + "\n"))
+                _exit (0);
+        }
+    }
+
+    std::string describeExit (int status)
+    {
+        if (WIFSIGNALED (status))
+            return "worker crashed (signal " + std::to_string (WTERMSIG (status)) + ")";
+        if (WIFEXITED (status))
+            return "worker exited (code " + std::to_string (WEXITSTATUS (status)) + ")";
+        return "worker stopped";
+    }
+
+    class Coordinator
+    {
+    public:
+        Coordinator (const ShipHulls& hulls_, const std::vector<FarmJob>& jobs_, const FarmSettings& settings_,
+                     const std::function<void (size_t, const FarmOutcome&)>& onOutcome_)
+            : hulls (hulls_), jobs (jobs_), settings (settings_), onOutcome (onOutcome_),
+              outcomes (jobs_.size()), workers ((size_t) std::max (1, settings_.numWorkers))
+        {
+            for (size_t i = 0; i < jobs.size(); ++i)
+                pending.push_back (i);
+        }
+
+        ~Coordinator()
+        {
+            for (auto& worker : workers)
+                stop (worker);
+        }
+
+        std::vector<FarmOutcome> run()
+        {
+            while (numFinished < jobs.size())
+            {
+                for (auto& worker : workers)
+                    if (worker.job < 0 && ! pending.empty())
+                        startNextJob (worker);
+
+                waitForReplies();
+                checkTimeouts();
+            }
+
+            return std::move (outcomes);
+        }
+
+    private:
+        const ShipHulls& hulls;
+        const std::vector<FarmJob>& jobs;
+        const FarmSettings& settings;
+        const std::function<void (size_t, const FarmOutcome&)>& onOutcome;
+
+        std::vector<FarmOutcome> outcomes;
+        std::vector<Worker> workers;
+        std::vector<size_t> pending;  // Jobs waiting for a worker, in order
+        size_t numFinished = 0;
+
+        void startNextJob (Worker& worker)
+        {
+            // Prefer a job this worker's config suits, otherwise replace the worker
+            auto next = pending.begin();
+            if (worker.isRunning())
+            {
+                next = std::find_if (pending.begin(), pending.end(), [&] (size_t job)
+                                     { return jobs[job].configOverrides == worker.overrides; });
+
+                if (next == pending.end())
+                {
+                    next = pending.begin();
+                    stop (worker);
+                }
+            }
+
+            size_t job = *next;
+            pending.erase (next);
+
+            if (! worker.isRunning() && ! spawn (worker, jobs[job].configOverrides))
+            {
+                fail (job, "couldn't start a worker");
+                return;
+            }
+
+            outcomes[job].attempts++;
+            worker.job = (int) job;
+            worker.jobStart = Clock::now();
+
+            if (! writeAll (worker.fd, specToJson (jobs[job].spec).dump() + "\n"))
+                lose (worker, "couldn't send the job to its worker");
+        }
+
+        bool spawn (Worker& worker, const std::string& overrides)
+        {
+            int fds[2];
+            if (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+                return false;
+
+            // Don't let the child inherit unwritten output and print it twice
+            fflush (stdout);
+            fflush (stderr);
+
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                close (fds[0]);
+                close (fds[1]);
+                return false;
+            }
+
+            if (pid == 0)
+            {
+                close (fds[0]);
+                for (const auto& other : workers)
+                    if (other.fd >= 0)
+                        close (other.fd);
+
+                runWorker (fds[1], hulls, overrides);
+            }
+
+            close (fds[1]);
+            worker.pid = pid;
+            worker.fd = fds[0];
+            worker.overrides = overrides;
+            worker.input.clear();
+            return true;
+        }
+
+        // Closing the socket tells a healthy worker to exit. Returns how it ended
+        int stop (Worker& worker, bool kill = false)
+        {
+            int status = 0;
+            if (! worker.isRunning())
+                return status;
+
+            if (kill)
+                ::kill (worker.pid, SIGKILL);
+
+            close (worker.fd);
+            waitpid (worker.pid, &status, 0);
+
+            worker.pid = -1;
+            worker.fd = -1;
+            worker.job = -1;
+            return status;
+        }
+
+        // The worker died or hung with a job in progress: retry it, or give up after enough attempts
+        void lose (Worker& worker, const std::string& reason, bool kill = false)
+        {
+            size_t job = (size_t) worker.job;
+            int status = stop (worker, kill);
+            std::string error = reason.empty() ? describeExit (status) : reason;
+
+            if (outcomes[job].attempts < settings.maxAttempts)
+            {
+                outcomes[job].error = error;
+                pending.insert (pending.begin(), job);
+            }
+            else
+            {
+                fail (job, error);
+            }
+        }
+
+        void fail (size_t job, const std::string& error)
+        {
+            outcomes[job].ok = false;
+            outcomes[job].error = error;
+            finish (job);
+        }
+
+        void finish (size_t job)
+        {
+            numFinished++;
+            if (onOutcome)
+                onOutcome (job, outcomes[job]);
+        }
+
+        void handleReply (Worker& worker, const std::string& line)
+        {
+            size_t job = (size_t) worker.job;
+            worker.job = -1;
+
+            FarmOutcome& outcome = outcomes[job];
+            if (line.rfind ("ok ", 0) == 0 && Batch::resultFromJson (line.substr (3), outcome.result))
+            {
+                outcome.ok = true;
+                finish (job);
+            }
+            else
+            {
+                // The worker is fine, the job can't run (a bad config value) and would fail again
+                fail (job, line.rfind ("error ", 0) == 0 ? line.substr (6) : "invalid reply from worker");
+            }
+        }
+
+        void waitForReplies()
+        {
+            std::vector<pollfd> fds;
+            std::vector<Worker*> polled;
+            for (auto& worker : workers)
+            {
+                if (worker.job >= 0)
+                {
+                    fds.push_back ({ worker.fd, POLLIN, 0 });
+                    polled.push_back (&worker);
+                }
+            }
+
+            if (fds.empty() || poll (fds.data(), (nfds_t) fds.size(), 1000) <= 0)
+                return;
+
+            for (size_t i = 0; i < fds.size(); ++i)
+            {
+                if (fds[i].revents == 0)
+                    continue;
+
+                Worker& worker = *polled[i];
+                char buffer[4096];
+                ssize_t n = read (worker.fd, buffer, sizeof (buffer));
+                if (n <= 0)
+                {
+                    lose (worker, "");
+                    continue;
+                }
+
+                worker.input.append (buffer, (size_t) n);
+
+                std::string line;
+                if (takeLine (worker.input, line))
+                    handleReply (worker, line);
+            }
+        }
+
+        void checkTimeouts()
+        {
+            auto now = Clock::now();
+            for (auto& worker : workers)
+                if (worker.job >= 0 && std::chrono::duration<float> (now - worker.jobStart).count() > settings.jobTimeout)
+                    lose (worker, "worker timed out", true);
+        }
+    };
+   #endif
+}
+
+bool Farm::isSupported()
+{
+   #if defined(_WIN32)
+    return false;
+   #else
+    return true;
+   #endif
+}
+
+std::vector<FarmOutcome> Farm::run (const ShipHulls& hulls, const std::vector<FarmJob>& jobs, const FarmSettings& settings,
+                                    const std::function<void (size_t index, const FarmOutcome&)>& onOutcome)
+{
+   #if defined(_WIN32)
+    std::vector<FarmOutcome> outcomes (jobs.size());
+    for (auto& outcome : outcomes)
+        outcome.error = "worker processes aren't supported on this platform";
+    return outcomes;
+   #else
+    // A worker dying mid-write must not take the coordinator with it
+    signal (SIGPIPE, SIG_IGN);
+
+    FarmSettings actual = settings;
+    if (actual.numWorkers <= 0)
+        actual.numWorkers = Batch::getDefaultNumThreads();
+    actual.numWorkers = (int) std::min ((size_t) actual.numWorkers, std::max ((size_t) 1, jobs.size()));
+    actual.maxAttempts = std::max (1, actual.maxAttempts);
+
+    Coordinator coordinator (hulls, jobs, actual, onOutcome);
+    return coordinator.run();
+   #endif
+}
+
+bool Farm::loadJobs (const std::string& path, std::vector<FarmJob>& jobs, std::string& error)
+{
+    std::ifstream file (path);
+    if (! file.is_open())
+    {
+        error = "couldn't open " + path;
+        return false;
+    }
+
+    nlohmann::json j = nlohmann::json::parse (file, nullptr, false);
+    if (! j.is_array())
+    {
+        error = path + " isn't a JSON array of jobs";
+        return false;
+    }
+
+    for (size_t i = 0; i < j.size(); ++i)
+    {
+        const auto& entry = j[i];
+
+        FarmJob job;
+        if (! specFromJson (entry, job.spec))
+        {
+            error = "job " + std::to_string (i + 1) + " has an invalid mode, seed, shipTypes or maxTime";
+            return false;
+        }
+
+        if (entry.contains ("config"))
+            job.configOverrides = entry["config"].dump();
+
+        int matches = entry.contains ("matches") && entry["matches"].is_number_integer() ? entry["matches"].get<int>() : 1;
+        uint64_t seed = job.spec.seed;
+        for (int m = 0; m < matches; ++m)
+        {
+            job.spec.seed = seed + (uint64_t) m;
+            jobs.push_back (job);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Batch.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+class ShipHulls;
+
+// =============================================================================
+// Farm
+// Runs matches in a pool of worker processes, each talking to the coordinator
+// over a Unix domain socket. A match that crashes or hangs its worker (a bad
+// config value, a bug) only loses that worker: it is restarted and the match
+// retried. Workers are forked from the coordinator, so they never need a
+// display and each has its own copy of the config. POSIX only.
+// =============================================================================
+
+struct FarmJob
+{
+    MatchSpec spec;
+    std::string configOverrides;  // JSON laid out like config.json, applied on top of the coordinator's config
+};
+
+struct FarmOutcome
+{
+    bool ok = false;
+    MatchResult result;
+    std::string error;  // Why the last failed attempt failed (a retried job can still succeed)
+    int attempts = 0;
+};
+
+struct FarmSettings
+{
+    int numWorkers = 0;          // 0 = one per core
+    int maxAttempts = 3;         // Crashed or hung jobs are retried up to this many runs in total
+    float jobTimeout = 600.0f;   // Wall clock seconds before a worker is presumed hung and killed
+};
+
+namespace Farm
+{
+    bool isSupported();
+
+    // Runs every job and returns the outcomes in job order. onOutcome is called as each one finishes
+    std::vector<FarmOutcome> run (const ShipHulls& hulls, const std::vector<FarmJob>& jobs, const FarmSettings& settings,
+                                  const std::function<void (size_t index, const FarmOutcome&)>& onOutcome = {});
+
+    // A job file is a JSON array of {"mode", "seed", "matches", "shipTypes", "maxTime", "config"}.
+    // Each entry expands to "matches" jobs (default 1) seeded seed, seed + 1, ...
+    bool loadJobs (const std::string& path, std::vector<FarmJob>& jobs, std::string& error);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ShipStats.h"
+#include "Vec2.h"
+#include <array>
+
+// =============================================================================
+// Fleet
+// The per-step state of every ship in a match, stored field by field rather
+// than ship by ship. Ship and Turret objects are views onto one row and keep
+// only their fixed layout and cold data (cosmetics, random streams), so
+// systems that touch one or two fields of every ship - collision broad phase,
+// snapshots - sweep a few packed arrays instead of visiting each ship object.
+// Plain data, so a whole fleet can be copied in one go.
+// =============================================================================
+
+struct Fleet
+{
+    static constexpr int MAX_SHIPS = 12;
+    static constexpr int MAX_TURRETS = 4;
+
+    // Transforms
+    std::array<Vec2, MAX_SHIPS> position;
+    std::array<float, MAX_SHIPS> angle = {};
+    std::array<Vec2, MAX_SHIPS> prevPosition;   // At the start of the last step, for render interpolation
+    std::array<float, MAX_SHIPS> prevAngle = {};
+    std::array<float, MAX_SHIPS> boundingRadius = {};  // Circle around the whole hull
+
+    // Worked out from the transforms once a ship has moved, so nothing else needs to
+    // call cos/sin on its angle or rotate its hull again during the step
+    std::array<Vec2, MAX_SHIPS> heading;        // cos, sin of angle
+    std::array<Vec2x4, MAX_SHIPS> corners;      // Hull rectangle in the world: back-left, front-left, front-right, back-right
+
+    // Kinematics and aim
+    std::array<Vec2, MAX_SHIPS> velocity;
+    std::array<float, MAX_SHIPS> angularVelocity = {};
+    std::array<float, MAX_SHIPS> throttle = {};
+    std::array<float, MAX_SHIPS> rudder = {};
+    std::array<Vec2, MAX_SHIPS> crosshairOffset;
+
+    // Health
+    std::array<float, MAX_SHIPS> health = {};
+    std::array<float, MAX_SHIPS> sinkTimer = {};
+    std::array<bool, MAX_SHIPS> sinking = {};
+    std::array<ShipStats, MAX_SHIPS> stats;     // Kept up to date with the config and health
+
+    // Turrets. A ship's turrets sit next to each other, see getTurretSlot()
+    std::array<float, MAX_SHIPS * MAX_TURRETS> turretAngle = {};
+    std::array<float, MAX_SHIPS * MAX_TURRETS> turretTargetAngle = {};
+    std::array<float, MAX_SHIPS * MAX_TURRETS> turretDesiredAngle = {};
+    std::array<float, MAX_SHIPS * MAX_TURRETS> turretFireTimer = {};
+
+    static int getTurretSlot (int ship, int turret)     { return ship * MAX_TURRETS + turret; }
+
+    // False when ships i and j are too far apart for their hulls to touch
+    bool mightCollide (int i, int j) const
+    {
+        Vec2 offset = position[j] - position[i];
+        float reach = boundingRadius[i] + boundingRadius[j];
+        return offset.lengthSquared() <= reach * reach;
+    }
+};
@@ -1,9 +1,36 @@
 #include "Game.h"
+#include "Platform.h"
 #include <raylib.h>
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <random>
 #include <vector>
 
+namespace
+{
+    constexpr float minTimeScale = 0.25f;
+    constexpr float maxTimeScale = 50.0f;
+}
+
+// Fresh 64-bit seed from the OS for each match
+static uint64_t makeMatchSeed()
+{
+    std::random_device rd;
+    return ((uint64_t) rd() << 32) | (uint64_t) rd();
+}
+
+// Timestamped so recordings sort oldest first
+static std::string makeReplayName()
+{
+    char name[64];
+    std::time_t now = std::time (nullptr);
+    std::strftime (name, sizeof (name), "replay-%Y%m%d-%H%M%S", std::localtime (&now));
+    return name;
+}
+
 Game::Game() = default;
 
 Game::~Game() = default;
@@ -16,7 +43,9 @@ bool Game::init()
     SetExitKey (0);  // Disable raylib's default ESC-to-close behavior
     HideCursor();
 
-    renderer = std::make_unique<Renderer>();
+    hulls = std::make_unique<ShipHulls>();
+    world = std::make_unique<World> (*hulls);
+    renderer = std::make_unique<Renderer> (*hulls);
     audio = std::make_unique<Audio>();
 
     if (! audio->init())
@@ -30,19 +59,18 @@ bool Game::init()
         audio->setMasterVolume (config.audioMasterVolume);
     }
 
+    titleRandom.seed (makeMatchSeed(), 0);
+
     // Create players (but not ships yet - those are created when game starts)
     for (int i = 0; i < MAX_PLAYERS; ++i)
     {
         players[i] = std::make_unique<Player> (i);
     }
-    for (int i = 0; i < MAX_SHIPS; ++i)
-    {
-        aiControllers[i] = std::make_unique<AIController>();
-    }
 
     state = GameState::Title;
     running = true;
     lastFrameTime = GetTime();
+    timeScale = std::clamp (config.simTimeScale, minTimeScale, maxTimeScale);
 
     return true;
 }
@@ -55,22 +83,28 @@ void Game::run()
         float dt = (float) (currentTime - lastFrameTime);
         lastFrameTime = currentTime;
 
-        // Cap delta time to avoid spiral of death
+        // Cap delta time to avoid spiral of death (at most a handful of fixed simulation steps per frame)
         if (dt > 0.1f)
             dt = 0.1f;
 
+        AllocTracker::Counts frameStart = AllocTracker::getCounts();
+
         handleEvents();
         update (dt);
         render();
+
+        lastFrameAllocations = AllocTracker::getCounts() - frameStart;
     }
 }
 
 void Game::shutdown()
 {
-    ships = {};
+    finishRecording (false);
+
     players = {};
-    aiControllers = {};
     renderer.reset();
+    world.reset();
+    hulls.reset();
     if (audio)
         audio->shutdown();
     audio.reset();
@@ -87,16 +121,25 @@ void Game::handleEvents()
         else
             returnToTitle();
     }
+
+    if (IsKeyPressed (KEY_F3) && AllocTracker::isActive())
+        showAllocations = ! showAllocations;
 }
 
 void Game::update (float dt)
 {
+    // A changed config.json is parsed on the watcher thread and swapped in here, between frames
+    ConfigChanges configChanges = config.applyReload();
+    if (configChanges.any())
+        configChanged (configChanges);
+
     // Update total time for animations
     time += dt;
 
     // Update audio
     if (audio)
     {
+        AllocTracker::Scope scope (AllocTracker::Tag::Audio);
         audio->update (dt);
     }
 
@@ -109,8 +152,11 @@ void Game::update (float dt)
     switch (state)
     {
         case GameState::Title:
+        {
+            AllocTracker::Scope scope (AllocTracker::Tag::Interface);
             updateTitle (dt);
             break;
+        }
         case GameState::Playing:
             updatePlaying (dt);
             break;
@@ -120,6 +166,14 @@ void Game::update (float dt)
     }
 }
 
+void Game::configChanged (const ConfigChanges& changes)
+{
+    if (ShipStats::isAffectedBy (changes))
+        world->refreshShipStats();
+
+    renderer->configChanged (changes);
+}
+
 void Game::updateTitle (float dt)
 {
     // Check if any human player is locked in (blocks mode switching)
@@ -134,9 +188,6 @@ void Game::updateTitle (float dt)
     }
 
     // Check for mode switching with bumpers or arrow keys (only if nobody is locked in)
-    static bool leftWasPressed = false;
-    static bool rightWasPressed = false;
-
     bool leftPressed = IsKeyDown (KEY_LEFT);
     bool rightPressed = IsKeyDown (KEY_RIGHT);
 
@@ -165,9 +216,6 @@ void Game::updateTitle (float dt)
     rightWasPressed = rightPressed;
 
     // Ship selection with D-pad or face buttons for each connected player (blocked when locked in)
-    static std::array<bool, MAX_PLAYERS> upWasPressed = {};
-    static std::array<bool, MAX_PLAYERS> downWasPressed = {};
-
     for (int i = 0; i < MAX_PLAYERS; ++i)
     {
         if (!players[i]->isConnected())
@@ -212,9 +260,6 @@ void Game::updateTitle (float dt)
     // Volume control with triggers (up/down keys or gamepad triggers)
     if (audio)
     {
-        static bool volumeDownWasPressed = false;
-        static bool volumeUpWasPressed = false;
-
         bool volumeDownPressed = IsKeyDown (KEY_DOWN);
         bool volumeUpPressed = IsKeyDown (KEY_UP);
 
@@ -256,12 +301,12 @@ void Game::updateTitle (float dt)
     if (aiShipChangeTimer <= 0.0f)
     {
         // Pick a random AI slot and change its ship
-        int slot = rand() % MAX_PLAYERS;
+        int slot = titleRandom.nextInt (MAX_PLAYERS);
         if (!players[slot]->isConnected())
         {
-            aiShipSelection[slot] = rand() % NUM_SHIP_TYPES;
+            aiShipSelection[slot] = titleRandom.nextInt (NUM_SHIP_TYPES);
         }
-        aiShipChangeTimer = 0.3f + (rand() % 100) / 200.0f; // 0.3-0.8 seconds
+        aiShipChangeTimer = titleRandom.nextFloat (0.3f, 0.8f); // 0.3-0.8 seconds
     }
 
     // Ready-up: A button to lock in, B button to back out
@@ -356,244 +401,180 @@ bool Game::anyButtonPressed()
 
 void Game::startGame()
 {
-    // Create ships at starting positions
-    bool isTeamMode = (gameMode == GameMode::Teams || gameMode == GameMode::Battle);
-    int numShips = getNumShipsForMode();
+    // Determine ship types: use player selection for humans, random for AI
+    World::ShipTypes shipTypes;
+    shipTypes.fill (-1);
 
+    int numShips = getNumShipsForMode();
     for (int i = 0; i < numShips; ++i)
     {
-        int team = isTeamMode ? getTeam (i) : -1;
-
-        // Determine ship type: use player selection for humans, random for AI
         int playerIdx = getPlayerIndexForShip (i);
-        int shipType;
         if (playerIdx >= 0 && players[playerIdx]->isConnected())
-        {
-            // Human player - use their selection
-            shipType = playerShipSelection[playerIdx];
-        }
-        else
-        {
-            // AI - random ship type
-            shipType = rand() % NUM_SHIP_TYPES;
-        }
-
-        float shipLength = renderer->getShipLength (shipType);
-        float shipWidth = renderer->getShipWidth (shipType);
-
-        ships[i] = std::make_unique<Ship> (i, getShipStartPosition (i), getShipStartAngle (i), shipLength, shipWidth, team, shipType);
+            shipTypes[i] = playerShipSelection[playerIdx];
     }
 
-    shells.clear();
-    explosions.clear();
-    winnerIndex = -1;
-    gameOverTimer = 0.0f;
-    gameStartDelay = config.gameStartDelay;
-
-    // Spawn islands
-    islands.clear();
     float arenaW, arenaH;
     getWindowSize (arenaW, arenaH);
+    world->setArenaSize (arenaW, arenaH);
+    world->start (gameMode, shipTypes, makeMatchSeed());
+
+    replayName = makeReplayName();
+    simTick = 0;
+
+    if (config.replayRecord)
+    {
+        ReplayHeader header;
+        header.mode = gameMode;
+        header.seed = world->getMatchSeed();
+        header.shipTypes = shipTypes;
+        header.arenaWidth = arenaW;
+        header.arenaHeight = arenaH;
+        header.physicsRate = config.simPhysicsRate;
+        header.aiRate = config.simAIRate;
+        header.version = HELIGOLAND_VERSION;
+        recorder.begin (header);
+    }
 
-    int numIslands = 1 + rand() % 5; // 1-5 islands
-    for (int i = 0; i < numIslands; ++i)
+    if (config.replayStateStream)
     {
-        bool validPosition = false;
-        Vec2 islandCenter;
-        float islandRadius = config.islandMinRadius + ((float) rand() / RAND_MAX) * (config.islandMaxRadius - config.islandMinRadius);
-
-        int attempts = 0;
-        while (!validPosition && attempts < 50)
-        {
-            attempts++;
-
-            // Random position with margin from edges
-            float margin = islandRadius + config.islandEdgeMargin;
-            islandCenter.x = margin + ((float) rand() / RAND_MAX) * (arenaW - 2 * margin);
-            islandCenter.y = margin + ((float) rand() / RAND_MAX) * (arenaH - 2 * margin);
-
-            validPosition = true;
+        StateStreamHeader header;
+        header.setFromWorld (*world, config.simPhysicsRate);
+        header.keyframeInterval = (uint32_t) std::max (1.0f, config.replayKeyframeInterval * config.simPhysicsRate);
 
-            // Check against ship starting positions
-            for (int s = 0; s < numShips; ++s)
-            {
-                Vec2 shipStart = getShipStartPosition (s);
-                float minDist = islandRadius + config.islandShipClearance;
-
-                if ((shipStart - islandCenter).length() < minDist)
-                {
-                    validPosition = false;
-                    break;
-                }
-            }
-
-            // Check against other islands
-            for (const auto& other : islands)
-            {
-                float minDist = islandRadius + other.getBoundingRadius() + config.islandIslandClearance;
+        stateWriter = std::make_unique<StateStreamWriter>();
+        if (! stateWriter->open (getReplayPath (StateStream::fileExtension), header))
+            stateWriter.reset();
+    }
 
-                if ((other.getCenter() - islandCenter).length() < minDist)
-                {
-                    validPosition = false;
-                    break;
-                }
-            }
-        }
+    if (config.replayDataset)
+    {
+        MatchHeader header;
+        header.setFromWorld (*world, config.simPhysicsRate);
 
-        if (validPosition)
-        {
-            unsigned int seed = (unsigned int) (time * 1000 + i * 12345);
-            islands.emplace_back (islandCenter, islandRadius, seed);
-        }
+        datasetWriter = std::make_unique<DatasetWriter>();
+        if (! datasetWriter->open (getReplayPath (Dataset::fileExtension), header))
+            datasetWriter.reset();
     }
 
-    // Initialize wind (minimum strength)
-    float windAngle = ((float) rand() / RAND_MAX) * 2.0f * pi;
-    float windStrength = config.windMinStrength + ((float) rand() / RAND_MAX) * (1.0f - config.windMinStrength);
-    wind = Vec2::fromAngle (windAngle) * windStrength;
-    targetWind = wind;
-    windChangeTimer = config.windChangeInterval;
+    if (config.replayEvents)
+    {
+        MatchHeader header;
+        header.setFromWorld (*world, config.simPhysicsRate);
 
-    // Initialize current
-    float currentAngle = ((float) rand() / RAND_MAX) * 2.0f * pi;
-    float currentStrengthInit = config.currentMinStrength + ((float) rand() / RAND_MAX) * (config.currentMaxStrength - config.currentMinStrength);
-    current = Vec2::fromAngle (currentAngle) * currentStrengthInit;
-    targetCurrent = current;
-    currentChangeTimer = config.currentChangeInterval;
+        eventWriter = std::make_unique<EventLogWriter>();
+        if (! eventWriter->open (getReplayPath (EventLog::fileExtension), header))
+            eventWriter.reset();
+    }
 
+    gameOverTimer = 0.0f;
+    simAccumulator = 0.0f;
     state = GameState::Playing;
 }
 
-void Game::updateWind (float dt)
+bool Game::playReplay (const std::string& path)
 {
-    // Update wind change timer
-    windChangeTimer -= dt;
-    if (windChangeTimer <= 0)
-    {
-        // Pick new target wind - minor adjustment from current wind
-        float currentAngle = std::atan2 (wind.y, wind.x);
-        float angleChange = ((float) rand() / RAND_MAX - 0.5f) * config.windAngleChangeMax * 2.0f;
-        float newAngle = currentAngle + angleChange;
-
-        // Small strength change, minimum strength enforced
-        float currentStrength = wind.length();
-        float strengthChange = ((float) rand() / RAND_MAX - 0.5f) * config.windStrengthChangeMax;
-        float newStrength = std::clamp (currentStrength + strengthChange, config.windMinStrength, 1.0f);
-
-        targetWind = Vec2::fromAngle (newAngle) * newStrength;
-        windChangeTimer = config.windChangeInterval;
-    }
+    if (! replay.load (path))
+        return false;
 
-    // Slowly lerp wind toward target
-    wind.x += (targetWind.x - wind.x) * config.windLerpSpeed * dt;
-    wind.y += (targetWind.y - wind.y) * config.windLerpSpeed * dt;
-}
+    // Same rates, arena and seed as the recording - the AI is simulated live and follows along.
+    // The rates are the replay's own, the config is left as the player set it
+    const ReplayHeader& header = replay.getHeader();
+    world->setAIRate (header.aiRate);
 
-void Game::updateCurrent (float dt)
-{
-    // Update current change timer
-    currentChangeTimer -= dt;
-    if (currentChangeTimer <= 0)
-    {
-        // Pick new target current - minor adjustment from current direction
-        float currentAngle = std::atan2 (current.y, current.x);
-        float angleChange = ((float) rand() / RAND_MAX - 0.5f) * config.windAngleChangeMax * 2.0f;
-        float newAngle = currentAngle + angleChange;
-
-        // Small strength change, minimum strength enforced
-        float currentStrength = current.length();
-        float strengthChange = ((float) rand() / RAND_MAX - 0.5f) * config.windStrengthChangeMax;
-        float newStrength = std::clamp (currentStrength + strengthChange, config.currentMinStrength, config.currentMaxStrength);
-
-        targetCurrent = Vec2::fromAngle (newAngle) * newStrength;
-        currentChangeTimer = config.currentChangeInterval;
-    }
+    gameMode = header.mode;
+    world->setArenaSize (header.arenaWidth, header.arenaHeight);
+    world->start (header.mode, header.shipTypes, header.seed);
 
-    // Slowly lerp current toward target
-    current.x += (targetCurrent.x - current.x) * config.currentLerpSpeed * dt;
-    current.y += (targetCurrent.y - current.y) * config.currentLerpSpeed * dt;
+    playingReplay = true;
+    gameOverTimer = 0.0f;
+    simAccumulator = 0.0f;
+    state = GameState::Playing;
+    return true;
 }
 
 void Game::updatePlaying (float dt)
 {
     float arenaWidth, arenaHeight;
     getWindowSize (arenaWidth, arenaHeight);
+    if (! playingReplay)
+        world->setArenaSize (arenaWidth, arenaHeight);
 
-    // Update start delay
-    if (gameStartDelay > 0)
-    {
-        gameStartDelay -= dt;
-    }
-
-    // Update wind and current
-    updateWind (dt);
-    updateCurrent (dt);
-
-    // Update ships
+    // Gather input for human controlled ships, the rest are left to the AI
+    World::ShipInputs inputs = {};
+    bool anyHumanPlaying = false;
     int numShips = getNumShipsForMode();
     for (int shipIdx = 0; shipIdx < numShips; ++shipIdx)
     {
-        if (! ships[shipIdx] || ! ships[shipIdx]->isVisible())
-            continue; // Skip dead ships
+        int playerIdx = getPlayerIndexForShip (shipIdx);
+        if (playingReplay || playerIdx < 0 || ! players[playerIdx]->isConnected())
+            continue;
 
-        Vec2 moveInput, aimInput;
-        bool fireInput = false;
+        const Player& player = *players[playerIdx];
+        ShipInput& input = inputs[shipIdx];
+        input.human = true;
+        anyHumanPlaying = true;
+        input.move = player.getMoveInput();
+        input.aim = player.getAimInput();
+        input.fire = player.getFireInput();
+        input.hasCrosshair = player.isUsingMouse();
+        input.crosshair = player.getMousePosition();
+
+        // Simulate at the precision replays store, so playback matches exactly
+        Replay::quantise (input);
+    }
 
-        // Check if this ship is controlled by a human player
-        int playerIdx = getPlayerIndexForShip (shipIdx);
-        bool isHumanControlled = (playerIdx >= 0 && players[playerIdx]->isConnected());
+    updateTimeScale (anyHumanPlaying);
+
+    // Run the simulation in fixed steps so its cost and behaviour don't depend on the display
+    // rate. Time scales just change how many steps run per frame, so gameplay is identical
+    float stepTime = getSimStepTime();
+    simAccumulator += dt * activeTimeScale;
+
+    while (simAccumulator >= stepTime)
+    {
+        simAccumulator -= stepTime;
 
-        if (isHumanControlled)
+        if (playingReplay)
         {
-            moveInput = players[playerIdx]->getMoveInput();
-            aimInput = players[playerIdx]->getAimInput();
-            // Only accept fire input after start delay
-            fireInput = (gameStartDelay <= 0) && players[playerIdx]->getFireInput();
+            // Replay ran out before the match finished (it was abandoned part way through)
+            if (! replay.nextTick (inputs, arenaWidth, arenaHeight))
+            {
+                returnToTitle();
+                return;
+            }
+            world->setArenaSize (arenaWidth, arenaHeight);
         }
         else
         {
-            // Find all living enemy ships for AI
-            std::vector<const Ship*> enemies;
-            std::vector<const Ship*> friendlies;
-            for (int j = 0; j < numShips; ++j)
-            {
-                if (j == shipIdx || !ships[j] || !ships[j]->isAlive())
-                    continue;
-                if (areEnemies (shipIdx, j))
-                    enemies.push_back (ships[j].get());
-                else
-                    friendlies.push_back (ships[j].get());
-            }
-
-            aiControllers[shipIdx]->update (dt, *ships[shipIdx], enemies, friendlies, shells, islands, arenaWidth, arenaHeight);
-            moveInput = aiControllers[shipIdx]->getMoveInput();
-            aimInput = aiControllers[shipIdx]->getAimInput();
-            fireInput = aiControllers[shipIdx]->getFireInput();
+            recorder.recordTick (inputs, world->getArenaWidth(), world->getArenaHeight());
         }
 
-        ships[shipIdx]->update (dt, moveInput, aimInput, fireInput, arenaWidth, arenaHeight, wind, current);
+        world->update (stepTime, inputs);
+        playWorldEvents();
 
-        // Set crosshair directly for mouse aiming
-        if (isHumanControlled && players[playerIdx]->isUsingMouse())
-            ships[shipIdx]->setCrosshairPosition (players[playerIdx]->getMousePosition());
+        simTick++;
+        if (stateWriter)
+            stateWriter->addFrame (*world, simTick);
+        if (datasetWriter)
+            datasetWriter->addFrame (*world, simTick);
+        if (eventWriter)
+            eventWriter->addEvents (*world, simTick);
 
-        // Collect pending shells from ship
-        auto& pendingShells = ships[shipIdx]->getPendingShells();
-        if (! pendingShells.empty() && audio)
+        if (world->isOver())
         {
-            // Play cannon sound at ship position
-            audio->playCannon (ships[shipIdx]->getPosition().x, arenaWidth);
+            if (! playingReplay)
+                recordWin();
+            finishRecording (true);
+            gameOverTimer = 0.0f;
+            state = GameState::GameOver;
+            break;
         }
-
-        for (auto& shell : pendingShells)
-            shells.push_back (std::move (shell));
-
-        pendingShells.clear();
     }
 
     // Update engine volume based on average throttle of alive ships
     if (audio)
     {
+        const auto& ships = world->getShips();
         float totalThrottle = 0.0f;
         int aliveCount = 0;
         for (int i = 0; i < numShips; ++i)
@@ -607,443 +588,201 @@ void Game::updatePlaying (float dt)
         float avgThrottle = aliveCount > 0 ? totalThrottle / aliveCount : 0.0f;
         audio->setEngineVolume (config.audioEngineBaseVolume + avgThrottle * config.audioEngineThrottleBoost);
     }
+}
 
-    // Update shells
-    updateShells (dt);
+float Game::getSimStepTime() const
+{
+    if (playingReplay)
+        return replay.getHeader().getStepTime();
 
-    // Check for collisions
-    checkCollisions();
+    return 1.0f / std::max (1.0f, config.simPhysicsRate);
+}
 
-    // Update explosions
-    for (auto& explosion : explosions)
-    {
-        explosion.timer += dt;
-    }
-    explosions.erase (
-        std::remove_if (explosions.begin(), explosions.end(), [] (const Explosion& e)
-                        { return ! e.isAlive(); }),
-        explosions.end());
+void Game::updateTimeScale (bool anyHumanPlaying)
+{
+    // Halve or double with - and =
+    if (IsKeyPressed (KEY_MINUS))
+        timeScale = std::max (minTimeScale, timeScale * 0.5f);
+    if (IsKeyPressed (KEY_EQUAL))
+        timeScale = std::min (maxTimeScale, timeScale * 2.0f);
+
+    // Anyone actually playing gets real time
+    activeTimeScale = anyHumanPlaying ? 1.0f : timeScale;
 
-    // Check for game over
-    checkGameOver();
+    // Nobody can follow the effects at high speed, so save the work
+    world->setCosmeticsEnabled (activeTimeScale <= config.simCosmeticsMaxTimeScale);
 }
 
-void Game::updateGameOver (float dt)
+void Game::playWorldEvents()
 {
-    float arenaWidth, arenaHeight;
-    getWindowSize (arenaWidth, arenaHeight);
-
-    // Keep updating ships (for smoke effects)
-    int numShips = getNumShipsForMode();
-    for (int i = 0; i < numShips; ++i)
-        if (ships[i] && ships[i]->isVisible())
-            ships[i]->update (dt, { 0, 0 }, { 0, 0 }, false, arenaWidth, arenaHeight, wind, current);
+    if (! audio || ! world->areCosmeticsEnabled())
+        return;
 
-    // Keep updating shells so they land and disappear
-    updateShells (dt);
+    AllocTracker::Scope scope (AllocTracker::Tag::Audio);
+    float arenaWidth = world->getArenaWidth();
 
-    // Kill landed shells and spawn splashes (normally done in checkCollisions)
-    for (auto& shell : shells)
+    for (const auto& event : world->getEvents())
     {
-        if (shell.isAlive() && shell.hasLanded())
+        switch (event.type)
         {
-            Explosion splash;
-            splash.position = shell.getPosition();
-            splash.isHit = false;
-            splash.duration = config.explosionDuration;
-            splash.maxRadius = config.explosionMaxRadius;
-            explosions.push_back (splash);
-            shell.kill();
+            case WorldEvent::Type::Fire:
+                audio->playCannon (event.position.x, arenaWidth);
+                break;
+            case WorldEvent::Type::Hit:
+                audio->playExplosion (event.position.x, arenaWidth);
+                break;
+            case WorldEvent::Type::Splash:
+                audio->playSplash (event.position.x, arenaWidth);
+                break;
+            case WorldEvent::Type::Collision:
+                if (event.magnitude > config.audioMinImpactForSound)
+                    audio->playCollision (event.position.x, arenaWidth);
+                break;
+            case WorldEvent::Type::Grounding:
+            case WorldEvent::Type::Sink:
+            case WorldEvent::Type::MatchEnd:
+                break;
         }
     }
+}
 
-    // Keep updating explosions
-    for (auto& explosion : explosions)
+void Game::recordWin()
+{
+    int winnerIndex = world->getWinnerIndex();
+    if (winnerIndex < 0)
+        return;
+
+    if (gameMode == GameMode::Teams || gameMode == GameMode::Battle)
+        teamWins[winnerIndex]++;
+    else
+        playerWins[winnerIndex]++;
+}
+
+void Game::finishRecording (bool completed)
+{
+    if (stateWriter)
     {
-        explosion.timer += dt;
+        stateWriter->close();
+        stateWriter.reset();
+        pruneReplays (StateStream::fileExtension);
     }
-    explosions.erase (
-        std::remove_if (explosions.begin(), explosions.end(), [] (const Explosion& e)
-                        { return ! e.isAlive(); }),
-        explosions.end());
 
-    gameOverTimer += dt;
-    if (gameOverTimer >= config.gameOverReturnDelay)
+    if (datasetWriter)
     {
-        returnToTitle();
+        datasetWriter->close();
+        datasetWriter.reset();
+        pruneReplays (Dataset::fileExtension);
     }
-}
 
-void Game::returnToTitle()
-{
-    // Clear ships
-    for (auto& ship : ships)
+    if (eventWriter)
     {
-        ship.reset();
+        eventWriter->close();
+        eventWriter.reset();
+        pruneReplays (EventLog::fileExtension);
     }
-    shells.clear();
-    explosions.clear();
 
-    // Reset ready-up state
-    playerLockedIn = {};
-    lockInCountdown = -1.0f;
+    if (! recorder.isRecording())
+        return;
 
-    state = GameState::Title;
+    recorder.finish (completed ? world->getWinnerIndex() : -1, completed);
+    saveReplay();
 }
 
-void Game::updateShells (float dt)
+void Game::saveReplay()
 {
-    // Calculate wind drift force based on shell speed and max wind drift
-    float shellSpeed = config.shipMaxSpeed * config.shellSpeedMultiplier;
-    Vec2 windDrift = wind * shellSpeed * config.windMaxDrift;
-
-    for (auto& shell : shells)
-    {
-        shell.update (dt, windDrift);
-
-        // Check if shell hits an island (only while in flight, not after landing)
-        if (shell.isAlive() && !shell.hasLanded())
-        {
-            for (const auto& island : islands)
-            {
-                if (island.containsPoint (shell.getPosition()))
-                {
-                    shell.kill();
-                    break;
-                }
-            }
-        }
-    }
+    std::string path = getReplayPath (Replay::fileExtension);
+    if (path.empty())
+        return;
 
-    // Remove dead shells
-    shells.erase (
-        std::remove_if (shells.begin(), shells.end(), [] (const Shell& s)
-                        { return ! s.isAlive(); }),
-        shells.end());
+    recorder.save (path);
+    pruneReplays (Replay::fileExtension);
 }
 
-void Game::checkCollisions()
+std::string Game::getReplayPath (const char* extension) const
 {
-    // Shell-to-ship collisions (only when shell has landed/splashed)
-    for (auto& shell : shells)
-    {
-        if (! shell.isAlive())
-            continue;
-        if (! shell.hasLanded())
-            continue; // Shells only hit when they land
-
-        for (auto& ship : ships)
-        {
-            if (! ship || ! ship->isVisible())
-                continue;
-            if (ship->getPlayerIndex() == shell.getOwnerIndex())
-                continue; // Don't hit own ship
-
-            // First do a quick bounding check, then pixel-perfect if within bounds
-            Vec2 diff = shell.getPosition() - ship->getPosition();
-            float dist = diff.length();
-            float boundingRadius = ship->getLength() / 2.0f + shell.getSplashRadius();
-
-            if (dist < boundingRadius && renderer->checkShipHit (*ship, shell.getPosition()))
-            {
-                float arenaWidth, arenaHeight;
-                getWindowSize (arenaWidth, arenaHeight);
-
-                ship->takeDamage (shell.getDamage(), shell.getPosition());
-
-                // Track damage dealt by the shooter
-                int ownerIdx = shell.getOwnerIndex();
-                if (ownerIdx >= 0 && ownerIdx < MAX_SHIPS && ships[ownerIdx])
-                    ships[ownerIdx]->addDamageDealt (shell.getDamage());
-
-                // Spawn hit explosion
-                Explosion explosion;
-                explosion.position = shell.getPosition();
-                explosion.isHit = true;
-                explosion.duration = config.explosionDuration;
-                explosion.maxRadius = config.explosionMaxRadius;
-                explosions.push_back (explosion);
-
-                // Play explosion sound
-                if (audio)
-                    audio->playExplosion (shell.getPosition().x, arenaWidth);
-
-                // Check if ship was sunk
-                if (! ship->isAlive())
-                {
-                    // Big explosion for sinking
-                    Explosion sinkExplosion;
-                    sinkExplosion.position = ship->getPosition();
-                    sinkExplosion.isHit = true;
-                    sinkExplosion.maxRadius = config.sinkExplosionMaxRadius;
-                    sinkExplosion.duration = config.sinkExplosionDuration;
-                    explosions.push_back (sinkExplosion);
-                }
-
-                shell.kill();
-                break;
-            }
-        }
-
-        // Kill landed shells after checking for hits (they splash and disappear)
-        if (shell.hasLanded() && shell.isAlive())
-        {
-            float arenaWidth, arenaHeight;
-            getWindowSize (arenaWidth, arenaHeight);
-
-            // Spawn splash (miss) - hits are handled above
-            Explosion splash;
-            splash.position = shell.getPosition();
-            splash.isHit = false;
-            splash.duration = config.explosionDuration;
-            splash.maxRadius = config.explosionMaxRadius;
-            explosions.push_back (splash);
-
-            // Play splash sound
-            if (audio)
-            {
-                audio->playSplash (shell.getPosition().x, arenaWidth);
-            }
-
-            shell.kill();
-        }
-    }
-
-    // Ship-to-ship collisions using OBB (Separating Axis Theorem)
-    int numShips = getNumShipsForMode();
-    for (int i = 0; i < numShips; ++i)
-    {
-        if (! ships[i] || ! ships[i]->isVisible())
-            continue;
-
-        for (int j = i + 1; j < numShips; ++j)
-        {
-            if (! ships[j] || ! ships[j]->isVisible())
-                continue;
+    namespace fs = std::filesystem;
 
-            // Get corners of both ships
-            auto cornersA = ships[i]->getCorners();
-            auto cornersB = ships[j]->getCorners();
+    std::string userData = Platform::getUserDataDirectory();
+    if (userData.empty())
+        return "";
 
-            // Check if OBBs overlap using SAT
-            float minOverlap = 999999.0f;
-            Vec2 minAxis;
+    std::error_code ec;
+    fs::path dir = fs::path (userData) / "replays";
+    fs::create_directories (dir, ec);
+    if (ec)
+        return "";
 
-            bool separated = false;
-
-            // Test 4 axes (2 from each rectangle - perpendicular to edges)
-            Vec2 axes[4] = {
-                (cornersA[1] - cornersA[0]).normalized(), // Ship A forward axis
-                (cornersA[3] - cornersA[0]).normalized(), // Ship A side axis
-                (cornersB[1] - cornersB[0]).normalized(), // Ship B forward axis
-                (cornersB[3] - cornersB[0]).normalized() // Ship B side axis
-            };
-
-            for (int a = 0; a < 4 && ! separated; ++a)
-            {
-                Vec2 axis = axes[a];
-                // Get perpendicular for proper separation axis
-                Vec2 perpAxis = { -axis.y, axis.x };
+    return (dir / (replayName + extension)).string();
+}
 
-                // Project both shapes onto axis
-                float minA = 999999.0f, maxA = -999999.0f;
-                float minB = 999999.0f, maxB = -999999.0f;
+void Game::pruneReplays (const char* extension) const
+{
+    namespace fs = std::filesystem;
 
-                for (int c = 0; c < 4; ++c)
-                {
-                    float projA = cornersA[c].dot (perpAxis);
-                    float projB = cornersB[c].dot (perpAxis);
-                    minA = std::min (minA, projA);
-                    maxA = std::max (maxA, projA);
-                    minB = std::min (minB, projB);
-                    maxB = std::max (maxB, projB);
-                }
+    std::string userData = Platform::getUserDataDirectory();
+    if (userData.empty() || config.replayKeepCount <= 0)
+        return;
 
-                // Check for separation
-                if (maxA < minB || maxB < minA)
-                {
-                    separated = true;
-                }
-                else
-                {
-                    // Calculate overlap on this axis
-                    float overlap = std::min (maxA - minB, maxB - minA);
-                    if (overlap < minOverlap)
-                    {
-                        minOverlap = overlap;
-                        minAxis = perpAxis;
-                    }
-                }
-            }
+    std::error_code ec;
+    std::vector<fs::path> replays;
+    for (const auto& entry : fs::directory_iterator (fs::path (userData) / "replays", ec))
+        if (entry.is_regular_file() && entry.path().extension() == extension)
+            replays.push_back (entry.path());
 
-            if (! separated)
-            {
-                // OBB overlap detected - now do pixel-perfect check
-                Vec2 collisionPoint;
-                if (!renderer->checkShipCollision (*ships[i], *ships[j], collisionPoint))
-                    continue; // No actual pixel overlap
-
-                // Collision detected!
-                Vec2 velA = ships[i]->getVelocity();
-                Vec2 velB = ships[j]->getVelocity();
-
-                // Calculate relative speed for damage
-                Vec2 relVel = velA - velB;
-                float impactSpeed = relVel.length();
-
-                // Damage proportional to impact speed
-                float damage = impactSpeed * config.collisionDamageScale;
-                ships[i]->takeDamage (damage);
-                ships[j]->takeDamage (damage);
-
-                // Play collision sound at collision point
-                if (audio && impactSpeed > config.audioMinImpactForSound)
-                {
-                    float arenaWidth, arenaHeight;
-                    getWindowSize (arenaWidth, arenaHeight);
-                    audio->playCollision (collisionPoint.x, arenaWidth);
-                }
+    std::sort (replays.begin(), replays.end());
+    for (size_t i = 0; i + (size_t) config.replayKeepCount < replays.size(); ++i)
+        fs::remove (replays[i], ec);
+}
 
-                // Determine collision normal (from i to j)
-                Vec2 diff = ships[j]->getPosition() - ships[i]->getPosition();
-                if (diff.dot (minAxis) < 0)
-                    minAxis = minAxis * -1.0f;
+void Game::updateGameOver (float dt)
+{
+    float arenaWidth, arenaHeight;
+    getWindowSize (arenaWidth, arenaHeight);
+    world->setArenaSize (arenaWidth, arenaHeight);
 
-                Vec2 collisionNormal = minAxis;
+    // Ships coast, shells land and explosions play out, at the speed the match ran at
+    dt *= activeTimeScale;
+    float stepTime = getSimStepTime();
+    simAccumulator += dt;
 
-                // Push ships apart first
-                float pushDist = minOverlap / 2.0f + 2.0f;
-                ships[i]->applyCollision (collisionNormal * -1.0f, pushDist, velA, velB);
-                ships[j]->applyCollision (collisionNormal, pushDist, velB, velA);
-            }
-        }
+    while (simAccumulator >= stepTime)
+    {
+        simAccumulator -= stepTime;
+        world->updateAftermath (stepTime);
     }
 
-    // Ship-to-island collisions
-    for (int i = 0; i < numShips; ++i)
+    gameOverTimer += dt;
+    if (gameOverTimer >= config.gameOverReturnDelay)
     {
-        if (!ships[i] || !ships[i]->isVisible())
-            continue;
-
-        auto corners = ships[i]->getCorners();
-
-        for (const auto& island : islands)
-        {
-            // Quick bounding circle check first
-            Vec2 shipPos = ships[i]->getPosition();
-            float maxShipRadius = ships[i]->getLength() / 2.0f;
-
-            if ((shipPos - island.getCenter()).length() > island.getBoundingRadius() + maxShipRadius)
-                continue;
-
-            // Check each corner of the ship
-            for (const auto& corner : corners)
-            {
-                Vec2 pushDir;
-                float pushDist;
-
-                if (island.getCollisionResponse (corner, pushDir, pushDist))
-                {
-                    // Apply collision response (island is stationary)
-                    Vec2 shipVel = ships[i]->getVelocity();
-                    ships[i]->applyCollision (pushDir, pushDist, shipVel, Vec2 (0, 0));
-
-                    // Apply some damage based on impact speed
-                    float impactSpeed = std::abs (shipVel.dot (pushDir));
-                    if (impactSpeed > 2.0f)
-                    {
-                        float damage = impactSpeed * config.collisionDamageScale * 0.5f;
-                        ships[i]->takeDamage (damage);
-                    }
-
-                    break; // Only handle one corner collision per frame
-                }
-            }
-        }
+        returnToTitle();
     }
 }
 
-void Game::checkGameOver()
+void Game::returnToTitle()
 {
-    // Helper to check if a ship can still fight (alive and not sinking)
-    auto canFight = [this] (int i) -> bool
-    {
-        return ships[i] && ships[i]->isAlive() && ! ships[i]->isSinking();
-    };
-
-    if (gameMode == GameMode::Teams || gameMode == GameMode::Battle)
-    {
-        // Count fighting ships per team
-        int team0Alive = 0;
-        int team1Alive = 0;
-        int numShips = getNumShipsForMode();
-
-        for (int i = 0; i < numShips; ++i)
-        {
-            if (canFight (i))
-            {
-                if (getTeam (i) == 0)
-                    team0Alive++;
-                else
-                    team1Alive++;
-            }
-        }
-
-        // Game ends when one team is eliminated
-        if (team0Alive == 0 || team1Alive == 0)
-        {
-            if (team0Alive == 0 && team1Alive == 0)
-                winnerIndex = -1;  // Draw
-            else if (team0Alive > 0)
-                winnerIndex = 0;   // Team 1 wins (index 0)
-            else
-                winnerIndex = 1;   // Team 2 wins (index 1)
-
-            // Record the win
-            if (winnerIndex >= 0)
-                teamWins[winnerIndex]++;
+    finishRecording (false);
+    playingReplay = false;
+    world->clear();
+    world->setCosmeticsEnabled (true);
+    world->setAIRate (0.0f);
+    activeTimeScale = 1.0f;
 
-            gameOverTimer = 0.0f;
-            state = GameState::GameOver;
-        }
-    }
-    else
-    {
-        // FFA and Duel modes - last ship standing wins
-        int aliveCount = 0;
-        int lastAlive = -1;
-        int numShips = getNumShipsForMode();
-
-        for (int i = 0; i < numShips; ++i)
-        {
-            if (canFight (i))
-            {
-                aliveCount++;
-                lastAlive = i;
-            }
-        }
-
-        if (aliveCount <= 1)
-        {
-            winnerIndex = lastAlive;
-
-            // Record the win
-            if (winnerIndex >= 0)
-                playerWins[winnerIndex]++;
+    // Reset ready-up state
+    playerLockedIn = {};
+    lockInCountdown = -1.0f;
 
-            gameOverTimer = 0.0f;
-            state = GameState::GameOver;
-        }
-    }
+    state = GameState::Title;
 }
 
 void Game::render()
 {
+    AllocTracker::Scope scope (AllocTracker::Tag::Rendering);
     BeginDrawing();
 
     float w, h;
     getWindowSize (w, h);
     renderer->drawWater (time, w, h);
+    renderer->setInterpolation (state == GameState::Title ? 1.0f : simAccumulator / getSimStepTime());
 
     switch (state)
     {
@@ -1059,6 +798,9 @@ void Game::render()
             break;
     }
 
+    if (showAllocations)
+        renderAllocations();
+
     renderer->present();
 
     EndDrawing();
@@ -1066,6 +808,7 @@ void Game::render()
 
 void Game::renderTitle()
 {
+    AllocTracker::Scope scope (AllocTracker::Tag::Interface);
     float w, h;
     getWindowSize (w, h);
 
@@ -1082,11 +825,12 @@ void Game::renderTitle()
         }
     }
 
-    std::string playerText = std::to_string (connectedCount) + " PLAYERS CONNECTED";
+    char playerText[32];
+    snprintf (playerText, sizeof (playerText), "%d PLAYERS CONNECTED", connectedCount);
     renderer->drawTextCentered (playerText, { w / 2.0f, h * 0.27f }, 3.0f, config.colorSubtitle);
 
     // Draw game mode selector
-    std::string modeText;
+    const char* modeText;
     if (gameMode == GameMode::FFA)
         modeText = "FREE FOR ALL";
     else if (gameMode == GameMode::Teams)
@@ -1130,8 +874,10 @@ void Game::renderTitle()
         if (players[i]->isConnected())
         {
             renderer->drawShipPreview (playerShipSelection[i], slotPos, -pi / 4.0f, i);
-            renderer->drawTextCentered ("P" + std::to_string (i + 1), { slotPos.x, slotPos.y + 50.0f }, 2.0f, slotColor);
-            std::string shipName = config.shipTypes[playerShipSelection[i]].name;
+            char label[16];
+            snprintf (label, sizeof (label), "P%d", i + 1);
+            renderer->drawTextCentered (label, { slotPos.x, slotPos.y + 50.0f }, 2.0f, slotColor);
+            const std::string& shipName = config.shipTypes[playerShipSelection[i]].name;
             renderer->drawTextCentered (shipName, { slotPos.x, slotPos.y + 70.0f }, 1.5f, config.colorGreyLight);
 
             // Show ready status
@@ -1142,7 +888,7 @@ void Game::renderTitle()
         {
             renderer->drawShipPreview (aiShipSelection[i], slotPos, -pi / 4.0f, i);
             renderer->drawTextCentered ("AI", { slotPos.x, slotPos.y + 50.0f }, 2.0f, config.colorGreyDark);
-            std::string shipName = config.shipTypes[aiShipSelection[i]].name;
+            const std::string& shipName = config.shipTypes[aiShipSelection[i]].name;
             renderer->drawTextCentered (shipName, { slotPos.x, slotPos.y + 70.0f }, 1.5f, config.colorGreyLight);
         }
     };
@@ -1203,7 +949,8 @@ void Game::renderTitle()
     // Draw volume control
     if (audio)
     {
-        std::string volumeText = "VOLUME: " + std::to_string (audio->getMasterVolumeLevel());
+        char volumeText[32];
+        snprintf (volumeText, sizeof (volumeText), "VOLUME: %d", audio->getMasterVolumeLevel());
         renderer->drawTextCentered (volumeText, { w / 2.0f, h * 0.88f }, 2.0f, config.colorSubtitle);
     }
 
@@ -1211,7 +958,8 @@ void Game::renderTitle()
     if (lockInCountdown > 0.0f)
     {
         int seconds = (int) std::ceil (lockInCountdown);
-        std::string countdownText = "STARTING IN " + std::to_string (seconds) + "...";
+        char countdownText[32];
+        snprintf (countdownText, sizeof (countdownText), "STARTING IN %d...", seconds);
         renderer->drawTextCentered (countdownText, { w / 2.0f, h * 0.95f }, 3.0f, config.colorModeText);
     }
     else
@@ -1225,14 +973,14 @@ void Game::renderPlaying()
     float w, h;
     getWindowSize (w, h);
 
+    const auto& ships = world->getShips();
+
     // Draw islands (behind everything)
-    for (const auto& island : islands)
+    for (const auto& island : world->getIslands())
         renderer->drawIsland (island);
 
     // Draw bubble trails (behind ships)
-    for (const auto& ship : ships)
-        if (ship && ship->isVisible())
-            renderer->drawBubbleTrail (*ship);
+    renderer->drawBubbles (world->getParticles());
 
     // Draw ships
     for (const auto& ship : ships)
@@ -1240,17 +988,14 @@ void Game::renderPlaying()
             renderer->drawShip (*ship);
 
     // Draw smoke (above ships)
-    for (const auto& ship : ships)
-        if (ship && ship->isVisible())
-            renderer->drawSmoke (*ship);
+    renderer->drawSmoke (world->getParticles(), world->getFleet());
 
     // Draw shells (on top of ships)
-    for (const auto& shell : shells)
+    for (const auto& shell : world->getShells())
         renderer->drawShell (shell);
 
     // Draw explosions
-    for (const auto& explosion : explosions)
-        renderer->drawExplosion (explosion);
+    renderer->drawExplosions (world->getParticles());
 
     // Draw crosshairs (on top of everything)
     for (const auto& ship : ships)
@@ -1258,6 +1003,7 @@ void Game::renderPlaying()
             renderer->drawCrosshair (*ship);
 
     // Draw HUD for all ships
+    AllocTracker::Scope scope (AllocTracker::Tag::Interface);
     int numShips = getNumShipsForMode();
 
     // Calculate HUD width based on available space (reserve 80px for wind indicator on right)
@@ -1307,10 +1053,10 @@ void Game::renderPlaying()
     }
 
     // Draw wind indicator (bottom-left)
-    renderer->drawWindIndicator (wind, w, h);
+    renderer->drawWindIndicator (world->getWind(), w, h);
 
     // Draw current indicator (bottom-right)
-    renderer->drawCurrentIndicator (current, w, h);
+    renderer->drawCurrentIndicator (world->getCurrent(), w, h);
 
     // Draw team ship counters for Battle mode
     if (gameMode == GameMode::Battle)
@@ -1321,24 +1067,34 @@ void Game::renderPlaying()
         {
             if (ships[i] && ships[i]->isAlive() && ! ships[i]->isSinking())
             {
-                if (getTeam (i) == 0)
+                if (world->getTeam (i) == 0)
                     team1Alive++;
                 else
                     team2Alive++;
             }
         }
 
-        std::string team1Text = std::to_string (team1Alive);
-        std::string team2Text = std::to_string (team2Alive);
+        char team1Text[16], team2Text[16];
+        snprintf (team1Text, sizeof (team1Text), "%d", team1Alive);
+        snprintf (team2Text, sizeof (team2Text), "%d", team2Alive);
 
         // Draw on left and right sides of screen
         renderer->drawTextCentered (team1Text, { 50.0f, h / 2.0f }, 6.0f, config.colorTeam1);
         renderer->drawTextCentered (team2Text, { w - 50.0f, h / 2.0f }, 6.0f, config.colorTeam2);
     }
+
+    // Show the speed when it isn't real time
+    if (activeTimeScale != 1.0f)
+    {
+        char scaleText[16];
+        snprintf (scaleText, sizeof (scaleText), "%gX", activeTimeScale);
+        renderer->drawTextCentered (scaleText, { w / 2.0f, h - 30.0f }, 2.5f, config.colorSubtitle);
+    }
 }
 
 void Game::renderGameOver()
 {
+    AllocTracker::Scope scope (AllocTracker::Tag::Interface);
     // Wait before showing text so player can see the final explosion
     if (gameOverTimer < config.gameOverTextDelay)
         return;
@@ -1346,16 +1102,17 @@ void Game::renderGameOver()
     float w, h;
     getWindowSize (w, h);
 
+    const auto& ships = world->getShips();
+    int winnerIndex = world->getWinnerIndex();
+
     Color textColor = config.colorWhite;
     Color statsColor = config.colorSubtitle;
 
     if (winnerIndex >= 0)
     {
-        std::string winText;
-        if (gameMode == GameMode::Teams || gameMode == GameMode::Battle)
-            winText = "TEAM " + std::to_string (winnerIndex + 1) + " WINS!";
-        else
-            winText = "PLAYER " + std::to_string (winnerIndex + 1) + " WINS!";
+        bool isTeamMode = (gameMode == GameMode::Teams || gameMode == GameMode::Battle);
+        char winText[32];
+        snprintf (winText, sizeof (winText), "%s %d WINS!", isTeamMode ? "TEAM" : "PLAYER", winnerIndex + 1);
 
         renderer->drawTextCentered (winText, { w / 2.0f, h / 2.0f - 30.0f }, 5.0f, textColor);
     }
@@ -1365,159 +1122,64 @@ void Game::renderGameOver()
     }
 
     // Display win statistics
+    char statsText[64];
     if (gameMode == GameMode::Teams || gameMode == GameMode::Battle)
-    {
-        std::string statsText = "TEAM 1: " + std::to_string (teamWins[0]) +
-                                "  -  TEAM 2: " + std::to_string (teamWins[1]);
-        renderer->drawTextCentered (statsText, { w / 2.0f, h / 2.0f + 40.0f }, 2.5f, statsColor);
-    }
+        snprintf (statsText, sizeof (statsText), "TEAM 1: %d  -  TEAM 2: %d", teamWins[0], teamWins[1]);
     else if (gameMode == GameMode::Duel)
-    {
-        std::string statsText = "P1: " + std::to_string (playerWins[0]) +
-                                "  -  P2: " + std::to_string (playerWins[1]);
-        renderer->drawTextCentered (statsText, { w / 2.0f, h / 2.0f + 40.0f }, 2.5f, statsColor);
-    }
+        snprintf (statsText, sizeof (statsText), "P1: %d  -  P2: %d", playerWins[0], playerWins[1]);
     else if (gameMode == GameMode::Triple)
-    {
-        std::string statsText = "P1: " + std::to_string (playerWins[0]) +
-                                "  P2: " + std::to_string (playerWins[1]) +
-                                "  P3: " + std::to_string (playerWins[2]);
-        renderer->drawTextCentered (statsText, { w / 2.0f, h / 2.0f + 40.0f }, 2.5f, statsColor);
-    }
+        snprintf (statsText, sizeof (statsText), "P1: %d  P2: %d  P3: %d", playerWins[0], playerWins[1], playerWins[2]);
     else
-    {
-        std::string statsText = "P1: " + std::to_string (playerWins[0]) +
-                                "  P2: " + std::to_string (playerWins[1]) +
-                                "  P3: " + std::to_string (playerWins[2]) +
-                                "  P4: " + std::to_string (playerWins[3]);
-        renderer->drawTextCentered (statsText, { w / 2.0f, h / 2.0f + 40.0f }, 2.5f, statsColor);
-    }
+        snprintf (statsText, sizeof (statsText), "P1: %d  P2: %d  P3: %d  P4: %d", playerWins[0], playerWins[1], playerWins[2], playerWins[3]);
+    renderer->drawTextCentered (statsText, { w / 2.0f, h / 2.0f + 40.0f }, 2.5f, statsColor);
 
     // Display damage dealt by each ship, sorted from most to least
     int numShips = getNumShipsForMode();
     float damageY = h / 2.0f + 80.0f;
-    std::string damageHeader = "DAMAGE DEALT";
-    renderer->drawTextCentered (damageHeader, { w / 2.0f, damageY }, 2.5f, statsColor);
+    renderer->drawTextCentered ("DAMAGE DEALT", { w / 2.0f, damageY }, 2.5f, statsColor);
 
     // Create sorted list of ship indices by damage dealt
-    std::vector<int> sortedShips;
+    std::array<int, World::MAX_SHIPS> sortedShips;
+    int numSorted = 0;
     for (int i = 0; i < numShips; ++i)
         if (ships[i])
-            sortedShips.push_back (i);
+            sortedShips[numSorted++] = i;
 
-    std::sort (sortedShips.begin(), sortedShips.end(), [this] (int a, int b) {
+    std::sort (sortedShips.begin(), sortedShips.begin() + numSorted, [&ships] (int a, int b) {
         return ships[a]->getDamageDealt() > ships[b]->getDamageDealt();
     });
 
     damageY += 35.0f;
-    for (int idx : sortedShips)
+    for (int n = 0; n < numSorted; ++n)
     {
+        int idx = sortedShips[n];
         int damage = (int) ships[idx]->getDamageDealt();
-        std::string label = "P" + std::to_string (idx + 1) + ": " + std::to_string (damage);
+        char label[32];
+        snprintf (label, sizeof (label), "P%d: %d", idx + 1, damage);
         Color shipColor = ships[idx]->getColor();
         renderer->drawTextCentered (label, { w / 2.0f, damageY }, 2.0f, shipColor);
         damageY += 28.0f;
     }
 }
 
-Vec2 Game::getShipStartPosition (int index) const
-{
-    float w, h;
-    getWindowSize (w, h);
-
-    if (gameMode == GameMode::Duel)
-    {
-        // 1v1 mode: ships on left and right, centered vertically
-        float margin = w * 0.15f;
-        if (index == 0)
-            return { margin, h / 2.0f };
-        else
-            return { w - margin, h / 2.0f };
-    }
-
-    if (gameMode == GameMode::Teams)
-    {
-        // 2v2 mode: teams on left and right sides
-        float margin = w * 0.15f;
-        float verticalSpacing = h * 0.25f;
-
-        if (index < 2)
-        {
-            // Team 0 (players 0, 1) on left
-            float x = margin;
-            float y = h / 2.0f + (index == 0 ? -verticalSpacing : verticalSpacing);
-            return { x, y };
-        }
-        else
-        {
-            // Team 1 (players 2, 3) on right
-            float x = w - margin;
-            float y = h / 2.0f + (index == 2 ? -verticalSpacing : verticalSpacing);
-            return { x, y };
-        }
-    }
-
-    if (gameMode == GameMode::Battle)
-    {
-        // 6v6 mode: 6 ships per team in a single column on each side
-        float margin = w * 0.12f;
-        int shipsPerTeam = 6;
-
-        int team = getTeam (index);
-        int row = (team == 0) ? index : index - shipsPerTeam;
-
-        float verticalSpacing = h / (shipsPerTeam + 1);
-        float y = verticalSpacing + row * verticalSpacing;
-
-        if (team == 0)
-            return { margin, y };
-        else
-            return { w - margin, y };
-    }
-
-    // FFA mode: Place ships equidistant in a circle around the center
-    Vec2 center = { w / 2.0f, h / 2.0f };
-    float radius = std::min (w, h) * 0.35f;
-    int numShips = getNumShipsForMode();
-    float angleOffset = -pi / 2.0f;  // Start from top
-    float angle = angleOffset + (index * 2.0f * pi / numShips);
-    return center + Vec2::fromAngle (angle) * radius;
-}
-
-float Game::getShipStartAngle (int index) const
+void Game::renderAllocations()
 {
-    if (gameMode == GameMode::Duel)
-    {
-        // 1v1 mode: ships face each other
-        if (index == 0)
-            return 0.0f;  // Player 1 faces right
-        else
-            return pi;    // Player 2 faces left
-    }
+    // Heap allocations made during the previous frame, one line per subsystem
+    const auto& counts = lastFrameAllocations;
+    Vec2 position = { 10.0f, 70.0f };
 
-    if (gameMode == GameMode::Teams)
-    {
-        // 2v2 mode: teams face each other
-        if (index < 2)
-            return 0.0f;  // Team 0 faces right
-        else
-            return pi;    // Team 1 faces left
-    }
+    char text[64];
+    snprintf (text, sizeof (text), "ALLOCS %llu  %llu BYTES",
+              (unsigned long long) counts.getTotal(), (unsigned long long) counts.bytes);
+    renderer->drawText (text, position, 2.0f, config.colorSubtitle);
 
-    if (gameMode == GameMode::Battle)
+    for (size_t i = 0; i < counts.allocations.size(); ++i)
     {
-        // 6v6 mode: teams face each other
-        if (getTeam (index) == 0)
-            return 0.0f;  // Team 0 faces right
-        else
-            return pi;    // Team 1 faces left
+        position.y += 20.0f;
+        snprintf (text, sizeof (text), "%s %llu", AllocTracker::getTagName ((AllocTracker::Tag) i),
+                  (unsigned long long) counts.allocations[i]);
+        renderer->drawText (text, position, 2.0f, counts.allocations[i] > 0 ? config.colorModeText : config.colorSubtitle);
     }
-
-    // FFA mode: Point ships toward center from circle position
-    int numShips = getNumShipsForMode();
-    float angleOffset = -pi / 2.0f;
-    float posAngle = angleOffset + (index * 2.0f * pi / numShips);
-    return posAngle + pi;  // Face toward center
 }
 
 void Game::getWindowSize (float& width, float& height) const
@@ -1526,25 +1188,6 @@ void Game::getWindowSize (float& width, float& height) const
     height = (float) GetScreenHeight();
 }
 
-int Game::getTeam (int shipIndex) const
-{
-    if (gameMode == GameMode::Battle)
-    {
-        // Battle mode: ships 0-5 on team 0, ships 6-11 on team 1
-        return shipIndex < 6 ? 0 : 1;
-    }
-    // Teams/other modes: ships 0, 1 on team 0, ships 2, 3 on team 1
-    return shipIndex < 2 ? 0 : 1;
-}
-
-bool Game::areEnemies (int playerA, int playerB) const
-{
-    if (gameMode == GameMode::FFA || gameMode == GameMode::Duel)
-        return playerA != playerB;  // Everyone is an enemy in FFA and Duel
-
-    return getTeam (playerA) != getTeam (playerB);
-}
-
 void Game::cycleGameMode (int direction)
 {
     int mode = static_cast<int> (gameMode);
@@ -1561,50 +1204,10 @@ void Game::cycleGameMode (int direction)
 
 int Game::getNumShipsForMode() const
 {
-    if (gameMode == GameMode::Duel)
-        return 2;
-    if (gameMode == GameMode::Triple)
-        return 3;
-    if (gameMode == GameMode::Battle)
-        return 12;
-    return 4;  // FFA and Teams
-}
-
-int Game::getShipIndexForPlayer (int playerIndex) const
-{
-    if (gameMode == GameMode::Battle)
-    {
-        // In Battle mode:
-        // Player 0 -> Ship 0 (team 1)
-        // Player 1 -> Ship 1 (team 1)
-        // Player 2 -> Ship 6 (team 2)
-        // Player 3 -> Ship 7 (team 2)
-        if (playerIndex < 2)
-            return playerIndex;
-        else
-            return playerIndex + 4;  // 2->6, 3->7
-    }
-    // Other modes: direct mapping
-    return playerIndex;
+    return World::getNumShipsForMode (gameMode);
 }
 
 int Game::getPlayerIndexForShip (int shipIndex) const
 {
-    if (gameMode == GameMode::Battle)
-    {
-        // In Battle mode, only ships 0, 1, 6, 7 can be human-controlled
-        if (shipIndex == 0)
-            return 0;
-        if (shipIndex == 1)
-            return 1;
-        if (shipIndex == 6)
-            return 2;
-        if (shipIndex == 7)
-            return 3;
-        return -1;  // AI controlled
-    }
-    // Other modes: direct mapping (if within player count)
-    if (shipIndex < MAX_PLAYERS)
-        return shipIndex;
-    return -1;
+    return World::getPlayerIndexForShip (gameMode, shipIndex);
 }
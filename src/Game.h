@@ -1,15 +1,20 @@
 #pragma once
 
-#include "AIController.h"
+#include "AllocTracker.h"
 #include "Audio.h"
 #include "Config.h"
-#include "Island.h"
 #include "Player.h"
+#include "Random.h"
 #include "Renderer.h"
-#include "Shell.h"
-#include "Ship.h"
+#include "Replay.h"
+#include "ShipHulls.h"
+#include "Dataset.h"
+#include "EventLog.h"
+#include "StateStream.h"
+#include "World.h"
 #include <array>
 #include <memory>
+#include <string>
 #include <vector>
 
 enum class GameState
@@ -19,27 +24,6 @@ enum class GameState
     GameOver
 };
 
-enum class GameMode
-{
-    FFA,      // Free for all - every ship for themselves
-    Teams,    // 2v2 - ships 0,1 vs ships 2,3
-    Duel,     // 1v1 - ship 0 vs ship 1
-    Triple,   // 1v1v1 - 3 ships
-    Battle    // 6v6 - ships 0-5 vs ships 6-11, up to 2 humans per team
-};
-
-struct Explosion
-{
-    Vec2 position;
-    float timer = 0.0f;
-    float duration = 0.0f;  // Set at creation, defaults applied in Game.cpp
-    float maxRadius = 0.0f; // Set at creation, defaults applied in Game.cpp
-    bool isHit = false; // true = explosion (orange), false = splash (blue)
-
-    float getProgress() const { return timer / duration; }
-    bool isAlive() const { return timer < duration; }
-};
-
 class Game
 {
 public:
@@ -50,30 +34,31 @@ public:
     void run();
     void shutdown();
 
+    // Plays back a recorded match instead of starting on the title screen. Call after init()
+    bool playReplay (const std::string& path);
+
 private:
     static constexpr int WINDOW_WIDTH = 1280;
     static constexpr int WINDOW_HEIGHT = 720;
-    static constexpr int MAX_SHIPS = 12;      // Maximum ships (for Battle mode 6v6)
-    static constexpr int MAX_PLAYERS = 4;     // Maximum human players
+    static constexpr int MAX_SHIPS = World::MAX_SHIPS;
+    static constexpr int MAX_PLAYERS = World::MAX_PLAYERS;
 
+    std::unique_ptr<ShipHulls> hulls;
+    std::unique_ptr<World> world;
     std::unique_ptr<Renderer> renderer;
     std::unique_ptr<Audio> audio;
 
     bool running = false;
     GameState state = GameState::Title;
     GameMode gameMode = GameMode::FFA;
-    int winnerIndex = -1;  // In FFA: player index, in Teams: team index (0 or 1)
     float gameOverTimer = 0.0f;
-    float gameStartDelay = 0.0f; // Delay before accepting fire input after game starts
+    float simAccumulator = 0.0f; // Frame time not yet consumed by fixed simulation steps
+    float timeScale = 1.0f;      // Chosen speed for matches nobody is playing (replays, all AI)
+    float activeTimeScale = 1.0f; // Speed the simulation is actually running at
     float time = 0.0f; // Total elapsed time for animations
     double lastFrameTime = 0.0;
 
-    std::array<std::unique_ptr<Ship>, MAX_SHIPS> ships;
     std::array<std::unique_ptr<Player>, MAX_PLAYERS> players;
-    std::array<std::unique_ptr<AIController>, MAX_SHIPS> aiControllers;
-    std::vector<Shell> shells;
-    std::vector<Explosion> explosions;
-    std::vector<Island> islands;
 
     // Ship selection for each player (0-3 = ship types with 1-4 turrets)
     std::array<int, MAX_PLAYERS> playerShipSelection = { 3, 2, 2, 2 };  // Default to cruiser
@@ -81,31 +66,42 @@ private:
     // AI ship selection (randomly cycles on title screen)
     std::array<int, MAX_PLAYERS> aiShipSelection = {};
     float aiShipChangeTimer = 0.0f;
+    Random titleRandom; // Cosmetic only, seeded from the OS
 
     // Ready-up / lock-in system
     std::array<bool, MAX_PLAYERS> playerLockedIn = {};
     float lockInCountdown = -1.0f;  // Negative = not counting down
 
-    // Wind system
-    Vec2 wind; // Current wind direction and strength (length = strength 0-1)
-    Vec2 targetWind; // Wind is slowly moving toward this target
-    float windChangeTimer = 0.0f;
-
-    // Current system (affects ship movement)
-    Vec2 current; // Current direction and strength (length = strength 0-1)
-    Vec2 targetCurrent; // Current is slowly moving toward this target
-    float currentChangeTimer = 0.0f;
+    // Title screen buttons held last frame, so holding one acts once
+    bool leftWasPressed = false;
+    bool rightWasPressed = false;
+    std::array<bool, MAX_PLAYERS> upWasPressed = {};
+    std::array<bool, MAX_PLAYERS> downWasPressed = {};
+    bool volumeDownWasPressed = false;
+    bool volumeUpWasPressed = false;
 
     // Win tracking
     std::array<int, MAX_PLAYERS> playerWins = {}; // Wins per player in FFA mode
     std::array<int, 2> teamWins = {};             // Wins per team in Teams/Battle mode
 
-    void updateWind (float dt);
-    void updateCurrent (float dt);
+    // Replays
+    ReplayRecorder recorder;
+    ReplayPlayer replay;
+    bool playingReplay = false;   // Inputs come from the replay rather than the players
+    std::unique_ptr<StateStreamWriter> stateWriter;  // Only while recording a state stream
+    std::unique_ptr<DatasetWriter> datasetWriter;    // Only while recording a dataset
+    std::unique_ptr<EventLogWriter> eventWriter;     // Only while logging events
+    std::string replayName;       // File name (without extension) for this match's recordings
+    uint32_t simTick = 0;         // Simulation steps since the match started
+
+    // Allocation overlay (F3), only available in builds with HELIGOLAND_TRACK_ALLOCATIONS
+    bool showAllocations = false;
+    AllocTracker::Counts lastFrameAllocations;
 
     void handleEvents();
     void update (float dt);
     void render();
+    void configChanged (const ConfigChanges& changes);  // Rebuilds what was worked out from the changed values
 
     // Title screen
     void updateTitle (float dt);
@@ -116,22 +112,24 @@ private:
     void startGame();
     void updatePlaying (float dt);
     void renderPlaying();
-    void updateShells (float dt);
-    void checkCollisions();
-    void checkGameOver();
+    float getSimStepTime() const;
+    void updateTimeScale (bool anyHumanPlaying);
+    void playWorldEvents();
+    void recordWin();
+    void finishRecording (bool completed);
+    void saveReplay();
+    std::string getReplayPath (const char* extension) const;
+    void pruneReplays (const char* extension) const;
 
     // Game over
     void updateGameOver (float dt);
     void renderGameOver();
     void returnToTitle();
 
-    Vec2 getShipStartPosition (int index) const;
-    float getShipStartAngle (int index) const;
-    int getTeam (int shipIndex) const;  // Returns 0 or 1 for team mode
-    bool areEnemies (int shipA, int shipB) const;
+    void renderAllocations();
+
     void getWindowSize (float& width, float& height) const;
     void cycleGameMode (int direction);
     int getNumShipsForMode() const;  // Returns number of ships for current game mode
-    int getShipIndexForPlayer (int playerIndex) const;  // Maps player slot to ship index
     int getPlayerIndexForShip (int shipIndex) const;    // Maps ship index to player slot (-1 if AI)
 };
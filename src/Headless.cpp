@@ -0,0 +1,1512 @@
+#include "Headless.h"
+#include "AllocTracker.h"
+#include "Batch.h"
+#include "Dataset.h"
+#include "EventLog.h"
+#include "Farm.h"
+#include "Optimiser.h"
+#include "ParticleKernels.h"
+#include "Replay.h"
+#include "StateStream.h"
+#include "ShipHulls.h"
+#include "StateHash.h"
+#include "Sweep.h"
+#include "VectorEnv.h"
+#include "World.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct HeadlessOptions
+    {
+        int matches = 100;
+        bool hasMatches = false;
+        GameMode mode = GameMode::FFA;
+        bool hasMode = false;
+        uint64_t seed = 0;
+        bool hasSeed = false;
+        float maxMatchTime = 300.0f;  // Seconds of game time before a match is called a draw
+        bool quiet = false;
+        int threads = 0;              // 0 = one per core
+        std::string resultsPath;      // Per-match results (.csv or .json)
+        int farmWorkers = -1;         // Worker processes, 0 = one per core, -1 = run in this process
+        std::string jobsPath;         // Job file for the farm
+        float jobTimeout = 600.0f;    // Seconds before a farm worker is presumed hung
+        std::string configOverrides;  // JSON applied to the config before anything runs
+        bool balance = false;                      // Win rates for every pairing of ship types
+        std::vector<std::string> sweepParameters;  // Config values to vary for the balance report
+        int sweepSamples = 0;                      // Random points rather than the full grid
+        int optimiseGenerations = 0;  // Evolve AI params against the default AI for this many generations
+        int population = 16;          // Optimiser candidates per generation
+        std::string aiParamsPath;     // Params the optimiser starts from
+        int envArenas = 0;            // Benchmark the RL environment with this many arenas
+        int envSteps = 1000;
+        bool updateBench = false;     // Time AI decisions and ship updates
+        std::string replayPath;
+        std::string stateStreamPath;  // Record the first match / run here
+        std::string inspectPath;
+        float inspectTime = 0.0f;
+        std::string datasetPath;         // Record the first match / run's states and actions here
+        std::string inspectDatasetPath;
+        std::string eventLogPath;        // Record the first match / run's gameplay events here
+        std::string eventsCsvPath;       // Event log to print as CSV
+        bool checkDeterminism = false;  // Run twice side by side and compare every tick
+        std::string hashTracePath;      // Save the per-tick state hashes here
+        std::string checkTracePath;     // Compare against a saved trace
+        bool checkSnapshots = false;    // Branch the match from snapshots and check restores are exact
+        bool checkAllocations = false;  // Fail if a tick past the warm-up touches the heap
+        bool checkKernels = false;      // Compare the vector particle kernels with the scalar ones
+    };
+
+    bool parseOptions (int argc, char* argv[], HeadlessOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (strcmp (arg, "--headless") == 0)
+                continue;
+
+            if (strcmp (arg, "--quiet") == 0)
+            {
+                options.quiet = true;
+            }
+            else if ((strcmp (arg, "--matches") == 0 || strcmp (arg, "--batch") == 0) && hasValue)
+            {
+                options.matches = atoi (argv[++i]);
+                options.hasMatches = true;
+            }
+            else if (strcmp (arg, "--mode") == 0 && hasValue)
+            {
+                if (! Batch::parseMode (argv[++i], options.mode))
+                {
+                    fprintf (stderr, "Unknown mode: %s\n", argv[i]);
+                    return false;
+                }
+                options.hasMode = true;
+            }
+            else if (strcmp (arg, "--seed") == 0 && hasValue)
+            {
+                options.seed = strtoull (argv[++i], nullptr, 10);
+                options.hasSeed = true;
+            }
+            else if (strcmp (arg, "--threads") == 0 && hasValue)
+            {
+                options.threads = atoi (argv[++i]);
+            }
+            else if (strcmp (arg, "--results") == 0 && hasValue)
+            {
+                options.resultsPath = argv[++i];
+            }
+            else if (strcmp (arg, "--farm") == 0 && hasValue)
+            {
+                options.farmWorkers = std::max (0, atoi (argv[++i]));
+            }
+            else if (strcmp (arg, "--jobs") == 0 && hasValue)
+            {
+                options.jobsPath = argv[++i];
+            }
+            else if (strcmp (arg, "--job-timeout") == 0 && hasValue)
+            {
+                options.jobTimeout = (float) atof (argv[++i]);
+            }
+            else if (strcmp (arg, "--config") == 0 && hasValue)
+            {
+                options.configOverrides = argv[++i];
+            }
+            else if (strcmp (arg, "--balance") == 0)
+            {
+                options.balance = true;
+            }
+            else if (strcmp (arg, "--sweep") == 0 && hasValue)
+            {
+                options.sweepParameters.push_back (argv[++i]);
+                options.balance = true;
+            }
+            else if (strcmp (arg, "--samples") == 0 && hasValue)
+            {
+                options.sweepSamples = atoi (argv[++i]);
+            }
+            else if (strcmp (arg, "--optimise-ai") == 0 && hasValue)
+            {
+                options.optimiseGenerations = atoi (argv[++i]);
+            }
+            else if (strcmp (arg, "--population") == 0 && hasValue)
+            {
+                options.population = atoi (argv[++i]);
+            }
+            else if (strcmp (arg, "--ai-params") == 0 && hasValue)
+            {
+                options.aiParamsPath = argv[++i];
+            }
+            else if (strcmp (arg, "--env-bench") == 0 && hasValue)
+            {
+                options.envArenas = atoi (argv[++i]);
+            }
+            else if (strcmp (arg, "--update-bench") == 0)
+            {
+                options.updateBench = true;
+            }
+            else if (strcmp (arg, "--env-steps") == 0 && hasValue)
+            {
+                options.envSteps = std::max (1, atoi (argv[++i]));
+            }
+            else if (strcmp (arg, "--max-time") == 0 && hasValue)
+            {
+                options.maxMatchTime = (float) atof (argv[++i]);
+            }
+            else if (strcmp (arg, "--replay") == 0 && hasValue)
+            {
+                options.replayPath = argv[++i];
+            }
+            else if (strcmp (arg, "--state-stream") == 0 && hasValue)
+            {
+                options.stateStreamPath = argv[++i];
+            }
+            else if (strcmp (arg, "--inspect") == 0 && hasValue)
+            {
+                options.inspectPath = argv[++i];
+            }
+            else if (strcmp (arg, "--dataset") == 0 && hasValue)
+            {
+                options.datasetPath = argv[++i];
+            }
+            else if (strcmp (arg, "--inspect-dataset") == 0 && hasValue)
+            {
+                options.inspectDatasetPath = argv[++i];
+            }
+            else if (strcmp (arg, "--events") == 0 && hasValue)
+            {
+                options.eventLogPath = argv[++i];
+            }
+            else if (strcmp (arg, "--events-csv") == 0 && hasValue)
+            {
+                options.eventsCsvPath = argv[++i];
+            }
+            else if (strcmp (arg, "--at") == 0 && hasValue)
+            {
+                options.inspectTime = (float) atof (argv[++i]);
+            }
+            else if (strcmp (arg, "--check-determinism") == 0)
+            {
+                options.checkDeterminism = true;
+            }
+            else if (strcmp (arg, "--hash-trace") == 0 && hasValue)
+            {
+                options.hashTracePath = argv[++i];
+            }
+            else if (strcmp (arg, "--check-trace") == 0 && hasValue)
+            {
+                options.checkTracePath = argv[++i];
+            }
+            else if (strcmp (arg, "--check-snapshots") == 0)
+            {
+                options.checkSnapshots = true;
+            }
+            else if (strcmp (arg, "--check-allocations") == 0)
+            {
+                options.checkAllocations = true;
+            }
+            else if (strcmp (arg, "--check-kernels") == 0)
+            {
+                options.checkKernels = true;
+            }
+            else
+            {
+                fprintf (stderr, "Unknown or incomplete option: %s\n", arg);
+                return false;
+            }
+        }
+
+        if (! options.replayPath.empty() && ! options.hasMatches)
+            options.matches = 1;
+
+        if (options.matches <= 0 || options.maxMatchTime <= 0.0f || options.jobTimeout <= 0.0f)
+        {
+            fprintf (stderr, "--matches, --max-time and --job-timeout must be positive\n");
+            return false;
+        }
+
+        if (! options.jobsPath.empty() && options.farmWorkers < 0)
+            options.farmWorkers = 0;
+
+        return true;
+    }
+
+    bool openStateStream (StateStreamWriter& writer, const std::string& path, const World& world, float tickRate)
+    {
+        StateStreamHeader header;
+        header.setFromWorld (world, tickRate);
+        header.keyframeInterval = (uint32_t) std::max (1.0f, config.replayKeyframeInterval * tickRate);
+
+        if (writer.open (path, header))
+            return true;
+
+        fprintf (stderr, "Couldn't write state stream: %s\n", path.c_str());
+        return false;
+    }
+
+    void closeStateStream (StateStreamWriter& writer, const std::string& path)
+    {
+        if (! writer.isOpen())
+            return;
+
+        writer.close();
+        printf ("wrote state stream %s", path.c_str());
+        if (writer.getNumDroppedFrames() > 0)
+            printf (" (%u frames dropped)", writer.getNumDroppedFrames());
+        printf ("\n");
+    }
+
+    bool openDataset (DatasetWriter& writer, const std::string& path, const World& world, float tickRate)
+    {
+        MatchHeader header;
+        header.setFromWorld (world, tickRate);
+
+        if (writer.open (path, header))
+            return true;
+
+        fprintf (stderr, "Couldn't write dataset: %s\n", path.c_str());
+        return false;
+    }
+
+    void closeDataset (DatasetWriter& writer, const std::string& path)
+    {
+        if (! writer.isOpen())
+            return;
+
+        writer.close();
+        printf ("wrote dataset %s", path.c_str());
+        if (writer.getNumDroppedFrames() > 0)
+            printf (" (%u frames dropped)", writer.getNumDroppedFrames());
+        printf ("\n");
+    }
+
+    bool openEventLog (EventLogWriter& writer, const std::string& path, const World& world, float tickRate)
+    {
+        MatchHeader header;
+        header.setFromWorld (world, tickRate);
+
+        if (writer.open (path, header))
+            return true;
+
+        fprintf (stderr, "Couldn't write event log: %s\n", path.c_str());
+        return false;
+    }
+
+    void closeEventLog (EventLogWriter& writer, const std::string& path)
+    {
+        if (! writer.isOpen())
+            return;
+
+        writer.close();
+        printf ("wrote event log %s", path.c_str());
+        if (writer.getNumDroppedEvents() > 0)
+            printf (" (%u events dropped)", writer.getNumDroppedEvents());
+        printf ("\n");
+    }
+
+    // Converts an event log to CSV on stdout
+    int runEventsCsv (const HeadlessOptions& options)
+    {
+        EventLogReader reader;
+        if (! reader.open (options.eventsCsvPath))
+        {
+            fprintf (stderr, "Couldn't read event log: %s\n", options.eventsCsvPath.c_str());
+            return 1;
+        }
+
+        if (! reader.isComplete())
+            fprintf (stderr, "Warning: %s is unfinished, read %zu events\n", options.eventsCsvPath.c_str(), reader.getEvents().size());
+
+        return reader.writeCsv (stdout) ? 0 : 1;
+    }
+
+    // Prints a dataset's columns and how well each compressed, then times a full column scan
+    int runInspectDataset (const HeadlessOptions& options)
+    {
+        DatasetReader reader;
+        if (! reader.open (options.inspectDatasetPath))
+        {
+            fprintf (stderr, "Couldn't read dataset: %s\n", options.inspectDatasetPath.c_str());
+            return 1;
+        }
+
+        const MatchHeader& header = reader.getHeader();
+        uint64_t numRows = reader.getNumRows();
+        double rowScale = 1.0 / (double) std::max<uint64_t> (1, numRows);
+
+        printf ("%s: seed %llu, %.0fx%.0f arena at %.0fHz, %llu rows in %zu chunks, %d columns\n\n",
+                options.inspectDatasetPath.c_str(), (unsigned long long) header.seed, header.arenaWidth, header.arenaHeight,
+                header.tickRate, (unsigned long long) numRows, reader.getNumChunks(), reader.getNumColumns());
+
+        uint64_t totalBytes = 0;
+        std::vector<float> values;
+        for (int column = 0; column < reader.getNumColumns(); ++column)
+        {
+            if (! reader.readColumn (column, values))
+            {
+                fprintf (stderr, "Couldn't decode column %s\n", reader.getColumnName (column).c_str());
+                return 1;
+            }
+
+            float low = values.empty() ? 0.0f : *std::min_element (values.begin(), values.end());
+            float high = values.empty() ? 0.0f : *std::max_element (values.begin(), values.end());
+            uint64_t bytes = reader.getColumnBytes (column);
+            totalBytes += bytes;
+
+            printf ("  %-16s %10.2f .. %-10.2f %9llu bytes  %5.2f per row\n", reader.getColumnName (column).c_str(),
+                    low, high, (unsigned long long) bytes, bytes * rowScale);
+        }
+
+        printf ("\n%.2f bytes per row, %.1fx smaller than raw floats\n", totalBytes * rowScale,
+                (double) numRows * reader.getNumColumns() * sizeof (float) / (double) std::max<uint64_t> (1, totalBytes));
+
+        // Training loaders read a few columns at a time
+        constexpr int numScans = 20;
+        int scanColumn = std::max (0, reader.findColumn ("moveX"));
+        auto startTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < numScans; ++i)
+            reader.readColumn (scanColumn, values);
+        double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+
+        printf ("%.1f million rows per second decoding one column\n", numRows * numScans / std::max (elapsed, 1e-9) / 1e6);
+        return 0;
+    }
+
+    // Prints the state at one point in a state stream, then times random seeks
+    int runInspect (const HeadlessOptions& options)
+    {
+        StateStreamReader reader;
+        if (! reader.open (options.inspectPath))
+        {
+            fprintf (stderr, "Couldn't read state stream: %s\n", options.inspectPath.c_str());
+            return 1;
+        }
+
+        const StateStreamHeader& header = reader.getHeader();
+        float tickRate = std::max (1.0f, header.tickRate);
+        uint32_t firstTick = reader.getFirstTick();
+        uint32_t lastTick = reader.getLastTick();
+
+        printf ("%s: seed %llu, %.0fx%.0f arena, ticks %u-%u (%.1fs) at %.0fHz, %zu keyframes every %u ticks\n",
+                options.inspectPath.c_str(), (unsigned long long) header.seed, header.arenaWidth, header.arenaHeight,
+                firstTick, lastTick, lastTick / tickRate, tickRate, reader.getNumKeyframes(), header.keyframeInterval);
+
+        StateFrame frame;
+        uint32_t tick = std::clamp ((uint32_t) std::max (0.0f, options.inspectTime * tickRate), firstTick, lastTick);
+        if (! reader.seek (tick, frame))
+        {
+            fprintf (stderr, "Couldn't decode tick %u\n", tick);
+            return 1;
+        }
+
+        Vec2 wind = frame.getWind();
+        Vec2 current = frame.getCurrent();
+        printf ("\ntick %u (%.2fs): wind (%.2f, %.2f), current (%.2f, %.2f), %d shells\n",
+                frame.tick, frame.tick / tickRate, wind.x, wind.y, current.x, current.y, frame.numShells);
+
+        for (int i = 0; i < World::MAX_SHIPS; ++i)
+        {
+            if (! frame.hasShip (i))
+                continue;
+
+            Vec2 position = frame.getShipPosition (i);
+            printf ("  ship %-2d type %d  pos (%7.1f, %7.1f)  angle %6.1f  health %6.1f%s\n", i + 1, header.shipTypes[i],
+                    position.x, position.y, frame.getShipAngle (i) * 57.2958f, frame.getShipHealth (i),
+                    frame.isShipAlive (i) ? "" : (frame.isShipVisible (i) ? "  sinking" : "  sunk"));
+        }
+
+        // Scrubbing cost: seek to random ticks
+        constexpr int numSeeks = 1000;
+        Random random (header.seed, 0);
+        auto startTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < numSeeks; ++i)
+            reader.seek (firstTick + (uint32_t) random.nextInt ((int) (lastTick - firstTick + 1)), frame);
+        double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+
+        printf ("\n%.1f us per random seek\n", elapsed * 1e6 / numSeeks);
+        return 0;
+    }
+
+    // Runs a single match (AI-only, or driven by a replay) while hashing the state
+    // after every tick. Depending on the options it runs a second copy side by
+    // side, records a hash trace and/or checks against an earlier one, and stops
+    // at the first tick that differs. Returns 3 on divergence.
+    int runDivergenceChecks (const HeadlessOptions& options, const ShipHulls& hulls)
+    {
+        GameMode mode = options.mode;
+        uint64_t seed = options.hasSeed ? options.seed : 0;
+        std::string replayPath = options.replayPath;
+
+        HashTrace expected;
+        bool checkTrace = ! options.checkTracePath.empty();
+        if (checkTrace)
+        {
+            if (! expected.load (options.checkTracePath))
+            {
+                fprintf (stderr, "Couldn't load hash trace: %s\n", options.checkTracePath.c_str());
+                return 1;
+            }
+
+            // Re-create the traced run
+            mode = (GameMode) expected.mode;
+            seed = expected.seed;
+            if (replayPath.empty())
+                replayPath = expected.replayFile;
+        }
+
+        ReplayPlayer replay;
+        bool useReplay = ! replayPath.empty();
+        float arenaWidth = World::DEFAULT_ARENA_WIDTH;
+        float arenaHeight = World::DEFAULT_ARENA_HEIGHT;
+        World::ShipTypes shipTypes;
+        shipTypes.fill (-1);
+        float stepTime = 1.0f / std::max (1.0f, config.simPhysicsRate);
+        float aiRate = 0.0f;
+
+        if (useReplay)
+        {
+            if (! replay.load (replayPath))
+            {
+                fprintf (stderr, "Couldn't load replay: %s\n", replayPath.c_str());
+                return 1;
+            }
+
+            const ReplayHeader& header = replay.getHeader();
+            stepTime = header.getStepTime();
+            aiRate = header.aiRate;
+            mode = header.mode;
+            seed = header.seed;
+            shipTypes = header.shipTypes;
+            arenaWidth = header.arenaWidth;
+            arenaHeight = header.arenaHeight;
+        }
+
+        World world (hulls);
+        std::unique_ptr<World> twin;
+        if (options.checkDeterminism)
+            twin = std::make_unique<World> (hulls);
+
+        for (World* w : { &world, twin.get() })
+        {
+            if (w == nullptr)
+                continue;
+            w->setArenaSize (arenaWidth, arenaHeight);
+            w->setCosmeticsEnabled (false);
+            w->setAIRate (aiRate);
+            w->start (mode, shipTypes, seed);
+        }
+
+        HashTrace trace;
+        trace.mode = (uint8_t) mode;
+        trace.seed = seed;
+        trace.replayFile = replayPath;
+
+        StateHasher hasher, twinHasher;
+        World::ShipInputs inputs = {};
+        uint32_t tick = 0;
+
+        auto reportDivergence = [&] (const std::string& where)
+        {
+            printf ("DIVERGED at tick %u (%.3fs): %s\n", tick, world.getMatchTime(), where.c_str());
+            return 3;
+        };
+
+        while (! world.isOver())
+        {
+            if (useReplay)
+            {
+                if (! replay.nextTick (inputs, arenaWidth, arenaHeight))
+                    break;
+                world.setArenaSize (arenaWidth, arenaHeight);
+                if (twin)
+                    twin->setArenaSize (arenaWidth, arenaHeight);
+            }
+            else if (world.getMatchTime() >= options.maxMatchTime || (checkTrace && tick == expected.getNumTicks()))
+            {
+                break;
+            }
+
+            world.update (stepTime, inputs);
+            tick++;
+
+            hasher.clear();
+            world.hashState (hasher);
+
+            if (! options.hashTracePath.empty())
+                trace.addTick (hasher);
+
+            if (twin)
+            {
+                twin->update (stepTime, inputs);
+                twinHasher.clear();
+                twin->hashState (twinHasher);
+
+                if (twinHasher.getHash() != hasher.getHash())
+                {
+                    // Hash again keeping every field to find the first one that differs
+                    StateHasher fields (true), twinFields (true);
+                    world.hashState (fields);
+                    twin->hashState (twinFields);
+                    return reportDivergence ("second run differs, " + findFirstDifference (fields, twinFields));
+                }
+            }
+
+            if (checkTrace)
+            {
+                std::string difference = expected.compare (tick - 1, hasher);
+                if (! difference.empty())
+                    return reportDivergence ("differs from trace in " + difference);
+            }
+        }
+
+        if (checkTrace && tick != expected.getNumTicks())
+            return reportDivergence ("run ended, the trace has " + std::to_string (expected.getNumTicks()) + " ticks");
+
+        if (! options.hashTracePath.empty())
+        {
+            if (! trace.save (options.hashTracePath))
+            {
+                fprintf (stderr, "Couldn't write hash trace: %s\n", options.hashTracePath.c_str());
+                return 1;
+            }
+            printf ("wrote hash trace %s\n", options.hashTracePath.c_str());
+        }
+
+        printf ("no divergence over %u ticks (%.1fs, seed %llu, final hash %016llx)\n", tick, world.getMatchTime(),
+                (unsigned long long) seed, (unsigned long long) hasher.getHash());
+        return 0;
+    }
+
+    // Every second of an AI-only match: snapshot, run ahead, restore, run ahead
+    // again. The restored state and the second branch must hash the same as the
+    // first, which catches any gameplay state the snapshot misses. Also times
+    // capture and restore. Returns 3 on a mismatch.
+    int runSnapshotCheck (const HeadlessOptions& options, const ShipHulls& hulls)
+    {
+        constexpr int branchInterval = 60;
+        constexpr int branchLength = 30;
+
+        using Clock = std::chrono::steady_clock;
+
+        uint64_t seed = options.hasSeed ? options.seed : 0;
+        float stepTime = 1.0f / std::max (1.0f, config.simPhysicsRate);
+
+        World world (hulls);
+        world.setCosmeticsEnabled (false);
+        World::ShipTypes shipTypes;
+        shipTypes.fill (-1);
+        World::ShipInputs inputs = {};
+        world.start (options.mode, shipTypes, seed);
+
+        auto snapshot = std::make_unique<WorldSnapshot>();
+        StateHasher before (true), branch (true), after (true);
+        double saveTime = 0.0, restoreTime = 0.0;
+        int branches = 0;
+        int maxShells = 0;
+        uint32_t tick = 0;
+
+        auto fail = [&] (const char* what, const StateHasher& expected, const StateHasher& actual)
+        {
+            printf ("FAILED at tick %u: %s, %s\n", tick, what, findFirstDifference (expected, actual).c_str());
+            return 3;
+        };
+
+        while (! world.isOver() && world.getMatchTime() < options.maxMatchTime)
+        {
+            maxShells = std::max (maxShells, (int) world.getShells().size());
+
+            if (tick % branchInterval == 0)
+            {
+                auto start = Clock::now();
+                if (! world.saveSnapshot (*snapshot))
+                {
+                    printf ("FAILED at tick %u: %zu shells don't fit in a snapshot\n", tick, world.getShells().size());
+                    return 3;
+                }
+                saveTime += std::chrono::duration<double> (Clock::now() - start).count();
+
+                before.clear();
+                world.hashState (before);
+
+                for (int i = 0; i < branchLength; ++i)
+                    world.update (stepTime, inputs);
+                branch.clear();
+                world.hashState (branch);
+
+                start = Clock::now();
+                world.restoreSnapshot (*snapshot);
+                restoreTime += std::chrono::duration<double> (Clock::now() - start).count();
+
+                after.clear();
+                world.hashState (after);
+                if (after.getHash() != before.getHash())
+                    return fail ("restore differs from the saved state", before, after);
+
+                for (int i = 0; i < branchLength; ++i)
+                    world.update (stepTime, inputs);
+                after.clear();
+                world.hashState (after);
+                if (after.getHash() != branch.getHash())
+                    return fail ("branch from the snapshot went differently", branch, after);
+
+                // Carry on the main line from the restored state
+                world.restoreSnapshot (*snapshot);
+                branches++;
+            }
+
+            world.update (stepTime, inputs);
+            tick++;
+        }
+
+        printf ("%d branches over %u ticks (seed %llu) all restored exactly\n", branches, tick, (unsigned long long) seed);
+        if (branches > 0)
+            printf ("snapshot %zu bytes, save %.2f us, restore %.2f us, at most %d shells in flight\n", sizeof (WorldSnapshot),
+                    saveTime * 1e6 / branches, restoreTime * 1e6 / branches, maxShells);
+        return 0;
+    }
+
+    // Plays one AI-only match with cosmetics on, as the game would, counting the heap
+    // allocations each tick makes once the first second is over. Each tick is recorded
+    // the way the game records it too: the replay, and a state stream, dataset and event
+    // log written to the temp folder. Their writer threads aren't counted, only what the
+    // game thread does. Returns 5 if any tick allocated
+    int runAllocationCheck (const HeadlessOptions& options, const ShipHulls& hulls)
+    {
+        if (! AllocTracker::isActive())
+        {
+            fprintf (stderr, "--check-allocations needs a build with -DHELIGOLAND_TRACK_ALLOCATIONS=ON\n");
+            return 1;
+        }
+
+        uint64_t seed = options.hasSeed ? options.seed : 0;
+        GameMode mode = options.hasMode ? options.mode : GameMode::Battle;
+        float stepTime = 1.0f / std::max (1.0f, config.simPhysicsRate);
+        uint32_t warmUpTicks = (uint32_t) std::max (1.0f, config.simPhysicsRate);
+
+        World world (hulls);
+        World::ShipTypes shipTypes;
+        shipTypes.fill (-1);
+        World::ShipInputs inputs = {};
+        world.start (mode, shipTypes, seed);
+
+        ReplayRecorder recorder;
+        {
+            ReplayHeader header;
+            header.mode = mode;
+            header.seed = world.getMatchSeed();
+            header.shipTypes = shipTypes;
+            header.arenaWidth = world.getArenaWidth();
+            header.arenaHeight = world.getArenaHeight();
+            header.physicsRate = config.simPhysicsRate;
+            header.aiRate = config.simAIRate;
+            header.version = HELIGOLAND_VERSION;
+            recorder.begin (header);
+        }
+
+        std::string tempPrefix = (std::filesystem::temp_directory_path() / "heligoland-alloc-check").string();
+        std::string statePath = tempPrefix + StateStream::fileExtension;
+        std::string datasetPath = tempPrefix + Dataset::fileExtension;
+        std::string eventsPath = tempPrefix + EventLog::fileExtension;
+
+        StateStreamWriter stateWriter;
+        DatasetWriter datasetWriter;
+        EventLogWriter eventWriter;
+        if (! openStateStream (stateWriter, statePath, world, config.simPhysicsRate)
+            || ! openDataset (datasetWriter, datasetPath, world, config.simPhysicsRate)
+            || ! openEventLog (eventWriter, eventsPath, world, config.simPhysicsRate))
+            return 1;
+
+        AllocTracker::Counts total;
+        uint32_t tick = 0;
+        uint32_t allocatingTicks = 0;
+        int64_t firstAllocatingTick = -1;
+
+        while (! world.isOver() && world.getMatchTime() < options.maxMatchTime)
+        {
+            AllocTracker::Counts start = AllocTracker::getCounts();
+            recorder.recordTick (inputs, world.getArenaWidth(), world.getArenaHeight());
+            world.update (stepTime, inputs);
+            stateWriter.addFrame (world, tick);
+            datasetWriter.addFrame (world, tick);
+            eventWriter.addEvents (world, tick);
+            AllocTracker::Counts made = AllocTracker::getCounts() - start;
+
+            if (tick >= warmUpTicks && made.getTotal() > 0)
+            {
+                for (size_t i = 0; i < made.allocations.size(); ++i)
+                    total.allocations[i] += made.allocations[i];
+                total.bytes += made.bytes;
+
+                if (firstAllocatingTick < 0)
+                    firstAllocatingTick = tick;
+                allocatingTicks++;
+            }
+            tick++;
+        }
+
+        stateWriter.close();
+        datasetWriter.close();
+        eventWriter.close();
+        std::error_code error;
+        for (const std::string& path : { statePath, datasetPath, eventsPath })
+            std::filesystem::remove (path, error);
+
+        printf ("%u ticks (seed %llu), the first %u not counted\n", tick, (unsigned long long) seed, warmUpTicks);
+        if (allocatingTicks == 0)
+        {
+            printf ("no heap allocations in the steady state\n");
+            return 0;
+        }
+
+        printf ("FAILED: %u ticks allocated, the first at tick %lld, %llu allocations of %llu bytes\n", allocatingTicks,
+                (long long) firstAllocatingTick, (unsigned long long) total.getTotal(), (unsigned long long) total.bytes);
+        for (size_t i = 0; i < total.allocations.size(); ++i)
+            if (total.allocations[i] > 0)
+                printf ("  %-8s %llu\n", AllocTracker::getTagName ((AllocTracker::Tag) i), (unsigned long long) total.allocations[i]);
+        return 5;
+    }
+
+    // Runs every particle kernel this CPU supports over the same random particles and
+    // checks each gives exactly what the scalar version does. Also times them. Returns 6
+    // on a mismatch
+    int runKernelCheck (const HeadlessOptions& options)
+    {
+        using namespace ParticleKernels;
+        using Clock = std::chrono::steady_clock;
+
+        constexpr int count = 12289;    // Not a whole number of vectors, so the leftovers are covered too
+        constexpr int repeats = 200;
+        constexpr float stepTime = 1.0f / 60.0f;
+        constexpr float now = 30.0f;
+        constexpr float expiryLimit = 0.3f;  // About 1 in 100 spawn times are at or below this
+
+        uint64_t seed = options.hasSeed ? options.seed : 0;
+        Random random (seed, 0);
+        auto makeColumn = [&] (float min, float max)
+        {
+            std::vector<float> column (count);
+            for (auto& value : column)
+                value = random.nextFloat (min, max);
+            return column;
+        };
+
+        std::vector<float> spawnX = makeColumn (0.0f, 2000.0f), spawnY = makeColumn (0.0f, 1200.0f);
+        std::vector<float> windX = makeColumn (0.0f, now), windY = makeColumn (-now, now);
+        std::vector<float> driftCos = makeColumn (0.8f, 1.0f), driftSin = makeColumn (-0.6f, 0.6f);
+        std::vector<float> spawnAlpha = makeColumn (0.1f, 0.7f), fadeRate = makeColumn (0.2f, 1.0f);
+        std::vector<float> spawnTime = makeColumn (0.0f, now);
+
+        SmokeInputs inputs;
+        inputs.spawnX = spawnX.data();
+        inputs.spawnY = spawnY.data();
+        inputs.windX = windX.data();
+        inputs.windY = windY.data();
+        inputs.driftCos = driftCos.data();
+        inputs.driftSin = driftSin.data();
+        inputs.spawnAlpha = spawnAlpha.data();
+        inputs.fadeRate = fadeRate.data();
+        inputs.spawnTime = spawnTime.data();
+        inputs.windTravel = { now * 0.7f, now * -0.2f };
+        inputs.windStrength = config.smokeWindStrength;
+        inputs.time = now;
+
+        struct Results
+        {
+            std::vector<float> faded, x, y, alpha;
+            std::vector<int> found;
+            std::array<double, 3> seconds = {};   // fade, findAtOrBelow, placeSmoke
+        };
+
+        auto run = [&] (const Kernels& kernels, Results& results)
+        {
+            results.faded = spawnAlpha;
+            results.x.assign (count, 0.0f);
+            results.y.assign (count, 0.0f);
+            results.alpha.assign (count, 0.0f);
+
+            auto start = Clock::now();
+            for (int r = 0; r < repeats; ++r)
+                kernels.fade (results.faded.data(), fadeRate.data(), count, stepTime);
+            auto end = Clock::now();
+            results.seconds[0] = std::chrono::duration<double> (end - start).count();
+
+            // Every match, carrying on from each as the retire loops do
+            start = Clock::now();
+            for (int r = 0; r < repeats; ++r)
+            {
+                results.found.clear();
+                for (int i = kernels.findAtOrBelow (spawnTime.data(), 0, count, expiryLimit); i < count;
+                     i = kernels.findAtOrBelow (spawnTime.data(), i + 1, count, expiryLimit))
+                    results.found.push_back (i);
+            }
+            end = Clock::now();
+            results.seconds[1] = std::chrono::duration<double> (end - start).count();
+
+            start = Clock::now();
+            for (int r = 0; r < repeats; ++r)
+                kernels.placeSmoke (inputs, count, results.x.data(), results.y.data(), results.alpha.data());
+            end = Clock::now();
+            results.seconds[2] = std::chrono::duration<double> (end - start).count();
+        };
+
+        auto sameBits = [] (const std::vector<float>& a, const std::vector<float>& b)
+        {
+            return a.size() == b.size() && memcmp (a.data(), b.data(), a.size() * sizeof (float)) == 0;
+        };
+
+        std::array<Results, (size_t) Isa::numIsas> results;
+        run (get (Isa::Scalar), results[0]);
+
+        printf ("%d particles x %d repeats (seed %llu), this CPU runs %s\n", count, repeats, (unsigned long long) seed,
+                getIsaName (getBestIsa()));
+        printf ("%-8s %12s %12s %12s   ns per particle\n", "", "fade", "find", "placeSmoke");
+
+        bool allMatch = true;
+        for (int isa = 0; isa < (int) Isa::numIsas; ++isa)
+        {
+            if (! isSupported ((Isa) isa))
+                continue;
+
+            Results& result = results[isa];
+            if (isa > 0)
+                run (get ((Isa) isa), result);
+
+            printf ("%-8s", getIsaName ((Isa) isa));
+            for (double seconds : result.seconds)
+                printf (" %12.3f", seconds * 1e9 / ((double) count * repeats));
+
+            const Results& scalar = results[0];
+            bool match = sameBits (result.faded, scalar.faded) && result.found == scalar.found && sameBits (result.x, scalar.x)
+                      && sameBits (result.y, scalar.y) && sameBits (result.alpha, scalar.alpha);
+            printf (match ? "\n" : "   MISMATCH\n");
+            allMatch = allMatch && match;
+        }
+
+        if (! allMatch)
+        {
+            printf ("FAILED: a vector kernel differs from the scalar one\n");
+            return 6;
+        }
+
+        printf ("every kernel matches the scalar version bit for bit\n");
+        return 0;
+    }
+
+    // Plays a recording back as fast as possible. Returns 0 if every run reproduced it
+    int runReplay (const HeadlessOptions& options, const ShipHulls& hulls)
+    {
+        ReplayPlayer replay;
+        if (! replay.load (options.replayPath))
+        {
+            fprintf (stderr, "Couldn't load replay: %s\n", options.replayPath.c_str());
+            return 1;
+        }
+
+        const ReplayHeader& header = replay.getHeader();
+        float stepTime = header.getStepTime();
+
+        if (header.version != HELIGOLAND_VERSION)
+            fprintf (stderr, "Warning: replay recorded by version %s, this is %s\n", header.version.c_str(), HELIGOLAND_VERSION);
+
+        World world (hulls);
+        world.setCosmeticsEnabled (false);
+        world.setAIRate (header.aiRate);
+        World::ShipInputs inputs;
+        StateStreamWriter stateWriter;
+        DatasetWriter datasetWriter;
+        EventLogWriter eventWriter;
+        int diverged = 0;
+        uint64_t totalTicks = 0;
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        for (int run = 0; run < options.matches; ++run)
+        {
+            replay.rewind();
+            world.setArenaSize (header.arenaWidth, header.arenaHeight);
+            world.start (header.mode, header.shipTypes, header.seed);
+
+            if (run == 0 && ! options.stateStreamPath.empty())
+                openStateStream (stateWriter, options.stateStreamPath, world, header.physicsRate);
+            if (run == 0 && ! options.datasetPath.empty())
+                openDataset (datasetWriter, options.datasetPath, world, header.physicsRate);
+            if (run == 0 && ! options.eventLogPath.empty())
+                openEventLog (eventWriter, options.eventLogPath, world, header.physicsRate);
+
+            uint32_t ticks = 0;
+            float arenaWidth, arenaHeight;
+            while (! world.isOver() && replay.nextTick (inputs, arenaWidth, arenaHeight))
+            {
+                world.setArenaSize (arenaWidth, arenaHeight);
+                world.update (stepTime, inputs);
+                ticks++;
+
+                if (stateWriter.isOpen())
+                    stateWriter.addFrame (world, ticks, true);
+                if (datasetWriter.isOpen())
+                    datasetWriter.addFrame (world, ticks, true);
+                if (eventWriter.isOpen())
+                    eventWriter.addEvents (world, ticks, true);
+            }
+            totalTicks += ticks;
+            closeStateStream (stateWriter, options.stateStreamPath);
+            closeDataset (datasetWriter, options.datasetPath);
+            closeEventLog (eventWriter, options.eventLogPath);
+
+            int winner = world.isOver() ? world.getWinnerIndex() : -1;
+            bool same = ticks == replay.getRecordedTicks()
+                        && world.isOver() == replay.hasResult()
+                        && (! replay.hasResult() || winner == replay.getRecordedWinner());
+            if (! same)
+                diverged++;
+
+            if (! options.quiet)
+                printf ("run %d: %s after %u ticks (recorded %s after %u ticks) - %s\n", run + 1,
+                        world.isOver() ? Batch::describeWinner (header.mode, winner).c_str() : "unfinished", ticks,
+                        replay.hasResult() ? Batch::describeWinner (header.mode, replay.getRecordedWinner()).c_str() : "unfinished",
+                        replay.getRecordedTicks(), same ? "matches recording" : "DIVERGED");
+        }
+
+        double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+
+        printf ("\n%d runs of %s (seed %llu), %d diverged\n", options.matches, options.replayPath.c_str(),
+                (unsigned long long) header.seed, diverged);
+        if (elapsed > 0.0)
+            printf ("%.0f ticks/sec, %.2f ms per run\n", totalTicks / elapsed, elapsed * 1000.0 / options.matches);
+
+        // Runs after the first should reuse the arena without going back to the heap
+        const MatchArena& memory = world.getMatchMemory();
+        printf ("match memory: %zu KB used of %zu KB, %zu heap allocations\n", memory.getUsed() / 1024,
+                memory.getCapacity() / 1024, memory.getNumHeapAllocations());
+
+        return diverged > 0 ? 2 : 0;
+    }
+
+    // Prints each match (unless quiet), the wins per side and the speed, and
+    // writes the results file if one was asked for
+    int printResults (const HeadlessOptions& options, const std::vector<MatchResult>& results, double elapsed)
+    {
+        // Wins indexed like World::getWinnerIndex()
+        std::array<int, World::MAX_SHIPS> wins = {};
+        int draws = 0;
+        int timeouts = 0;
+        double totalGameTime = 0.0;
+        GameMode mode = results.empty() ? options.mode : results[0].mode;
+        bool sameMode = true;
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const MatchResult& result = results[i];
+            if (result.winnerIndex >= 0)
+                wins[result.winnerIndex]++;
+            else
+                draws++;
+            if (result.timedOut)
+                timeouts++;
+
+            totalGameTime += result.duration;
+            sameMode = sameMode && result.mode == mode;
+
+            if (! options.quiet)
+                printf ("match %zu (%s, seed %llu): %s after %.1fs%s\n", i + 1, Batch::getModeName (result.mode),
+                        (unsigned long long) result.seed, Batch::describeWinner (result.mode, result.winnerIndex).c_str(),
+                        result.duration, result.timedOut ? " (time limit)" : "");
+        }
+
+        // Sides only mean something when every match was the same mode
+        if (sameMode)
+        {
+            bool isTeamMode = (mode == GameMode::Teams || mode == GameMode::Battle);
+            int numSides = isTeamMode ? 2 : World::getNumShipsForMode (mode);
+            for (int i = 0; i < numSides; ++i)
+                printf ("  %-8s %d\n", Batch::describeWinner (mode, i).c_str(), wins[i]);
+        }
+        printf ("  %-8s %d (%d hit the time limit)\n", "draw", draws, timeouts);
+
+        if (elapsed > 0.0)
+            printf ("%.1f matches/sec, %.0fx real time\n", results.size() / elapsed, totalGameTime / elapsed);
+
+        if (! options.resultsPath.empty())
+        {
+            if (! Batch::writeResults (options.resultsPath, results))
+            {
+                fprintf (stderr, "Couldn't write results: %s\n", options.resultsPath.c_str());
+                return 1;
+            }
+            printf ("wrote %s\n", options.resultsPath.c_str());
+        }
+
+        return 0;
+    }
+
+    // Win rates for each pairing of ship types at the current config, or at
+    // every point of a sweep over config values. --matches is per pairing
+    int runBalance (const HeadlessOptions& options, const ShipHulls& hulls)
+    {
+        std::vector<SweepParameter> parameters;
+        for (const auto& text : options.sweepParameters)
+        {
+            SweepParameter parameter;
+            std::string error;
+            if (! Sweep::parseParameter (text, parameter, error))
+            {
+                fprintf (stderr, "%s\n", error.c_str());
+                fprintf (stderr, "Parameters:");
+                for (const auto& name : Sweep::getParameterNames())
+                    fprintf (stderr, " %s", name.c_str());
+                fprintf (stderr, "\n");
+                return 1;
+            }
+            parameters.push_back (parameter);
+        }
+
+        uint64_t seed = options.hasSeed ? options.seed : (uint64_t) ::time (nullptr);
+        auto points = options.sweepSamples > 0 ? Sweep::makeSamples (parameters, options.sweepSamples, seed)
+                                               : Sweep::makeGrid (parameters);
+
+        std::vector<float*> values;
+        std::vector<float> original;
+        for (const auto& parameter : parameters)
+        {
+            values.push_back (Sweep::findParameter (config, parameter.name));
+            original.push_back (*values.back());
+        }
+
+        FILE* csv = nullptr;
+        if (! options.resultsPath.empty())
+        {
+            csv = fopen (options.resultsPath.c_str(), "w");
+            if (csv == nullptr)
+            {
+                fprintf (stderr, "Couldn't write results: %s\n", options.resultsPath.c_str());
+                return 1;
+            }
+
+            fprintf (csv, "point");
+            for (const auto& parameter : parameters)
+                fprintf (csv, ",%s", parameter.name.c_str());
+            fprintf (csv, ",typeA,typeB,matches,winsA,winsB,draws,winRateA,low95,high95\n");
+        }
+
+        BatchRunner runner (hulls, options.threads);
+        printf ("%zu points x %d pairings x %d matches, seed %llu, %d threads\n", points.size(),
+                NUM_SHIP_TYPES * (NUM_SHIP_TYPES - 1) / 2, options.matches, (unsigned long long) seed, runner.getNumThreads());
+
+        auto startTime = std::chrono::steady_clock::now();
+        int totalMatches = 0;
+
+        for (size_t p = 0; p < points.size(); ++p)
+        {
+            // Only read between batches, while no match is running
+            for (size_t i = 0; i < values.size(); ++i)
+                *values[i] = points[p][i];
+
+            printf ("\npoint %zu/%zu:", p + 1, points.size());
+            for (size_t i = 0; i < parameters.size(); ++i)
+                printf (" %s=%g", parameters[i].name.c_str(), points[p][i]);
+            printf ("%s\n", parameters.empty() ? " current config" : "");
+
+            for (const auto& pairing : Sweep::runPairings (runner, options.matches, seed, options.maxMatchTime))
+            {
+                double low, high;
+                Sweep::getWilsonInterval (pairing.winsA, pairing.getNumDecided(), low, high);
+
+                std::string name = config.shipTypes[pairing.typeA].name + " vs " + config.shipTypes[pairing.typeB].name;
+                printf ("  %-24s %5.1f%%  [%5.1f, %5.1f]  (%d-%d, %d draws)\n", name.c_str(), pairing.getWinRateA() * 100.0,
+                        low * 100.0, high * 100.0, pairing.winsA, pairing.winsB, pairing.draws);
+
+                if (csv != nullptr)
+                {
+                    fprintf (csv, "%zu", p + 1);
+                    for (float value : points[p])
+                        fprintf (csv, ",%g", value);
+                    fprintf (csv, ",%s,%s,%d,%d,%d,%d,%.4f,%.4f,%.4f\n", config.shipTypes[pairing.typeA].name.c_str(),
+                             config.shipTypes[pairing.typeB].name.c_str(), options.matches, pairing.winsA, pairing.winsB,
+                             pairing.draws, pairing.getWinRateA(), low, high);
+                }
+
+                totalMatches += options.matches;
+            }
+        }
+
+        for (size_t i = 0; i < values.size(); ++i)
+            *values[i] = original[i];
+
+        if (csv != nullptr)
+        {
+            fclose (csv);
+            printf ("\nwrote %s\n", options.resultsPath.c_str());
+        }
+
+        double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+        if (elapsed > 0.0)
+            printf ("%d matches, %.1f matches/sec\n", totalMatches, totalMatches / elapsed);
+
+        printf ("Win rates are of decided matches, with 95%% Wilson score intervals\n");
+        return 0;
+    }
+
+    void printParams (const AIParams& params)
+    {
+        for (int i = 0; i < Optimiser::getNumParameters(); ++i)
+            printf ("  %-24s %g\n", Optimiser::getParameterName (i), Optimiser::getParameter (params, i));
+    }
+
+    // Evolves AI params that beat the default AI, --matches per candidate, and
+    // writes the mean to --results after every generation so an overnight run
+    // can be stopped at any point
+    int runOptimise (const HeadlessOptions& options, const ShipHulls& hulls)
+    {
+        AIParams start;
+        if (! options.aiParamsPath.empty())
+        {
+            std::string error;
+            if (! Optimiser::loadParams (options.aiParamsPath, start, error))
+            {
+                fprintf (stderr, "%s\n", error.c_str());
+                return 1;
+            }
+        }
+
+        OptimiserSettings settings;
+        settings.populationSize = options.population;
+        settings.matchesPerCandidate = options.matches;
+        settings.mode = options.hasMode ? options.mode : GameMode::Duel;
+        settings.maxMatchTime = options.maxMatchTime;
+        settings.seed = options.hasSeed ? options.seed : (uint64_t) ::time (nullptr);
+
+        BatchRunner runner (hulls, options.threads);
+        Optimiser optimiser (runner, settings, start);
+
+        printf ("%d generations of %d candidates x %d %s matches against the default AI, seed %llu, %d threads\n",
+                options.optimiseGenerations, std::max (2, settings.populationSize), settings.matchesPerCandidate,
+                Batch::getModeName (settings.mode), (unsigned long long) settings.seed, runner.getNumThreads());
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        for (int g = 0; g < options.optimiseGenerations; ++g)
+        {
+            optimiser.runGeneration();
+
+            const Candidate& best = optimiser.getCandidates().front();
+            const Candidate& mean = optimiser.getMeanResult();
+            printf ("generation %d: mean scored %.1f%% (%d-%d, %d draws), best candidate %.1f%% (%d-%d, %d draws), step %.3f\n",
+                    optimiser.getGeneration(), mean.getScore() * 100.0, mean.wins, mean.losses, mean.draws,
+                    best.getScore() * 100.0, best.wins, best.losses, best.draws, optimiser.getStepSize());
+
+            if (! options.quiet)
+                printParams (optimiser.getMean());
+
+            if (! options.resultsPath.empty() && ! Optimiser::saveParams (options.resultsPath, optimiser.getMean()))
+            {
+                fprintf (stderr, "Couldn't write results: %s\n", options.resultsPath.c_str());
+                return 1;
+            }
+        }
+
+        // Judge the result on seeds no generation has seen, as a bigger sample
+        int numMatches = options.matches * 4;
+        uint64_t seed = settings.seed + (uint64_t) options.optimiseGenerations * (uint64_t) options.matches + 1000000;
+        Candidate result = Optimiser::evaluate (runner, optimiser.getMean(), AIParams(), settings.mode, numMatches,
+                                               seed, settings.maxMatchTime);
+
+        double low, high;
+        Sweep::getWilsonInterval (result.wins, result.wins + result.losses, low, high);
+
+        printf ("\nfinal params:\n");
+        printParams (result.params);
+        printf ("against the default AI on fresh seeds: %d-%d, %d draws, wins %.1f%% of decided [%.1f, %.1f]\n",
+                result.wins, result.losses, result.draws, result.wins + result.losses > 0 ? 100.0 * result.wins / (result.wins + result.losses) : 50.0,
+                low * 100.0, high * 100.0);
+
+        if (! options.resultsPath.empty())
+            printf ("wrote %s\n", options.resultsPath.c_str());
+
+        double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+        if (elapsed > 0.0)
+            printf ("%.0f seconds\n", elapsed);
+
+        return 0;
+    }
+
+    // Steps the RL environment with random actions, as a trainer would drive it
+    int runEnvBenchmark (const HeadlessOptions& options, const ShipHulls& hulls)
+    {
+        VectorEnv::Settings settings;
+        settings.numArenas = options.envArenas;
+        settings.mode = options.hasMode ? options.mode : GameMode::Duel;
+        settings.numThreads = options.threads;
+        settings.maxEpisodeTime = options.maxMatchTime;
+        settings.seed = options.hasSeed ? options.seed : (uint64_t) ::time (nullptr);
+
+        if (! VectorEnv::isValid (settings))
+        {
+            fprintf (stderr, "--env-bench needs at least one arena\n");
+            return 1;
+        }
+
+        VectorEnv env (hulls, settings);
+        size_t numAgents = (size_t) env.getNumAgents();
+
+        std::vector<float> actions (numAgents * HELIGOLAND_ACTION_SIZE);
+        std::vector<float> observations (numAgents * HELIGOLAND_OBS_SIZE);
+        std::vector<float> rewards (numAgents);
+        std::vector<uint8_t> dones (numAgents);
+
+        Random random (settings.seed, 0);
+        env.reset (observations.data());
+
+        double totalReward = 0.0;
+        auto startTime = std::chrono::steady_clock::now();
+
+        for (int step = 0; step < options.envSteps; ++step)
+        {
+            for (auto& action : actions)
+                action = random.nextSigned();
+
+            env.step (actions.data(), observations.data(), rewards.data(), dones.data());
+
+            for (float reward : rewards)
+                totalReward += reward;
+        }
+
+        double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+
+        printf ("%d arenas (%s), %d steps of %d ticks, %d threads: %llu episodes finished, mean reward %.4f per agent step\n",
+                settings.numArenas, Batch::getModeName (settings.mode), options.envSteps, settings.ticksPerStep,
+                env.getNumThreads(), (unsigned long long) env.getNumEpisodesFinished(),
+                totalReward / ((double) numAgents * options.envSteps));
+        if (elapsed > 0.0)
+            printf ("%.1f agent steps per ms, %.0f ticks/sec per arena\n", numAgents * options.envSteps / (elapsed * 1000.0),
+                    options.envSteps * settings.ticksPerStep / elapsed);
+        return 0;
+    }
+
+    // Plays AI-only matches (battle unless --mode is given, 10 unless --matches is) with
+    // the world timing its AI decisions and ship updates
+    int runUpdateBenchmark (const HeadlessOptions& options, const ShipHulls& hulls)
+    {
+        uint64_t seed = options.hasSeed ? options.seed : 0;
+        GameMode mode = options.hasMode ? options.mode : GameMode::Battle;
+        int matches = options.hasMatches ? options.matches : 10;
+        float stepTime = 1.0f / std::max (1.0f, config.simPhysicsRate);
+
+        World world (hulls);
+        world.setCosmeticsEnabled (false);
+        world.setProfiling (true);
+        World::ShipTypes shipTypes;
+        shipTypes.fill (-1);
+        World::ShipInputs inputs = {};
+        uint64_t ticks = 0;
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        for (int match = 0; match < matches; ++match)
+        {
+            world.start (mode, shipTypes, seed + (uint64_t) match);
+            while (! world.isOver() && world.getMatchTime() < options.maxMatchTime)
+            {
+                world.update (stepTime, inputs);
+                ticks++;
+            }
+        }
+
+        double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+        const World::UpdateTimes& times = world.getUpdateTimes();
+        auto getNanoseconds = [] (double seconds, uint64_t count) { return count > 0 ? seconds * 1e9 / (double) count : 0.0; };
+
+        printf ("%d matches (%s, seeds from %llu), %llu ticks at %.0f ticks/sec\n", matches, Batch::getModeName (mode),
+                (unsigned long long) seed, (unsigned long long) ticks, elapsed > 0.0 ? ticks / elapsed : 0.0);
+        printf ("AI decision  %8.0f ns  (%llu)\n", getNanoseconds (times.aiSeconds, times.aiUpdates), (unsigned long long) times.aiUpdates);
+        printf ("ship update  %8.0f ns  (%llu)\n", getNanoseconds (times.shipSeconds, times.shipUpdates), (unsigned long long) times.shipUpdates);
+        return 0;
+    }
+
+    // Runs the matches (or a job file) in worker processes. Returns 4 if any
+    // job still failed after its retries
+    int runFarm (const HeadlessOptions& options, const ShipHulls& hulls, const std::vector<MatchSpec>& specs)
+    {
+        if (! Farm::isSupported())
+        {
+            fprintf (stderr, "--farm isn't supported on this platform\n");
+            return 1;
+        }
+
+        std::vector<FarmJob> jobs;
+        if (! options.jobsPath.empty())
+        {
+            std::string error;
+            if (! Farm::loadJobs (options.jobsPath, jobs, error))
+            {
+                fprintf (stderr, "%s\n", error.c_str());
+                return 1;
+            }
+        }
+        else
+        {
+            for (const auto& spec : specs)
+                jobs.push_back ({ spec, "" });
+        }
+
+        FarmSettings settings;
+        settings.numWorkers = options.farmWorkers;
+        settings.jobTimeout = options.jobTimeout;
+
+        auto startTime = std::chrono::steady_clock::now();
+        auto outcomes = Farm::run (hulls, jobs, settings, [&] (size_t index, const FarmOutcome& outcome)
+        {
+            if (! outcome.ok)
+                fprintf (stderr, "job %zu (seed %llu) failed (%d attempts): %s\n", index + 1,
+                         (unsigned long long) jobs[index].spec.seed, outcome.attempts, outcome.error.c_str());
+            else if (outcome.attempts > 1)
+                fprintf (stderr, "job %zu (seed %llu) succeeded on attempt %d, before that: %s\n", index + 1,
+                         (unsigned long long) jobs[index].spec.seed, outcome.attempts, outcome.error.c_str());
+        });
+        double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+
+        std::vector<MatchResult> results;
+        int failed = 0;
+        int retried = 0;
+        for (const auto& outcome : outcomes)
+        {
+            if (outcome.ok)
+                results.push_back (outcome.result);
+            else
+                failed++;
+            if (outcome.attempts > 1)
+                retried++;
+        }
+
+        printf ("%s%zu jobs on %d workers: %zu finished, %d failed, %d needed a retry\n", options.quiet ? "" : "\n",
+                jobs.size(), settings.numWorkers > 0 ? settings.numWorkers : Batch::getDefaultNumThreads(),
+                results.size(), failed, retried);
+
+        int result = printResults (options, results, elapsed);
+        return result != 0 ? result : (failed > 0 ? 4 : 0);
+    }
+}
+
+int runHeadless (int argc, char* argv[])
+{
+    HeadlessOptions options;
+    if (! parseOptions (argc, argv, options))
+        return 1;
+
+    if (! options.inspectPath.empty())
+        return runInspect (options);
+
+    if (! options.inspectDatasetPath.empty())
+        return runInspectDataset (options);
+
+    if (! options.eventsCsvPath.empty())
+        return runEventsCsv (options);
+
+    if (options.checkKernels)
+        return runKernelCheck (options);
+
+    // Farm workers are forked from here, so they pick this up too
+    if (! options.configOverrides.empty() && ! config.loadFromString (options.configOverrides))
+    {
+        fprintf (stderr, "Invalid --config: %s\n", options.configOverrides.c_str());
+        return 1;
+    }
+
+    // Hull images are only needed on the CPU for dimensions and hit testing
+    SetTraceLogLevel (LOG_WARNING);
+
+    ShipHulls hulls;
+    if (! hulls.isLoaded())
+        fprintf (stderr, "Warning: ship hulls not loaded, hit tests fall back to bounding circles\n");
+
+    if (options.checkSnapshots)
+        return runSnapshotCheck (options, hulls);
+
+    if (options.checkAllocations)
+        return runAllocationCheck (options, hulls);
+
+    if (options.checkDeterminism || ! options.hashTracePath.empty() || ! options.checkTracePath.empty())
+        return runDivergenceChecks (options, hulls);
+
+    if (! options.replayPath.empty())
+        return runReplay (options, hulls);
+
+    if (options.envArenas > 0)
+        return runEnvBenchmark (options, hulls);
+
+    if (options.updateBench)
+        return runUpdateBenchmark (options, hulls);
+
+    if (options.optimiseGenerations > 0)
+        return runOptimise (options, hulls);
+
+    if (options.balance)
+        return runBalance (options, hulls);
+
+    // Match n is seeded with seed + n, so any single match can be replayed with --seed <that> --matches 1
+    uint64_t seed = options.hasSeed ? options.seed : (uint64_t) ::time (nullptr);
+
+    std::vector<MatchSpec> specs ((size_t) options.matches);
+    for (size_t i = 0; i < specs.size(); ++i)
+    {
+        specs[i].mode = options.mode;
+        specs[i].seed = seed + i;
+        specs[i].maxMatchTime = options.maxMatchTime;
+    }
+
+    if (options.farmWorkers >= 0)
+        return runFarm (options, hulls, specs);
+
+    int numThreads = options.threads > 0 ? options.threads : Batch::getDefaultNumThreads();
+    auto startTime = std::chrono::steady_clock::now();
+
+    // The first match is run on its own when it's being recorded
+    std::vector<MatchResult> results;
+    if (! options.stateStreamPath.empty() || ! options.datasetPath.empty() || ! options.eventLogPath.empty())
+    {
+        World world (hulls);
+        world.setCosmeticsEnabled (false);  // Nothing is drawn
+        world.start (options.mode, specs[0].shipTypes, specs[0].seed);  // For the headers, runMatch restarts it the same way
+
+        StateStreamWriter stateWriter;
+        if (! options.stateStreamPath.empty())
+            openStateStream (stateWriter, options.stateStreamPath, world, config.simPhysicsRate);
+
+        DatasetWriter datasetWriter;
+        if (! options.datasetPath.empty())
+            openDataset (datasetWriter, options.datasetPath, world, config.simPhysicsRate);
+
+        EventLogWriter eventWriter;
+        if (! options.eventLogPath.empty())
+            openEventLog (eventWriter, options.eventLogPath, world, config.simPhysicsRate);
+
+        results.push_back (Batch::runMatch (world, specs[0], { &stateWriter, &datasetWriter, &eventWriter }));
+        closeStateStream (stateWriter, options.stateStreamPath);
+        closeDataset (datasetWriter, options.datasetPath);
+        closeEventLog (eventWriter, options.eventLogPath);
+
+        specs.erase (specs.begin());
+    }
+
+    auto batchResults = Batch::runMatches (hulls, specs, numThreads);
+    results.insert (results.end(), batchResults.begin(), batchResults.end());
+
+    double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+
+    printf ("%s%d matches, seed %llu, %d threads\n", options.quiet ? "" : "\n", options.matches,
+            (unsigned long long) seed, numThreads);
+    return printResults (options, results, elapsed);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// Runs AI-only matches back to back without a window, input devices or GPU.
+// Used for balance checks and soak tests on machines with no display.
+//
+//   Heligoland --headless [--matches N] [--mode ffa|teams|duel|triple|battle]
+//                         [--seed S] [--max-time SECONDS] [--quiet]
+//                         [--threads T] [--results FILE.csv|FILE.json]
+//
+// Matches run in parallel, one per thread (default one thread per core), and
+// per-match results can be written out. --batch N is the same as --headless --matches N.
+// --config JSON overrides config values, laid out like config.json.
+//
+// --farm W runs them in W worker processes instead (0 = one per core), so a
+// crashed or hung match (--job-timeout SECONDS) is retried rather than ending the
+// run. --jobs FILE gives the farm a list of match specs with their own config
+// overrides. Returns 4 if any job still failed.
+//
+// --balance reports win rates with confidence intervals for every pairing of ship
+// types in duels (--matches per pairing), and --sweep NAME=min:max:steps|a,b,c
+// repeats that over a grid of config values (or --samples N random points).
+//
+// --optimise-ai G evolves AI params for G generations of --population candidates,
+// each playing --matches games against the default AI (duels unless --mode is
+// given). The mean is saved to --results after each one, --ai-params FILE starts from a saved set.
+//
+// --env-bench ARENAS steps the reinforcement learning environment (VectorEnv)
+// --env-steps times with random actions and reports agent steps per ms.
+//
+// --update-bench plays AI-only matches (battle and 10 of them unless --mode and
+// --matches are given) and reports the time per AI decision and per ship update.
+//
+// With --replay FILE it plays a recorded match N times (default once) as a fixed
+// benchmark workload, and checks each run reproduces the recorded result.
+//
+// --state-stream FILE records the first match (or replay run) as a seekable state
+// stream, and --inspect FILE [--at SECONDS] prints one point of such a stream.
+// --dataset FILE records the same match's per-ship states and actions for
+// imitation learning, and --inspect-dataset FILE summarises one. --events FILE
+// logs its shots, hits, collisions and sinkings, and --events-csv FILE prints a log as CSV.
+//
+// Divergence checks run one match (from --seed, or --replay) hashing the state
+// after every tick: --check-determinism simulates it twice side by side,
+// --hash-trace FILE saves the hashes and --check-trace FILE compares against
+// them. Each reports the first tick and field that differ. --check-snapshots
+// branches an AI-only match from world snapshots and checks restores are exact.
+//
+// --check-allocations plays and records a match (battle unless --mode is given) and
+// returns 5 if any tick after the first second allocates from the heap. It needs a
+// build configured with -DHELIGOLAND_TRACK_ALLOCATIONS=ON.
+//
+// --check-kernels runs the SSE2 and AVX2 particle kernels the CPU supports against
+// the scalar ones, times them and returns 6 unless all match bit for bit.
+//
+// Returns the process exit code.
+int runHeadless (int argc, char* argv[]);
@@ -0,0 +1,96 @@
+#include "HeligolandEnv.h"
+#include "Config.h"
+#include "ShipHulls.h"
+#include "VectorEnv.h"
+#include <memory>
+#include <mutex>
+
+struct HeligolandEnv
+{
+    ShipHulls hulls;
+    std::unique_ptr<VectorEnv> env;
+};
+
+namespace
+{
+    // Config overrides write the process wide config, which is only safe while no
+    // environment exists to be stepping on another thread
+    std::mutex envsLock;
+    int numEnvs = 0;
+}
+
+void heligoland_env_default_settings (HeligolandEnvSettings* settings)
+{
+    VectorEnv::Settings defaults;
+
+    settings->numArenas = defaults.numArenas;
+    settings->agentsPerArena = defaults.agentsPerArena;
+    settings->mode = (int) defaults.mode;
+    settings->numThreads = defaults.numThreads;
+    settings->ticksPerStep = defaults.ticksPerStep;
+    settings->maxEpisodeTime = defaults.maxEpisodeTime;
+    settings->seed = defaults.seed;
+    settings->configJson = nullptr;
+}
+
+HeligolandEnv* heligoland_env_create (const HeligolandEnvSettings* settings)
+{
+    if (settings == nullptr || settings->mode < (int) GameMode::FFA || settings->mode > (int) GameMode::Battle)
+        return nullptr;
+
+    VectorEnv::Settings envSettings;
+    envSettings.numArenas = settings->numArenas;
+    envSettings.agentsPerArena = settings->agentsPerArena;
+    envSettings.mode = (GameMode) settings->mode;
+    envSettings.numThreads = settings->numThreads;
+    envSettings.ticksPerStep = settings->ticksPerStep;
+    envSettings.maxEpisodeTime = settings->maxEpisodeTime;
+    envSettings.seed = settings->seed;
+
+    if (! VectorEnv::isValid (envSettings))
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock (envsLock);
+
+    if (settings->configJson != nullptr && (numEnvs > 0 || ! config.loadFromString (settings->configJson)))
+        return nullptr;
+
+    // Exceptions mustn't cross the C boundary
+    try
+    {
+        auto env = std::make_unique<HeligolandEnv>();
+        env->env = std::make_unique<VectorEnv> (env->hulls, envSettings);
+        numEnvs++;
+        return env.release();
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void heligoland_env_destroy (HeligolandEnv* env)
+{
+    if (env == nullptr)
+        return;
+
+    delete env;
+
+    std::lock_guard<std::mutex> lock (envsLock);
+    numEnvs--;
+}
+
+int heligoland_env_num_agents (const HeligolandEnv* env)
+{
+    return env->env->getNumAgents();
+}
+
+void heligoland_env_reset (HeligolandEnv* env, float* observations)
+{
+    env->env->reset (observations);
+}
+
+void heligoland_env_step (HeligolandEnv* env, const float* actions, float* observations, float* rewards, uint8_t* dones)
+{
+    env->env->step (actions, observations, rewards, dones);
+}
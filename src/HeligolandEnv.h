@@ -0,0 +1,141 @@
+#pragma once
+
+#include <stdint.h>
+
+// =============================================================================
+// Heligoland reinforcement learning environment - C ABI
+// Steps N independent arenas in lockstep, spread over a pool of threads.
+// Agents are the first agentsPerArena ships of each arena; the rest are driven
+// by the built-in AI. Every buffer is owned by the caller and laid out as
+// structure of arrays: value v of agent a lives at [v * numAgents + a], where
+// agent a is ship (a % agentsPerArena) of arena (a / agentsPerArena). Nothing
+// is copied or allocated per step on this side of the API.
+//
+// Hull images are looked up under assets/ in the working directory; without
+// them hit tests fall back to bounding circles. The simulation config is
+// process wide, so every environment in a process shares it. Overrides
+// (configJson) can only be given while no other environment exists, so they
+// can't change the config under one that is stepping.
+// =============================================================================
+
+#if defined(_WIN32)
+ #if defined(HELIGOLAND_ENV_BUILD)
+  #define HELIGOLAND_ENV_API __declspec(dllexport)
+ #else
+  #define HELIGOLAND_ENV_API __declspec(dllimport)
+ #endif
+#else
+ #define HELIGOLAND_ENV_API __attribute__((visibility ("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Action values per agent, each -1 to 1. They become the ship's move and aim
+// inputs, and it fires when HELIGOLAND_ACTION_FIRE is above 0.5
+enum
+{
+    HELIGOLAND_ACTION_MOVE_X,
+    HELIGOLAND_ACTION_MOVE_Y,
+    HELIGOLAND_ACTION_AIM_X,
+    HELIGOLAND_ACTION_AIM_Y,
+    HELIGOLAND_ACTION_FIRE,
+    HELIGOLAND_ACTION_SIZE
+};
+
+// Observation values per agent. Other ships and shells are placed relative to
+// the agent's ship and scaled by the arena size, velocities by the agent's top speed
+enum
+{
+    // The agent's own ship
+    HELIGOLAND_OBS_X,                   // 0 to 1 across the arena
+    HELIGOLAND_OBS_Y,
+    HELIGOLAND_OBS_HEADING_X,           // Unit vector of the bow
+    HELIGOLAND_OBS_HEADING_Y,
+    HELIGOLAND_OBS_VELOCITY_X,
+    HELIGOLAND_OBS_VELOCITY_Y,
+    HELIGOLAND_OBS_HEALTH,              // 0 to 1
+    HELIGOLAND_OBS_RELOAD,              // 1 = every turret is loaded
+    HELIGOLAND_OBS_CROSSHAIR_X,         // Crosshair offset from the ship, scaled by its max range
+    HELIGOLAND_OBS_CROSSHAIR_Y,
+    HELIGOLAND_OBS_WIND_X,
+    HELIGOLAND_OBS_WIND_Y,
+    HELIGOLAND_OBS_TIME,                // Fraction of the episode time limit used
+    HELIGOLAND_OBS_SELF_SIZE
+};
+
+// Then one block per other ship slot, in ship index order skipping the agent's own
+enum
+{
+    HELIGOLAND_OBS_SHIP_PRESENT,    // 1 while the ship is afloat, otherwise the block is zero
+    HELIGOLAND_OBS_SHIP_ENEMY,
+    HELIGOLAND_OBS_SHIP_X,
+    HELIGOLAND_OBS_SHIP_Y,
+    HELIGOLAND_OBS_SHIP_HEADING_X,
+    HELIGOLAND_OBS_SHIP_HEADING_Y,
+    HELIGOLAND_OBS_SHIP_VELOCITY_X,
+    HELIGOLAND_OBS_SHIP_VELOCITY_Y,
+    HELIGOLAND_OBS_SHIP_HEALTH,
+    HELIGOLAND_OBS_SHIP_SIZE,
+    HELIGOLAND_OBS_OTHER_SHIPS = 11
+};
+
+// Then the nearest enemy shells in flight, nearest first
+enum
+{
+    HELIGOLAND_OBS_SHELL_PRESENT,
+    HELIGOLAND_OBS_SHELL_X,
+    HELIGOLAND_OBS_SHELL_Y,
+    HELIGOLAND_OBS_SHELL_VELOCITY_X,
+    HELIGOLAND_OBS_SHELL_VELOCITY_Y,
+    HELIGOLAND_OBS_SHELL_SIZE,
+    HELIGOLAND_OBS_SHELLS = 8
+};
+
+enum
+{
+    HELIGOLAND_OBS_SIZE = HELIGOLAND_OBS_SELF_SIZE
+                          + HELIGOLAND_OBS_OTHER_SHIPS * HELIGOLAND_OBS_SHIP_SIZE
+                          + HELIGOLAND_OBS_SHELLS * HELIGOLAND_OBS_SHELL_SIZE
+};
+
+typedef struct HeligolandEnvSettings
+{
+    int numArenas;              // Default 64
+    int agentsPerArena;         // Default 1, at most the mode's ship count
+    int mode;                   // 0 FFA, 1 teams, 2 duel (default), 3 triple, 4 battle
+    int numThreads;             // 0 = one per core
+    int ticksPerStep;           // Physics ticks each action is held for, default 4
+    float maxEpisodeTime;       // Seconds of game time before an episode is called a draw, default 300
+    uint64_t seed;              // Episode e of arena i is seeded seed + e * numArenas + i
+    const char* configJson;     // Optional overrides laid out like config.json, NULL for none
+} HeligolandEnvSettings;
+
+typedef struct HeligolandEnv HeligolandEnv;
+
+// Fills in the defaults
+HELIGOLAND_ENV_API void heligoland_env_default_settings (HeligolandEnvSettings* settings);
+
+// Returns NULL if the settings or config overrides are invalid, or if there are
+// overrides and another environment still exists
+HELIGOLAND_ENV_API HeligolandEnv* heligoland_env_create (const HeligolandEnvSettings* settings);
+HELIGOLAND_ENV_API void heligoland_env_destroy (HeligolandEnv* env);
+
+HELIGOLAND_ENV_API int heligoland_env_num_agents (const HeligolandEnv* env);
+
+// Starts a new episode in every arena. observations: HELIGOLAND_OBS_SIZE * numAgents floats
+HELIGOLAND_ENV_API void heligoland_env_reset (HeligolandEnv* env, float* observations);
+
+// Applies one action per agent (HELIGOLAND_ACTION_SIZE * numAgents floats) and
+// advances every arena ticksPerStep ticks. rewards gets damage dealt minus
+// damage taken, in units of a ship's base health, plus 1 for a win or -1 for a
+// loss at the end of an episode. An arena whose episode ended sets dones to 1
+// for its agents and starts the next episode, so its observations are already
+// the first of the new one.
+HELIGOLAND_ENV_API void heligoland_env_step (HeligolandEnv* env, const float* actions, float* observations,
+                                             float* rewards, uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,8 +2,8 @@
 #include <algorithm>
 #include <cmath>
 
-Island::Island (Vec2 center_, float baseRadius, unsigned int seed)
-    : center (center_)
+Island::Island (Vec2 center_, float baseRadius, unsigned int seed, std::pmr::memory_resource* memory)
+    : center (center_), vertices (memory)
 {
     generateShape (baseRadius, seed);
 }
@@ -16,7 +16,7 @@ void Island::generateShape (float baseRadius, unsigned int seed)
         return ((seed >> 16) & 0x7FFF) / 32767.0f;
     };
 
-    int numVertices = 32 + (int) (nextRandom() * 16); // 32-48 vertices
+    int numVertices = 32 + (int) (nextRandom() * 16); // 32-48 vertices, at most MAX_VERTICES
     float angleStep = 2.0f * (float) pi / numVertices;
 
     // Generate variation parameters for organic shape
@@ -1,16 +1,23 @@
 #pragma once
 
 #include "Vec2.h"
+#include <memory_resource>
 #include <vector>
 
 class Island
 {
 public:
-    Island (Vec2 center, float baseRadius, unsigned int seed);
+    static constexpr int MAX_VERTICES = 48;
+
+    // The outline is allocated from memory
+    Island (Vec2 center, float baseRadius, unsigned int seed, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+    // What an island's outline takes from its memory resource at most
+    static size_t getMatchMemorySize()  { return MAX_VERTICES * sizeof (Vec2) + alignof (Vec2); }
 
     Vec2 getCenter() const { return center; }
     float getBoundingRadius() const { return boundingRadius; }
-    const std::vector<Vec2>& getVertices() const { return vertices; }
+    const std::pmr::vector<Vec2>& getVertices() const { return vertices; }
 
     bool containsPoint (Vec2 point) const;
     bool getCollisionResponse (Vec2 point, Vec2& pushDirection, float& pushDistance) const;
@@ -18,7 +25,7 @@ public:
 private:
     Vec2 center;
     float boundingRadius = 0.0f;
-    std::vector<Vec2> vertices;
+    std::pmr::vector<Vec2> vertices;
 
     void generateShape (float baseRadius, unsigned int seed);
 };
@@ -0,0 +1,48 @@
+#include "MatchArena.h"
+#include <algorithm>
+
+void MatchArena::reset (size_t minimumSize)
+{
+    // used counts alignment padding too, so a block this size holds the same allocations again
+    size_t needed = std::max (minimumSize, used);
+    if (needed > capacity)
+    {
+        block = std::make_unique<std::byte[]> (needed);
+        capacity = needed;
+        heapAllocations++;
+    }
+
+    overflow.clear();
+    used = 0;
+    current = block.get();
+    currentSize = capacity;
+    currentUsed = 0;
+}
+
+void* MatchArena::do_allocate (size_t bytes, size_t alignment)
+{
+    void* memory = current + currentUsed;
+    size_t space = currentSize - currentUsed;
+
+    if (current == nullptr || std::align (alignment, bytes, memory, space) == nullptr)
+    {
+        // Out of room: a heap block at least as big as the last, kept until the next reset
+        size_t size = std::max ({ bytes + alignment, currentSize, (size_t) 4096 });
+        overflow.push_back (std::make_unique<std::byte[]> (size));
+        heapAllocations++;
+
+        used += currentSize - currentUsed;
+        current = overflow.back().get();
+        currentSize = size;
+        currentUsed = 0;
+
+        memory = current;
+        space = size;
+        std::align (alignment, bytes, memory, space);
+    }
+
+    size_t end = currentSize - space + bytes;
+    used += end - currentUsed;
+    currentUsed = end;
+    return memory;
+}
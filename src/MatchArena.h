@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// =============================================================================
+// MatchArena
+// Memory that lives exactly as long as one match: the ships with their shell,
+// hit and particle buffers, and the islands. Allocations are carved off one
+// block and never freed individually; reset() drops the lot at once. When a
+// match needs more than the block holds the extra comes from the heap, and the
+// next reset folds it into a single bigger block, so a world running match
+// after match settles on one allocation and stops touching the heap.
+// =============================================================================
+
+class MatchArena : public std::pmr::memory_resource
+{
+public:
+    // Destroys without freeing, the memory goes back with the next reset()
+    struct Deleter
+    {
+        template <typename T>
+        void operator() (T* object) const   { object->~T(); }
+    };
+
+    template <typename T>
+    using Ptr = std::unique_ptr<T, Deleter>;
+
+    MatchArena() = default;
+    MatchArena (const MatchArena&) = delete;
+    MatchArena& operator= (const MatchArena&) = delete;
+
+    template <typename T, typename... Args>
+    Ptr<T> make (Args&&... args)
+    {
+        void* memory = allocate (sizeof (T), alignof (T));
+        return Ptr<T> (new (memory) T (std::forward<Args> (args)...));
+    }
+
+    // Forgets every allocation, growing the block to at least minimumSize and to
+    // whatever the last match used. Everything made from the arena must be gone
+    void reset (size_t minimumSize);
+
+    size_t getCapacity() const              { return capacity; }     // The main block
+    size_t getUsed() const                  { return used; }         // Since the last reset, including overflow
+    size_t getNumHeapAllocations() const    { return heapAllocations; }  // Over the arena's lifetime
+
+private:
+    std::unique_ptr<std::byte[]> block;
+    size_t capacity = 0;
+    size_t used = 0;
+
+    // Where allocations currently come from: the main block, or the last overflow
+    std::byte* current = nullptr;
+    size_t currentSize = 0;
+    size_t currentUsed = 0;
+
+    std::vector<std::unique_ptr<std::byte[]>> overflow;
+    size_t heapAllocations = 0;
+
+    void* do_allocate (size_t bytes, size_t alignment) override;
+    void do_deallocate (void*, size_t, size_t) override {}
+    bool do_is_equal (const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
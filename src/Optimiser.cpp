@@ -0,0 +1,294 @@
+#include "Optimiser.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+    struct Parameter
+    {
+        const char* name;
+        float AIParams::*value;
+        float min;
+        float max;
+    };
+
+    // Ranges the optimiser searches. Each contains its default
+    const Parameter parameters[] = {
+        { "scaredHealth",             &AIParams::scaredHealth,            0.0f,  0.6f },
+        { "aggressiveHealthRatio",    &AIParams::aggressiveHealthRatio,   0.0f,  1.0f },
+        { "aggressiveRange",          &AIParams::aggressiveRange,         0.2f,  1.0f },
+        { "crowdedRange",             &AIParams::crowdedRange,            0.3f,  1.2f },
+        { "broadsideRange",           &AIParams::broadsideRange,          0.5f,  1.2f },
+        { "exposedRange",             &AIParams::exposedRange,            0.7f,  1.5f },
+        { "rangeTolerance",           &AIParams::rangeTolerance,          5.0f,  150.0f },
+        { "dodgeHorizon",             &AIParams::dodgeHorizon,            0.25f, 5.0f },
+        { "crosshairToleranceScale",  &AIParams::crosshairToleranceScale, 0.25f, 3.0f },
+        { "lookAheadScale",           &AIParams::lookAheadScale,          0.0f,  2.0f },
+        { "personalityMin",           &AIParams::personalityMin,          0.8f,  1.0f },
+        { "personalityMax",           &AIParams::personalityMax,          1.0f,  1.2f },
+    };
+
+    constexpr int numParameters = (int) std::size (parameters);
+
+    std::vector<float> toUnit (const AIParams& params)
+    {
+        std::vector<float> unit;
+        for (const auto& p : parameters)
+            unit.push_back (std::clamp ((params.*p.value - p.min) / (p.max - p.min), 0.0f, 1.0f));
+        return unit;
+    }
+
+    AIParams fromUnit (const std::vector<float>& unit)
+    {
+        AIParams params;
+        for (int i = 0; i < numParameters; ++i)
+            params.*parameters[i].value = parameters[i].min + std::clamp (unit[i], 0.0f, 1.0f) * (parameters[i].max - parameters[i].min);
+        return params;
+    }
+
+    float nextGaussian (Random& random)
+    {
+        // Box-Muller. 1 - nextFloat() is never 0, so the log is finite
+        float u = 1.0f - random.nextFloat();
+        float v = random.nextFloat();
+        return std::sqrt (-2.0f * std::log (u)) * std::cos (2.0f * 3.14159265f * v);
+    }
+
+    int getNumSides (GameMode mode)
+    {
+        bool isTeamMode = (mode == GameMode::Teams || mode == GameMode::Battle);
+        return isTeamMode ? 2 : World::getNumShipsForMode (mode);
+    }
+
+    int getSide (GameMode mode, int shipIndex)
+    {
+        bool isTeamMode = (mode == GameMode::Teams || mode == GameMode::Battle);
+        return isTeamMode ? World::getTeamForMode (mode, shipIndex) : shipIndex;
+    }
+
+    // Match m puts the player on side m % numSides, so each seed is played from every side
+    void addMatches (std::vector<MatchSpec>& specs, const AIParams& player, const AIParams& opponent, GameMode mode,
+                     int numMatches, uint64_t seed, float maxMatchTime)
+    {
+        int numSides = getNumSides (mode);
+        for (int m = 0; m < numMatches; ++m)
+        {
+            MatchSpec spec;
+            spec.mode = mode;
+            spec.seed = seed + (uint64_t) (m / numSides);
+            spec.maxMatchTime = maxMatchTime;
+
+            for (int i = 0; i < World::MAX_SHIPS; ++i)
+                spec.aiParams[i] = getSide (mode, i) == m % numSides ? player : opponent;
+
+            specs.push_back (spec);
+        }
+    }
+
+    void addResults (Candidate& candidate, const MatchResult* results, int numMatches)
+    {
+        int numSides = getNumSides (results[0].mode);
+        for (int m = 0; m < numMatches; ++m)
+        {
+            if (results[m].winnerIndex < 0)
+                candidate.draws++;
+            else if (results[m].winnerIndex == m % numSides)
+                candidate.wins++;
+            else
+                candidate.losses++;
+        }
+    }
+
+    // Whole rounds, so every side is played equally often
+    int roundToSides (int numMatches, GameMode mode)
+    {
+        int numSides = getNumSides (mode);
+        return std::max (1, (numMatches + numSides - 1) / numSides) * numSides;
+    }
+}
+
+Optimiser::Optimiser (BatchRunner& runner_, const OptimiserSettings& settings_, const AIParams& start)
+    : runner (runner_), settings (settings_), random (settings_.seed, 0)
+{
+    settings.populationSize = std::max (2, settings.populationSize);
+    if (settings.numParents <= 0 || settings.numParents > settings.populationSize)
+        settings.numParents = std::max (1, settings.populationSize / 2);
+    settings.matchesPerCandidate = roundToSides (settings.matchesPerCandidate, settings.mode);
+
+    mean = toUnit (start);
+    scales.assign ((size_t) numParameters, 1.0f);
+    stepSize = settings.initialStepSize;
+}
+
+AIParams Optimiser::getMean() const
+{
+    return fromUnit (mean);
+}
+
+void Optimiser::runGeneration()
+{
+    const AIParams opponent;
+    int numMatches = settings.matchesPerCandidate;
+    uint64_t seed = settings.seed + (uint64_t) generation * (uint64_t) numMatches;
+
+    // Sample the population, remembering each one's step in unit-normal terms
+    std::vector<std::vector<float>> steps ((size_t) settings.populationSize);
+    std::vector<std::vector<float>> points ((size_t) settings.populationSize);
+    for (size_t c = 0; c < points.size(); ++c)
+    {
+        for (int i = 0; i < numParameters; ++i)
+        {
+            float z = nextGaussian (random);
+            steps[c].push_back (z);
+            points[c].push_back (std::clamp (mean[(size_t) i] + stepSize * scales[(size_t) i] * z, 0.0f, 1.0f));
+        }
+    }
+
+    // The mean plays too, as the bar the candidates have to clear. All in one batch
+    std::vector<MatchSpec> specs;
+    addMatches (specs, getMean(), opponent, settings.mode, numMatches, seed, settings.maxMatchTime);
+    for (const auto& point : points)
+        addMatches (specs, fromUnit (point), opponent, settings.mode, numMatches, seed, settings.maxMatchTime);
+
+    auto results = runner.run (specs);
+
+    meanResult = {};
+    meanResult.params = getMean();
+    addResults (meanResult, results.data(), numMatches);
+
+    candidates.assign (points.size(), {});
+    for (size_t c = 0; c < points.size(); ++c)
+    {
+        candidates[c].params = fromUnit (points[c]);
+        addResults (candidates[c], results.data() + (c + 1) * (size_t) numMatches, numMatches);
+    }
+
+    std::vector<size_t> order (points.size());
+    for (size_t c = 0; c < order.size(); ++c)
+        order[c] = c;
+    std::stable_sort (order.begin(), order.end(), [&] (size_t a, size_t b)
+                      { return candidates[a].getScore() > candidates[b].getScore(); });
+
+    // Log-decreasing weights over the best numParents
+    int mu = settings.numParents;
+    std::vector<float> weights ((size_t) mu);
+    float weightSum = 0.0f;
+    for (int k = 0; k < mu; ++k)
+    {
+        weights[(size_t) k] = std::log (mu + 0.5f) - std::log (k + 1.0f);
+        weightSum += weights[(size_t) k];
+    }
+    for (auto& w : weights)
+        w /= weightSum;
+
+    // Move the mean to the weighted parents, and stretch each parameter's step
+    // size towards the spread of the steps that won
+    const float scaleRate = 0.2f;
+    for (int i = 0; i < numParameters; ++i)
+    {
+        float newMean = 0.0f;
+        float variance = 0.0f;
+        for (int k = 0; k < mu; ++k)
+        {
+            size_t c = order[(size_t) k];
+            newMean += weights[(size_t) k] * points[c][(size_t) i];
+            variance += weights[(size_t) k] * steps[c][(size_t) i] * steps[c][(size_t) i];
+        }
+
+        mean[(size_t) i] = newMean;
+        scales[(size_t) i] = std::clamp (scales[(size_t) i] * std::sqrt (1.0f - scaleRate + scaleRate * variance), 0.1f, 3.0f);
+    }
+
+    // One-fifth rule: grow the steps while plenty of candidates beat the mean, shrink them when few do
+    int numBetter = 0;
+    for (const auto& candidate : candidates)
+        if (candidate.getScore() > meanResult.getScore())
+            numBetter++;
+
+    float successRate = (float) numBetter / (float) candidates.size();
+    stepSize = std::clamp (stepSize * std::exp ((successRate - 0.2f) / 0.8f * 0.5f), 0.01f, 0.5f);
+
+    std::vector<Candidate> sorted;
+    for (size_t c : order)
+        sorted.push_back (candidates[c]);
+    candidates = std::move (sorted);
+
+    generation++;
+}
+
+Candidate Optimiser::evaluate (BatchRunner& runner, const AIParams& params, const AIParams& opponent, GameMode mode,
+                               int numMatches, uint64_t seed, float maxMatchTime)
+{
+    numMatches = roundToSides (numMatches, mode);
+
+    std::vector<MatchSpec> specs;
+    addMatches (specs, params, opponent, mode, numMatches, seed, maxMatchTime);
+
+    Candidate candidate;
+    candidate.params = params;
+    addResults (candidate, runner.run (specs).data(), numMatches);
+    return candidate;
+}
+
+int Optimiser::getNumParameters()
+{
+    return numParameters;
+}
+
+const char* Optimiser::getParameterName (int index)
+{
+    return parameters[index].name;
+}
+
+float Optimiser::getParameter (const AIParams& params, int index)
+{
+    return params.*parameters[index].value;
+}
+
+bool Optimiser::saveParams (const std::string& path, const AIParams& params)
+{
+    nlohmann::json j = nlohmann::json::object();
+    for (const auto& p : parameters)
+        j[p.name] = params.*p.value;
+
+    std::ofstream file (path);
+    if (! file)
+        return false;
+
+    file << j.dump (2) << "\n";
+    return (bool) file;
+}
+
+bool Optimiser::loadParams (const std::string& path, AIParams& params, std::string& error)
+{
+    std::ifstream file (path);
+    if (! file.is_open())
+    {
+        error = "couldn't open " + path;
+        return false;
+    }
+
+    nlohmann::json j = nlohmann::json::parse (file, nullptr, false);
+    if (! j.is_object())
+    {
+        error = path + " isn't a JSON object of AI parameters";
+        return false;
+    }
+
+    for (const auto& p : parameters)
+    {
+        if (! j.contains (p.name))
+            continue;
+
+        if (! j[p.name].is_number())
+        {
+            error = std::string ("AI parameter ") + p.name + " isn't a number";
+            return false;
+        }
+        params.*p.value = j[p.name].get<float>();
+    }
+
+    return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "AIController.h"
+#include "Batch.h"
+#include "Random.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// Optimiser
+// Evolves AIParams that beat the default AI. Each generation samples candidates
+// around a mean, scores every one by playing seeded AI-only matches against
+// the default AI on a BatchRunner (so all cores, no window), and moves the mean
+// towards the winners. It's a diagonal evolution strategy: CMA-ES with the
+// covariance cut down to one step size per parameter and the evolution paths
+// left out, which is plenty for a dozen noisy parameters.
+// =============================================================================
+
+struct OptimiserSettings
+{
+    int populationSize = 16;            // Candidates per generation, not counting the mean
+    int numParents = 0;                 // Best candidates the mean moves towards, 0 = half the population
+    int matchesPerCandidate = 40;       // Split evenly between the sides
+    GameMode mode = GameMode::Duel;
+    float maxMatchTime = 300.0f;
+    float initialStepSize = 0.2f;       // Fraction of each parameter's range
+    uint64_t seed = 0;                  // Matches and mutations both follow from this
+};
+
+struct Candidate
+{
+    AIParams params;
+    int wins = 0;
+    int losses = 0;
+    int draws = 0;
+
+    int getNumMatches() const   { return wins + losses + draws; }
+    double getScore() const     { return getNumMatches() > 0 ? (wins + 0.5 * draws) / getNumMatches() : 0.0; }
+};
+
+class Optimiser
+{
+public:
+    Optimiser (BatchRunner& runner, const OptimiserSettings& settings, const AIParams& start = {});
+
+    // Samples, plays and scores one generation, then updates the mean. Every
+    // candidate in a generation plays the same seeds; each generation gets new ones
+    void runGeneration();
+
+    int getGeneration() const                           { return generation; }
+    float getStepSize() const                           { return stepSize; }
+
+    // The current mean, which is the optimiser's answer so far
+    AIParams getMean() const;
+
+    // The last generation's candidates, best first, and how the mean it was
+    // sampled around did on the same seeds
+    const std::vector<Candidate>& getCandidates() const { return candidates; }
+    const Candidate& getMeanResult() const              { return meanResult; }
+
+    // Plays params against opponent over matches seeded seed, seed + 1, ...,
+    // params taking each side in turn
+    static Candidate evaluate (BatchRunner& runner, const AIParams& params, const AIParams& opponent, GameMode mode,
+                               int numMatches, uint64_t seed, float maxMatchTime);
+
+    // The values the optimiser varies, in vector order
+    static int getNumParameters();
+    static const char* getParameterName (int index);
+    static float getParameter (const AIParams& params, int index);
+
+    // Read / write a set of params as a JSON object keyed by parameter name.
+    // Missing keys keep their defaults
+    static bool saveParams (const std::string& path, const AIParams& params);
+    static bool loadParams (const std::string& path, AIParams& params, std::string& error);
+
+private:
+    BatchRunner& runner;
+    OptimiserSettings settings;
+
+    // Kept in the unit cube: 0 and 1 are the ends of each parameter's range
+    std::vector<float> mean;
+    std::vector<float> scales;  // Per parameter, relative to stepSize
+    float stepSize = 0.2f;
+
+    int generation = 0;
+    std::vector<Candidate> candidates;
+    Candidate meanResult;
+    Random random;  // Mutations
+};
@@ -0,0 +1,229 @@
+#include "ParticleKernels.h"
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define HELIGOLAND_X86 1
+  #include <immintrin.h>
+  #if defined(_MSC_VER) && ! defined(__clang__)
+    #include <intrin.h>
+    #define HELIGOLAND_TARGET_AVX2
+  #else
+    #define HELIGOLAND_TARGET_AVX2 __attribute__ ((target ("avx2")))
+  #endif
+#endif
+
+// Every version works through the same expression with the same rounding, and the
+// vector loops hand whatever is left over (fewer than one vector) to the scalar one
+
+namespace
+{
+    namespace Scalar
+    {
+        void fade (float* alpha, const float* fadeRate, int count, float dt)
+        {
+            for (int i = 0; i < count; ++i)
+                alpha[i] -= fadeRate[i] * dt;
+        }
+
+        int findAtOrBelow (const float* values, int begin, int end, float limit)
+        {
+            for (int i = begin; i < end; ++i)
+                if (values[i] <= limit)
+                    return i;
+            return end;
+        }
+
+        void placeSmokeRange (const ParticleKernels::SmokeInputs& s, int begin, int end, float* x, float* y, float* alpha)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                float dx = (s.windTravel.x - s.windX[i]) * s.windStrength;
+                float dy = (s.windTravel.y - s.windY[i]) * s.windStrength;
+                x[i] = s.spawnX[i] + (dx * s.driftCos[i] - dy * s.driftSin[i]);
+                y[i] = s.spawnY[i] + (dx * s.driftSin[i] + dy * s.driftCos[i]);
+                alpha[i] = s.spawnAlpha[i] - s.fadeRate[i] * (s.time - s.spawnTime[i]);
+            }
+        }
+
+        void placeSmoke (const ParticleKernels::SmokeInputs& s, int count, float* x, float* y, float* alpha)
+        {
+            placeSmokeRange (s, 0, count, x, y, alpha);
+        }
+    }
+
+#if HELIGOLAND_X86
+    namespace SSE2
+    {
+        void fade (float* alpha, const float* fadeRate, int count, float dt)
+        {
+            __m128 step = _mm_set1_ps (dt);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 a = _mm_loadu_ps (alpha + i);
+                a = _mm_sub_ps (a, _mm_mul_ps (_mm_loadu_ps (fadeRate + i), step));
+                _mm_storeu_ps (alpha + i, a);
+            }
+            Scalar::fade (alpha + i, fadeRate + i, count - i, dt);
+        }
+
+        int findAtOrBelow (const float* values, int begin, int end, float limit)
+        {
+            __m128 threshold = _mm_set1_ps (limit);
+            int i = begin;
+            for (; i + 4 <= end; i += 4)
+            {
+                int mask = _mm_movemask_ps (_mm_cmple_ps (_mm_loadu_ps (values + i), threshold));
+                if (mask != 0)
+                    return i + std::countr_zero ((unsigned) mask);
+            }
+            return Scalar::findAtOrBelow (values, i, end, limit);
+        }
+
+        void placeSmoke (const ParticleKernels::SmokeInputs& s, int count, float* x, float* y, float* alpha)
+        {
+            __m128 travelX = _mm_set1_ps (s.windTravel.x);
+            __m128 travelY = _mm_set1_ps (s.windTravel.y);
+            __m128 strength = _mm_set1_ps (s.windStrength);
+            __m128 time = _mm_set1_ps (s.time);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 dx = _mm_mul_ps (_mm_sub_ps (travelX, _mm_loadu_ps (s.windX + i)), strength);
+                __m128 dy = _mm_mul_ps (_mm_sub_ps (travelY, _mm_loadu_ps (s.windY + i)), strength);
+                __m128 c = _mm_loadu_ps (s.driftCos + i);
+                __m128 sn = _mm_loadu_ps (s.driftSin + i);
+                __m128 offsetX = _mm_sub_ps (_mm_mul_ps (dx, c), _mm_mul_ps (dy, sn));
+                __m128 offsetY = _mm_add_ps (_mm_mul_ps (dx, sn), _mm_mul_ps (dy, c));
+                _mm_storeu_ps (x + i, _mm_add_ps (_mm_loadu_ps (s.spawnX + i), offsetX));
+                _mm_storeu_ps (y + i, _mm_add_ps (_mm_loadu_ps (s.spawnY + i), offsetY));
+
+                __m128 age = _mm_sub_ps (time, _mm_loadu_ps (s.spawnTime + i));
+                __m128 faded = _mm_mul_ps (_mm_loadu_ps (s.fadeRate + i), age);
+                _mm_storeu_ps (alpha + i, _mm_sub_ps (_mm_loadu_ps (s.spawnAlpha + i), faded));
+            }
+            Scalar::placeSmokeRange (s, i, count, x, y, alpha);
+        }
+    }
+
+    // Built for AVX2 whatever the compiler flags, and only called once the CPU is known to have it
+    namespace AVX2
+    {
+        HELIGOLAND_TARGET_AVX2 void fade (float* alpha, const float* fadeRate, int count, float dt)
+        {
+            __m256 step = _mm256_set1_ps (dt);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 a = _mm256_loadu_ps (alpha + i);
+                a = _mm256_sub_ps (a, _mm256_mul_ps (_mm256_loadu_ps (fadeRate + i), step));
+                _mm256_storeu_ps (alpha + i, a);
+            }
+            Scalar::fade (alpha + i, fadeRate + i, count - i, dt);
+        }
+
+        HELIGOLAND_TARGET_AVX2 int findAtOrBelow (const float* values, int begin, int end, float limit)
+        {
+            __m256 threshold = _mm256_set1_ps (limit);
+            int i = begin;
+            for (; i + 8 <= end; i += 8)
+            {
+                int mask = _mm256_movemask_ps (_mm256_cmp_ps (_mm256_loadu_ps (values + i), threshold, _CMP_LE_OQ));
+                if (mask != 0)
+                    return i + std::countr_zero ((unsigned) mask);
+            }
+            return Scalar::findAtOrBelow (values, i, end, limit);
+        }
+
+        HELIGOLAND_TARGET_AVX2 void placeSmoke (const ParticleKernels::SmokeInputs& s, int count, float* x, float* y, float* alpha)
+        {
+            __m256 travelX = _mm256_set1_ps (s.windTravel.x);
+            __m256 travelY = _mm256_set1_ps (s.windTravel.y);
+            __m256 strength = _mm256_set1_ps (s.windStrength);
+            __m256 time = _mm256_set1_ps (s.time);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 dx = _mm256_mul_ps (_mm256_sub_ps (travelX, _mm256_loadu_ps (s.windX + i)), strength);
+                __m256 dy = _mm256_mul_ps (_mm256_sub_ps (travelY, _mm256_loadu_ps (s.windY + i)), strength);
+                __m256 c = _mm256_loadu_ps (s.driftCos + i);
+                __m256 sn = _mm256_loadu_ps (s.driftSin + i);
+                __m256 offsetX = _mm256_sub_ps (_mm256_mul_ps (dx, c), _mm256_mul_ps (dy, sn));
+                __m256 offsetY = _mm256_add_ps (_mm256_mul_ps (dx, sn), _mm256_mul_ps (dy, c));
+                _mm256_storeu_ps (x + i, _mm256_add_ps (_mm256_loadu_ps (s.spawnX + i), offsetX));
+                _mm256_storeu_ps (y + i, _mm256_add_ps (_mm256_loadu_ps (s.spawnY + i), offsetY));
+
+                __m256 age = _mm256_sub_ps (time, _mm256_loadu_ps (s.spawnTime + i));
+                __m256 faded = _mm256_mul_ps (_mm256_loadu_ps (s.fadeRate + i), age);
+                _mm256_storeu_ps (alpha + i, _mm256_sub_ps (_mm256_loadu_ps (s.spawnAlpha + i), faded));
+            }
+            Scalar::placeSmokeRange (s, i, count, x, y, alpha);
+        }
+    }
+
+    bool cpuHasAVX2()
+    {
+      #if defined(_MSC_VER) && ! defined(__clang__)
+        // The CPU has to have it and the OS has to save the YMM registers
+        int info[4];
+        __cpuid (info, 0);
+        if (info[0] < 7)
+            return false;
+
+        __cpuid (info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv (0) & 6) == 6;
+
+        __cpuidex (info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5)) != 0;
+      #else
+        return __builtin_cpu_supports ("avx2");
+      #endif
+    }
+#endif
+
+    constexpr ParticleKernels::Kernels kernels[] = {
+        { Scalar::fade, Scalar::findAtOrBelow, Scalar::placeSmoke },
+#if HELIGOLAND_X86
+        { SSE2::fade, SSE2::findAtOrBelow, SSE2::placeSmoke },
+        { AVX2::fade, AVX2::findAtOrBelow, AVX2::placeSmoke },
+#endif
+    };
+}
+
+ParticleKernels::Isa ParticleKernels::getBestIsa()
+{
+#if HELIGOLAND_X86
+    static const Isa best = cpuHasAVX2() ? Isa::AVX2 : Isa::SSE2;
+    return best;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+bool ParticleKernels::isSupported (Isa isa)
+{
+    return isa <= getBestIsa();
+}
+
+const char* ParticleKernels::getIsaName (Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::Scalar:   return "scalar";
+        case Isa::SSE2:     return "sse2";
+        case Isa::AVX2:     return "avx2";
+        case Isa::numIsas:  break;
+    }
+    return "?";
+}
+
+const ParticleKernels::Kernels& ParticleKernels::get()
+{
+    static const Kernels& best = get (getBestIsa());
+    return best;
+}
+
+const ParticleKernels::Kernels& ParticleKernels::get (Isa isa)
+{
+    return kernels[(size_t) isa];
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Vec2.h"
+
+// =============================================================================
+// ParticleKernels
+// The per-particle loops behind ParticlePool and the smoke drawing, over its
+// field-by-field arrays. Each kernel has a plain C++ version and, on x86-64,
+// SSE2 and AVX2 versions that do 4 or 8 particles at a time. The best one the
+// CPU supports is picked on first use. The vector versions do the same
+// operations in the same order, with no fused multiply-adds, so all of them
+// give bit-identical results (checked by --check-kernels).
+// =============================================================================
+
+namespace ParticleKernels
+{
+    enum class Isa
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        numIsas
+    };
+
+    // The inputs for placing smoke puffs, see ParticlePool::Smoke
+    struct SmokeInputs
+    {
+        const float* spawnX = nullptr;
+        const float* spawnY = nullptr;
+        const float* windX = nullptr;
+        const float* windY = nullptr;
+        const float* driftCos = nullptr;
+        const float* driftSin = nullptr;
+        const float* spawnAlpha = nullptr;
+        const float* fadeRate = nullptr;
+        const float* spawnTime = nullptr;
+        Vec2 windTravel;            // Now, or between steps when interpolating
+        float windStrength = 0.0f;
+        float time = 0.0f;
+    };
+
+    struct Kernels
+    {
+        // alpha[i] -= fadeRate[i] * dt
+        void (*fade) (float* alpha, const float* fadeRate, int count, float dt);
+
+        // The first i in [begin, end) with values[i] <= limit, or end if there isn't one
+        int (*findAtOrBelow) (const float* values, int begin, int end, float limit);
+
+        // Each puff's position (spawn point plus its turned share of the wind travel since) and alpha
+        void (*placeSmoke) (const SmokeInputs& smoke, int count, float* x, float* y, float* alpha);
+    };
+
+    Isa getBestIsa();               // The fastest this CPU runs
+    bool isSupported (Isa isa);
+    const char* getIsaName (Isa isa);
+
+    const Kernels& get();           // For the best ISA
+    const Kernels& get (Isa isa);   // Must be supported
+}
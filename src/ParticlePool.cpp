@@ -0,0 +1,257 @@
+#include "ParticlePool.h"
+#include "Config.h"
+#include "ParticleKernels.h"
+#include <algorithm>
+#include <cmath>
+
+void ParticlePool::configure()
+{
+    budgets[(size_t) Kind::Splash].capacity = std::max (0, config.particleMaxExplosions);
+    budgets[(size_t) Kind::Explosion].capacity = std::max (0, config.particleMaxExplosions);
+    bubbleBudget.capacity = std::max (0, config.particleMaxBubbles);
+    smokeBudget.capacity = std::max (0, config.particleMaxSmoke);
+
+    for (size_t k = 0; k < numKinds; ++k)
+    {
+        Particles& p = kinds[k];
+        size_t size = (size_t) budgets[k].capacity;
+        if (p.x.size() >= size)
+            continue;
+
+        for (auto* column : { &p.x, &p.y, &p.radius, &p.alpha, &p.fadeRate })
+            column->resize (size);
+        p.emitter.resize (size);
+    }
+
+    size_t ringSize = (size_t) bubbleBudget.capacity;
+    if (bubbles.x.size() < ringSize)
+    {
+        for (auto* column : { &bubbles.x, &bubbles.y, &bubbles.radius, &bubbles.spawnTime })
+            column->resize (ringSize);
+        bubbles.emitter.resize (ringSize);
+    }
+
+    size_t smokeSize = (size_t) smokeBudget.capacity;
+    if (smoke.spawnX.size() < smokeSize)
+    {
+        for (auto* column : { &smoke.spawnX, &smoke.spawnY, &smoke.windX, &smoke.windY, &smoke.driftCos, &smoke.driftSin,
+                              &smoke.radius, &smoke.spawnAlpha, &smoke.fadeRate, &smoke.spawnTime, &smoke.expiryTime })
+            column->resize (smokeSize);
+        smoke.emitter.resize (smokeSize);
+    }
+
+    clear();
+}
+
+void ParticlePool::clear()
+{
+    for (auto& p : kinds)
+        p.count = 0;
+
+    for (auto& budget : budgets)
+    {
+        budget.emitterCounts = {};
+        budget.spawnCredit = 0.0f;
+    }
+
+    bubbles.first = 0;
+    bubbles.count = 0;
+    bubbleBudget.emitterCounts = {};
+    bubbleBudget.spawnCredit = 0.0f;
+
+    smoke.count = 0;
+    smokeBudget.emitterCounts = {};
+    smokeBudget.spawnCredit = 0.0f;
+
+    time = 0.0f;
+    windTravel = {};
+    prevWindTravel = {};
+    numDropped = 0;
+}
+
+bool ParticlePool::admit (Budget& budget, int count, int emitter)
+{
+    // Everything goes through up to the throttle point, then less and less until none at the limit
+    auto getSpawnRate = [] (int used, int limit)
+    {
+        float start = limit * std::clamp (config.particleThrottleStart, 0.0f, 1.0f);
+        if (used < start)
+            return 1.0f;
+        if (used >= limit)
+            return 0.0f;
+        return (limit - used) / (limit - start);
+    };
+
+    float rate = getSpawnRate (count, budget.capacity);
+    if (emitter != noEmitter)
+    {
+        int emitterLimit = std::max (1, (int) (budget.capacity * config.particleEmitterShare));
+        rate = std::min (rate, getSpawnRate (budget.emitterCounts[emitter], emitterLimit));
+    }
+
+    if (rate < 1.0f)
+    {
+        budget.spawnCredit += rate;
+        if (budget.spawnCredit < 1.0f)
+        {
+            numDropped++;
+            return false;
+        }
+        budget.spawnCredit -= 1.0f;
+    }
+
+    if (emitter != noEmitter)
+        budget.emitterCounts[emitter]++;
+    return true;
+}
+
+bool ParticlePool::spawn (Kind kind, int emitter, const Spawn& particle)
+{
+    Particles& p = kinds[(size_t) kind];
+    if (! admit (budgets[(size_t) kind], p.count, emitter))
+        return false;
+
+    int i = p.count++;
+    p.x[i] = particle.position.x;
+    p.y[i] = particle.position.y;
+    p.radius[i] = particle.radius;
+    p.alpha[i] = particle.alpha;
+    p.fadeRate[i] = particle.fadeRate;
+    p.emitter[i] = (int8_t) emitter;
+    return true;
+}
+
+bool ParticlePool::spawnBubble (int emitter, Vec2 position, float radius)
+{
+    if (! admit (bubbleBudget, bubbles.count, emitter))
+        return false;
+
+    // The newest goes on the end of the ring
+    int i = bubbles.getIndex (bubbles.count++);
+    bubbles.x[i] = position.x;
+    bubbles.y[i] = position.y;
+    bubbles.radius[i] = radius;
+    bubbles.spawnTime[i] = time;
+    bubbles.emitter[i] = (int8_t) emitter;
+    return true;
+}
+
+bool ParticlePool::spawnSmoke (int emitter, const Spawn& puff)
+{
+    if (! admit (smokeBudget, smoke.count, emitter))
+        return false;
+
+    // Everything needed to place it later, so it's never touched again until it expires
+    int i = smoke.count++;
+    smoke.spawnX[i] = puff.position.x;
+    smoke.spawnY[i] = puff.position.y;
+    smoke.windX[i] = windTravel.x;
+    smoke.windY[i] = windTravel.y;
+    smoke.driftCos[i] = std::cos (puff.driftAngle);
+    smoke.driftSin[i] = std::sin (puff.driftAngle);
+    smoke.radius[i] = puff.radius;
+    smoke.spawnAlpha[i] = puff.alpha;
+    smoke.fadeRate[i] = puff.fadeRate;
+    smoke.spawnTime[i] = time;
+    smoke.expiryTime[i] = time + puff.alpha / puff.fadeRate;
+    smoke.emitter[i] = (int8_t) emitter;
+    return true;
+}
+
+float ParticlePool::getBubbleAlpha (int index) const
+{
+    return 1.0f - (time - bubbles.spawnTime[index]) / config.bubbleFadeTime;
+}
+
+void ParticlePool::placeSmoke (float interpolation, float* x, float* y, float* alpha) const
+{
+    // How far the wind has gone since each puff was spawned, turned by its drift angle
+    ParticleKernels::SmokeInputs inputs;
+    inputs.spawnX = smoke.spawnX.data();
+    inputs.spawnY = smoke.spawnY.data();
+    inputs.windX = smoke.windX.data();
+    inputs.windY = smoke.windY.data();
+    inputs.driftCos = smoke.driftCos.data();
+    inputs.driftSin = smoke.driftSin.data();
+    inputs.spawnAlpha = smoke.spawnAlpha.data();
+    inputs.fadeRate = smoke.fadeRate.data();
+    inputs.spawnTime = smoke.spawnTime.data();
+    inputs.windTravel = Vec2::lerp (prevWindTravel, windTravel, interpolation);
+    inputs.windStrength = config.smokeWindStrength;
+    inputs.time = time;
+
+    ParticleKernels::get().placeSmoke (inputs, smoke.count, x, y, alpha);
+}
+
+void ParticlePool::remove (Kind kind, int index)
+{
+    // Swap-remove: the last particle takes its place
+    Particles& p = kinds[(size_t) kind];
+    int last = --p.count;
+
+    if (p.emitter[index] != noEmitter)
+        budgets[(size_t) kind].emitterCounts[p.emitter[index]]--;
+
+    p.x[index] = p.x[last];
+    p.y[index] = p.y[last];
+    p.radius[index] = p.radius[last];
+    p.alpha[index] = p.alpha[last];
+    p.fadeRate[index] = p.fadeRate[last];
+    p.emitter[index] = p.emitter[last];
+}
+
+void ParticlePool::removeSmoke (int index)
+{
+    int last = --smoke.count;
+
+    if (smoke.emitter[index] != noEmitter)
+        smokeBudget.emitterCounts[smoke.emitter[index]]--;
+
+    for (auto* column : { &smoke.spawnX, &smoke.spawnY, &smoke.windX, &smoke.windY, &smoke.driftCos, &smoke.driftSin,
+                          &smoke.radius, &smoke.spawnAlpha, &smoke.fadeRate, &smoke.spawnTime, &smoke.expiryTime })
+        (*column)[index] = (*column)[last];
+    smoke.emitter[index] = smoke.emitter[last];
+}
+
+void ParticlePool::update (float dt, Vec2 wind)
+{
+    const auto& kernels = ParticleKernels::get();
+    time += dt;
+
+    // Bubbles go in the order they came, so only the oldest need looking at
+    while (bubbles.count > 0 && time - bubbles.spawnTime[bubbles.first] >= config.bubbleFadeTime)
+    {
+        if (bubbles.emitter[bubbles.first] != noEmitter)
+            bubbleBudget.emitterCounts[bubbles.emitter[bubbles.first]]--;
+
+        bubbles.first = bubbles.getIndex (1);
+        bubbles.count--;
+    }
+
+    // Every puff moves with this, so it's the only thing smoke needs each step
+    prevWindTravel = windTravel;
+    windTravel += wind * dt;
+
+    // Removing brings the last one to i, so each search carries on from there
+    for (int i = kernels.findAtOrBelow (smoke.expiryTime.data(), 0, smoke.count, time); i < smoke.count;
+         i = kernels.findAtOrBelow (smoke.expiryTime.data(), i, smoke.count, time))
+        removeSmoke (i);
+
+    for (size_t k = 0; k < numKinds; ++k)
+    {
+        Particles& p = kinds[k];
+        kernels.fade (p.alpha.data(), p.fadeRate.data(), p.count, dt);
+
+        for (int i = kernels.findAtOrBelow (p.alpha.data(), 0, p.count, 0.0f); i < p.count;
+             i = kernels.findAtOrBelow (p.alpha.data(), i, p.count, 0.0f))
+            remove ((Kind) k, i);
+    }
+}
+
+int ParticlePool::getNumAlive() const
+{
+    int total = bubbles.count + smoke.count;
+    for (const auto& p : kinds)
+        total += p.count;
+    return total;
+}
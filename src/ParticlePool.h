@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Vec2.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// =============================================================================
+// ParticlePool
+// Every cosmetic particle in a world - wake bubbles, smoke, splashes and hit
+// explosions - in arrays sized once from the config budgets, one range per
+// kind, stored field by field. Expired particles are swap-removed, so retiring
+// any number of them is a single pass. Wake bubbles all fade over the same
+// time, so they're kept oldest first in a ring instead: their alpha comes from
+// their age when drawn, and retiring them just moves the start of the ring.
+// Smoke isn't stepped either. The pool keeps a running total of how far the
+// wind has carried things, and a puff's position is where it was spawned plus
+// its own turned share of what that total has gained since.
+// Each kind has a budget and no one emitter (a ship) may hold more than a share
+// of it. As either fills up, spawns are thinned out steadily rather than cut
+// off at the limit.
+// =============================================================================
+
+class ParticlePool
+{
+public:
+    enum class Kind
+    {
+        Splash,
+        Explosion,
+        numKinds
+    };
+
+    static constexpr int MAX_EMITTERS = 16;
+    static constexpr int noEmitter = -1;   // Not held to an emitter's share
+
+    // One kind's particles, the first count of each array are alive
+    struct Particles
+    {
+        std::vector<float> x, y;
+        std::vector<float> radius;          // Full size
+        std::vector<float> alpha;           // Falls to 0, then the particle is gone
+        std::vector<float> fadeRate;        // Alpha lost per second
+        std::vector<int8_t> emitter;
+        int count = 0;
+    };
+
+    // Smoke puffs, the first count of each array are alive. See placeSmoke()
+    struct Smoke
+    {
+        std::vector<float> spawnX, spawnY;
+        std::vector<float> windX, windY;        // The wind travel when spawned
+        std::vector<float> driftCos, driftSin;  // Rotation from the wind to the way it drifts
+        std::vector<float> radius;
+        std::vector<float> spawnAlpha;
+        std::vector<float> fadeRate;            // Alpha lost per second
+        std::vector<float> spawnTime;
+        std::vector<float> expiryTime;          // When its alpha reaches 0
+        std::vector<int8_t> emitter;
+        int count = 0;
+    };
+
+    // Wake bubbles in spawn order. The ring wraps at the size of the arrays
+    struct Bubbles
+    {
+        std::vector<float> x, y;
+        std::vector<float> radius;
+        std::vector<float> spawnTime;
+        std::vector<int8_t> emitter;
+        int first = 0;  // Oldest
+        int count = 0;
+
+        int getIndex (int n) const      { int i = first + n; return i < (int) x.size() ? i : i - (int) x.size(); }  // Of the nth oldest
+    };
+
+    struct Spawn
+    {
+        Vec2 position;
+        float radius = 0.0f;
+        float alpha = 1.0f;
+        float fadeRate = 1.0f;
+        float driftAngle = 0.0f;    // Smoke only, offset from the wind direction (radians)
+    };
+
+    // Empties the pool and sizes each kind from the config budgets. Only allocates when
+    // they've grown, and until the first call every spawn is dropped
+    void configure();
+    void clear();
+
+    // Adds a particle unless its kind or emitter is too full. Returns false if it was dropped
+    bool spawn (Kind kind, int emitter, const Spawn& particle);
+    bool spawnBubble (int emitter, Vec2 position, float radius);
+    bool spawnSmoke (int emitter, const Spawn& puff);
+
+    // Fades splashes and explosions, adds to the wind travel and retires what has faded out
+    void update (float dt, Vec2 wind);
+
+    const Particles& get (Kind kind) const  { return kinds[(size_t) kind]; }
+    const Bubbles& getBubbles() const       { return bubbles; }
+    float getBubbleAlpha (int index) const; // 1 when new, fading to 0 over the bubble fade time
+    const Smoke& getSmoke() const           { return smoke; }
+
+    // Where each smoke puff is, between the last two steps, and its alpha. Each array needs getSmoke().count
+    void placeSmoke (float interpolation, float* x, float* y, float* alpha) const;
+    int getNumAlive() const;
+    int getNumDropped() const               { return numDropped; }   // Since the last clear
+
+private:
+    static constexpr size_t numKinds = (size_t) Kind::numKinds;
+
+    // What spawning is held to for one kind
+    struct Budget
+    {
+        int capacity = 0;
+        std::array<int, MAX_EMITTERS> emitterCounts = {};
+        float spawnCredit = 0.0f;  // Builds up while thinning, a spawn goes through each time it reaches 1
+    };
+
+    std::array<Particles, numKinds> kinds;
+    std::array<Budget, numKinds> budgets;
+    Bubbles bubbles;
+    Budget bubbleBudget;
+    Smoke smoke;
+    Budget smokeBudget;
+    float time = 0.0f;  // Since the last clear, for bubble and smoke ages
+    Vec2 windTravel;    // The wind integrated over time since the last clear
+    Vec2 prevWindTravel;
+    int numDropped = 0;
+
+    bool admit (Budget& budget, int count, int emitter);
+    void remove (Kind kind, int index);
+    void removeSmoke (int index);
+};
@@ -10,6 +10,13 @@
 #include <pwd.h>
 #endif
 
+#if defined(__APPLE__)
+#include <CoreFoundation/CoreFoundation.h>
+#include <limits.h>
+#elif defined(__linux__)
+#include <linux/limits.h>
+#endif
+
 namespace Platform
 {
 
@@ -109,4 +116,46 @@ std::string getUserDataDirectory()
     return fullPath;
 }
 
+std::string getResourcePath (const char* filename)
+{
+   #if defined(__APPLE__)
+    CFBundleRef mainBundle = CFBundleGetMainBundle();
+    if (mainBundle)
+    {
+        CFURLRef resourceURL = CFBundleCopyResourcesDirectoryURL (mainBundle);
+        if (resourceURL)
+        {
+            char path[PATH_MAX];
+            if (CFURLGetFileSystemRepresentation (resourceURL, true, (UInt8*) path, PATH_MAX))
+            {
+                CFRelease (resourceURL);
+                return std::string (path) + "/" + filename;
+            }
+            CFRelease (resourceURL);
+        }
+    }
+    return filename;
+   #elif defined(__linux__)
+    if (access (filename, F_OK) == 0)
+        return filename;
+
+    char exePath[PATH_MAX];
+    ssize_t len = readlink ("/proc/self/exe", exePath, sizeof (exePath) - 1);
+    if (len != -1)
+    {
+        exePath[len] = '\0';
+        std::string dir (exePath);
+        size_t lastSlash = dir.find_last_of ('/');
+        if (lastSlash != std::string::npos)
+        {
+            dir = dir.substr (0, lastSlash + 1);
+            return dir + filename;
+        }
+    }
+    return filename;
+   #else
+    return filename;
+   #endif
+}
+
 }
@@ -9,4 +9,10 @@ namespace Platform
     // Windows: %APPDATA%/Heligoland/
     // Linux: ~/.local/share/Heligoland/
     std::string getUserDataDirectory();
+
+    // Resolves a bundled asset path (e.g. "assets/ships/ship1.png").
+    // macOS: inside the app bundle's Resources folder
+    // Linux: relative to the working directory, falling back to the executable's directory
+    // Windows: relative to the working directory
+    std::string getResourcePath (const char* filename);
 }
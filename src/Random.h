@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+// =============================================================================
+// Random
+// PCG32 generator (O'Neill, pcg-random.org). Small, fast and lock-free - each
+// instance is an independent stream, so every subsystem owns its own and a
+// match can be replayed exactly from one seed.
+// =============================================================================
+
+// Stream ids for the simulation. Per-ship streams add the ship index.
+enum class RandomStream : uint64_t
+{
+    MatchSetup  = 0x0001,   // Ship types, island placement and shapes
+    Wind        = 0x0002,
+    Current     = 0x0003,
+    ShipFiring  = 0x0100,   // + ship index: shell spread and range
+    ShipWake    = 0x0200,   // + ship index: bubble trail
+    ShipSmoke   = 0x0300,   // + ship index: smoke particles
+    AI          = 0x0400    // + ship index: personality, wander, edge recovery
+};
+
+class Random
+{
+public:
+    Random() { seed (0, 0); }
+    Random (uint64_t matchSeed, uint64_t stream) { seed (matchSeed, stream); }
+    Random (uint64_t matchSeed, RandomStream stream, int index = 0) { seed (matchSeed, (uint64_t) stream + (uint64_t) index); }
+
+    void seed (uint64_t matchSeed, uint64_t stream)
+    {
+        // Mix the ids so neighbouring seeds / streams don't produce related sequences
+        uint64_t streamHash = splitMix (stream);
+        state = 0;
+        increment = (streamHash << 1u) | 1u;
+        next();
+        state += splitMix (matchSeed ^ streamHash);
+        next();
+    }
+
+    uint32_t next()
+    {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t xorShifted = (uint32_t) (((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = (uint32_t) (old >> 59u);
+        return (xorShifted >> rot) | (xorShifted << ((-rot) & 31u));
+    }
+
+    float nextFloat()                               { return (next() >> 8) * (1.0f / 16777216.0f); }  // [0, 1)
+    float nextFloat (float min, float max)          { return min + nextFloat() * (max - min); }
+    float nextSigned()                              { return nextFloat() * 2.0f - 1.0f; }              // [-1, 1)
+    int nextInt (int n)                             { return n > 0 ? (int) (((uint64_t) next() * (uint64_t) n) >> 32) : 0; }  // [0, n)
+    bool nextBool()                                 { return (next() & 1u) != 0; }
+
+    // A fresh seed for something that wants its own generator (e.g. island shapes)
+    uint32_t nextSeed()                             { return next(); }
+
+    // Generator position, for state hashing
+    uint64_t getState() const                       { return state; }
+
+    static uint64_t splitMix (uint64_t x)
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+private:
+    uint64_t state = 0;
+    uint64_t increment = 1;
+};
@@ -0,0 +1,46 @@
+#include "Recording.h"
+#include "Ship.h"
+
+void MatchHeader::setFromWorld (const World& world, float ticksPerSecond)
+{
+    mode = world.getMode();
+    seed = world.getMatchSeed();
+    arenaWidth = world.getArenaWidth();
+    arenaHeight = world.getArenaHeight();
+    tickRate = ticksPerSecond;
+
+    const auto& ships = world.getShips();
+    for (int i = 0; i < World::MAX_SHIPS; ++i)
+        shipTypes[i] = ships[i] ? ships[i]->getShipType() : -1;
+}
+
+void MatchHeader::write (ByteWriter& w, const uint8_t (&magic)[4], uint8_t version) const
+{
+    w.writeBytes (magic, sizeof (magic));
+    w.writeU8 (version);
+    w.writeU8 ((uint8_t) mode);
+    w.writeU64 (seed);
+    w.writeFloat (arenaWidth);
+    w.writeFloat (arenaHeight);
+    w.writeFloat (tickRate);
+    for (int type : shipTypes)
+        w.writeSigned (type);
+}
+
+bool MatchHeader::read (ByteReader& r, const uint8_t (&magic)[4], uint8_t version)
+{
+    uint8_t fileMagic[4] = {};
+    r.readBytes (fileMagic, sizeof (fileMagic));
+    if (memcmp (fileMagic, magic, sizeof (magic)) != 0 || r.readU8() != version)
+        return false;
+
+    mode = (GameMode) r.readU8();
+    seed = r.readU64();
+    arenaWidth = r.readFloat();
+    arenaHeight = r.readFloat();
+    tickRate = r.readFloat();
+    for (int& type : shipTypes)
+        type = (int) r.readSigned();
+
+    return r.ok();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "BinaryIO.h"
+#include "World.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+// =============================================================================
+// Recordings
+// What the recording formats (state streams, datasets and event logs) have in
+// common: the match each one was made from, and the background thread that
+// drains the simulating thread's queue into the file.
+// =============================================================================
+
+struct MatchHeader
+{
+    GameMode mode = GameMode::FFA;
+    uint64_t seed = 0;
+    float arenaWidth = World::DEFAULT_ARENA_WIDTH;
+    float arenaHeight = World::DEFAULT_ARENA_HEIGHT;
+    float tickRate = 60.0f;
+    std::array<int, World::MAX_SHIPS> shipTypes = {};  // -1 = no ship
+
+    // Fills in everything from a started world
+    void setFromWorld (const World& world, float ticksPerSecond);
+
+    // Every format starts with its 4 byte magic and version, then these fields
+    void write (ByteWriter& w, const uint8_t (&magic)[4], uint8_t version) const;
+    bool read (ByteReader& r, const uint8_t (&magic)[4], uint8_t version);  // False if it's another format or version, or cut short
+};
+
+// The background thread behind every recording writer. The game thread only copies
+// each frame into the writer's lock-free queue, so recording never waits on the disk;
+// this calls the writer's drain function every couple of milliseconds until stop(),
+// then once more so nothing queued before stop() is missed
+class RecordingThread
+{
+public:
+    ~RecordingThread()  { stop(); }
+
+    template <typename Drain>
+    void start (Drain drain)
+    {
+        stop();
+        stopping = false;
+        thread = std::thread ([this, drain]
+        {
+            for (;;)
+            {
+                // Read the flag before draining so nothing queued before stop() is missed
+                bool finishing = stopping.load();
+                drain();
+
+                if (finishing)
+                    break;
+
+                std::this_thread::sleep_for (std::chrono::milliseconds (2));
+            }
+        });
+    }
+
+    // Waits for the last drain
+    void stop()
+    {
+        if (! thread.joinable())
+            return;
+
+        stopping = true;
+        thread.join();
+    }
+
+    bool isRunning() const  { return thread.joinable(); }
+
+private:
+    std::thread thread;
+    std::atomic<bool> stopping { false };
+};
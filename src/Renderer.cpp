@@ -1,71 +1,18 @@
 #include "Renderer.h"
 #include "Config.h"
-#include "Game.h"
 #include "Island.h"
+#include "Platform.h"
 #include "Shell.h"
 #include "Ship.h"
+#include "ShipHulls.h"
+#include "World.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <vector>
 
-#ifdef __APPLE__
-#include <CoreFoundation/CoreFoundation.h>
-#include <string>
-
-static std::string getResourcePath (const char* filename)
-{
-    CFBundleRef mainBundle = CFBundleGetMainBundle();
-    if (mainBundle)
-    {
-        CFURLRef resourceURL = CFBundleCopyResourcesDirectoryURL (mainBundle);
-        if (resourceURL)
-        {
-            char path[PATH_MAX];
-            if (CFURLGetFileSystemRepresentation (resourceURL, true, (UInt8*) path, PATH_MAX))
-            {
-                CFRelease (resourceURL);
-                return std::string (path) + "/" + filename;
-            }
-            CFRelease (resourceURL);
-        }
-    }
-    return filename;
-}
-#elif defined(__linux__)
-#include <string>
-#include <unistd.h>
-#include <linux/limits.h>
-
-static std::string getResourcePath (const char* filename)
-{
-    if (access (filename, F_OK) == 0)
-        return filename;
-
-    char exePath[PATH_MAX];
-    ssize_t len = readlink ("/proc/self/exe", exePath, sizeof (exePath) - 1);
-    if (len != -1)
-    {
-        exePath[len] = '\0';
-        std::string dir (exePath);
-        size_t lastSlash = dir.find_last_of ('/');
-        if (lastSlash != std::string::npos)
-        {
-            dir = dir.substr (0, lastSlash + 1);
-            return dir + filename;
-        }
-    }
-    return filename;
-}
-#else
-#include <string>
-
-static std::string getResourcePath (const char* filename)
-{
-    return filename;
-}
-#endif
-
-Renderer::Renderer()
+Renderer::Renderer (const ShipHulls& hulls_)
+    : hulls (hulls_)
 {
     createNoiseTexture();
     loadShipTextures();
@@ -73,20 +20,25 @@ Renderer::Renderer()
 
 Renderer::~Renderer()
 {
-    if (noiseTexture1.id != 0)
-        UnloadTexture (noiseTexture1);
-    if (noiseTexture2.id != 0)
-        UnloadTexture (noiseTexture2);
+    unloadNoiseTexture();
 
-    // Unload ship textures and images
+    // Unload ship textures
     for (int i = 0; i < NUM_SHIP_TYPES; ++i)
     {
         if (shipHullTextures[i].id != 0)
             UnloadTexture (shipHullTextures[i]);
         if (shipTurretTextures[i].id != 0)
             UnloadTexture (shipTurretTextures[i]);
-        if (shipHullImages[i].data != nullptr)
-            UnloadImage (shipHullImages[i]);
+    }
+}
+
+void Renderer::configChanged (const ConfigChanges& changes)
+{
+    // The water highlight colors are baked into the noise textures
+    if (changes.has ("colorsEnvironment"))
+    {
+        unloadNoiseTexture();
+        createNoiseTexture();
     }
 }
 
@@ -150,8 +102,8 @@ void Renderer::present()
 
 void Renderer::drawShip (const Ship& ship)
 {
-    Vec2 pos = ship.getPosition();
-    float angle = ship.getAngle();
+    Vec2 pos = ship.getRenderPosition (interpolation);
+    float angle = ship.getRenderAngle (interpolation);
 
     // Draw firing range circle (very faint white) - only for non-sinking ships
     if (ship.isAlive())
@@ -238,33 +190,49 @@ void Renderer::drawShip (const Ship& ship)
     }
 }
 
-void Renderer::drawBubbleTrail (const Ship& ship)
+void Renderer::drawBubbles (const ParticlePool& particles)
 {
-    for (const auto& bubble : ship.getBubbles())
+    const auto& bubbles = particles.getBubbles();
+    for (int n = 0; n < bubbles.count; ++n)
     {
-        unsigned char alpha = (unsigned char) (bubble.alpha * 128);
+        int i = bubbles.getIndex (n);
+        unsigned char alpha = (unsigned char) (particles.getBubbleAlpha (i) * 128);
         Color color = { 255, 255, 255, alpha };
-        drawFilledCircle (bubble.position, bubble.radius, color);
+        drawFilledCircle ({ bubbles.x[i], bubbles.y[i] }, bubbles.radius[i], color);
     }
 }
 
-void Renderer::drawSmoke (const Ship& ship)
+void Renderer::drawSmoke (const ParticlePool& particles, const Fleet& fleet)
 {
-    // Smoke lightens as ship sinks
-    float sinkProgress = ship.getSinkProgress();
-    unsigned char greyValue = (unsigned char) (config.smokeGreyStart + sinkProgress * (config.smokeGreyEnd - config.smokeGreyStart));
+    // Smoke lightens as its ship sinks
+    std::array<unsigned char, ParticlePool::MAX_EMITTERS> greyValues;
+    for (int i = 0; i < Fleet::MAX_SHIPS; ++i)
+    {
+        float sinkProgress = fleet.sinking[i] ? fleet.sinkTimer[i] / config.shipSinkDuration : 0.0f;
+        greyValues[i] = (unsigned char) (config.smokeGreyStart + sinkProgress * (config.smokeGreyEnd - config.smokeGreyStart));
+    }
+
+    const auto& smoke = particles.getSmoke();
+    if (smokeX.size() < (size_t) smoke.count)
+    {
+        smokeX.resize (smoke.count);
+        smokeY.resize (smoke.count);
+        smokeAlpha.resize (smoke.count);
+    }
+    particles.placeSmoke (interpolation, smokeX.data(), smokeY.data(), smokeAlpha.data());
 
-    for (const auto& s : ship.getSmoke())
+    for (int i = 0; i < smoke.count; ++i)
     {
-        unsigned char alpha = (unsigned char) (s.alpha * 180);
-        Color color = { greyValue, greyValue, greyValue, alpha };
-        drawFilledCircle (s.position, s.radius, color);
+        unsigned char grey = smoke.emitter[i] >= 0 ? greyValues[smoke.emitter[i]] : config.smokeGreyStart;
+        unsigned char alpha = (unsigned char) (smokeAlpha[i] * 180);
+        Color color = { grey, grey, grey, alpha };
+        drawFilledCircle ({ smokeX[i], smokeY[i] }, smoke.radius[i], color);
     }
 }
 
 void Renderer::drawShell (const Shell& shell)
 {
-    Vec2 pos = shell.getPosition();
+    Vec2 pos = shell.getRenderPosition (interpolation);
     Vec2 vel = shell.getVelocity();
     float radius = shell.getRadius();
 
@@ -296,48 +264,58 @@ void Renderer::drawShell (const Shell& shell)
     drawFilledCircle (pos, radius, config.colorShell);
 }
 
-void Renderer::drawExplosion (const Explosion& explosion)
+void Renderer::drawExplosions (const ParticlePool& particles)
 {
-    float progress = explosion.getProgress();
+    // Each fades out over its lifetime, so how far it has faded is how far through it is
+    for (auto kind : { ParticlePool::Kind::Splash, ParticlePool::Kind::Explosion })
+    {
+        const auto& explosions = particles.get (kind);
+        for (int i = 0; i < explosions.count; ++i)
+            drawExplosion ({ explosions.x[i], explosions.y[i] }, explosions.radius[i], 1.0f - explosions.alpha[i],
+                           kind == ParticlePool::Kind::Explosion);
+    }
+}
 
+void Renderer::drawExplosion (Vec2 position, float maxRadius, float progress, bool isHit)
+{
     // Explosion expands quickly then fades
-    float radius = explosion.maxRadius * std::sqrt (progress);
+    float radius = maxRadius * std::sqrt (progress);
     float alpha = 1.0f - progress;
 
-    if (explosion.isHit)
+    if (isHit)
     {
         // Hit explosion - orange/yellow
         Color outerColor = { config.colorExplosionOuter.r, config.colorExplosionOuter.g, config.colorExplosionOuter.b, (unsigned char) (alpha * config.colorExplosionOuter.a) };
-        drawCircle (explosion.position, radius, outerColor);
+        drawCircle (position, radius, outerColor);
 
         if (radius > 5.0f)
         {
             Color midColor = { config.colorExplosionMid.r, config.colorExplosionMid.g, config.colorExplosionMid.b, (unsigned char) (alpha * config.colorExplosionMid.a) };
-            drawCircle (explosion.position, radius * 0.7f, midColor);
+            drawCircle (position, radius * 0.7f, midColor);
         }
 
         if (radius > 10.0f)
         {
             Color coreColor = { config.colorExplosionCore.r, config.colorExplosionCore.g, config.colorExplosionCore.b, (unsigned char) (alpha * config.colorExplosionCore.a) };
-            drawFilledCircle (explosion.position, radius * 0.3f, coreColor);
+            drawFilledCircle (position, radius * 0.3f, coreColor);
         }
     }
     else
     {
         // Miss splash - blue/white
         Color outerColor = { config.colorSplashOuter.r, config.colorSplashOuter.g, config.colorSplashOuter.b, (unsigned char) (alpha * config.colorSplashOuter.a) };
-        drawCircle (explosion.position, radius, outerColor);
+        drawCircle (position, radius, outerColor);
 
         if (radius > 5.0f)
         {
             Color midColor = { config.colorSplashMid.r, config.colorSplashMid.g, config.colorSplashMid.b, (unsigned char) (alpha * config.colorSplashMid.a) };
-            drawCircle (explosion.position, radius * 0.7f, midColor);
+            drawCircle (position, radius * 0.7f, midColor);
         }
 
         if (radius > 10.0f)
         {
             Color coreColor = { config.colorSplashCore.r, config.colorSplashCore.g, config.colorSplashCore.b, (unsigned char) (alpha * config.colorSplashCore.a) };
-            drawFilledCircle (explosion.position, radius * 0.3f, coreColor);
+            drawFilledCircle (position, radius * 0.3f, coreColor);
         }
     }
 }
@@ -410,13 +388,15 @@ void Renderer::drawShipHUD (const Ship& ship, int slot, int totalSlots, float sc
 
     // Player label
     int playerNum = ship.getPlayerIndex() + 1;
-    std::string label = std::to_string (playerNum);
+    char label[16];
+    snprintf (label, sizeof (label), "%d", playerNum);
     float labelScale = hudWidth < 120.0f ? 1.5f : 2.0f;
     drawText (label, { x + 3, y + 3 }, labelScale, shipColor);
 
     // Speed in knots (actual speed - faster ships show higher knots)
     float speedKnots = (ship.getSpeed() / config.shipMaxSpeed) * config.shipFullSpeedKnots;
-    std::string speedText = std::to_string ((int) std::round (speedKnots)) + "KT";
+    char speedText[16];
+    snprintf (speedText, sizeof (speedText), "%dKT", (int) std::round (speedKnots));
     Color speedColor = { config.colorGreyLight.r, config.colorGreyLight.g, config.colorGreyLight.b, a };
     drawText (speedText, { x + 3, y + 20 }, 1.0f, speedColor);
 
@@ -755,7 +735,7 @@ void Renderer::drawChar (char c, Vec2 position, float scale, Color color)
     }
 }
 
-void Renderer::drawText (const std::string& text, Vec2 position, float scale, Color color)
+void Renderer::drawText (std::string_view text, Vec2 position, float scale, Color color)
 {
     float charWidth = 6 * scale; // 5 pixels + 1 spacing
     Vec2 pos = position;
@@ -768,7 +748,7 @@ void Renderer::drawText (const std::string& text, Vec2 position, float scale, Co
     }
 }
 
-void Renderer::drawTextCentered (const std::string& text, Vec2 center, float scale, Color color)
+void Renderer::drawTextCentered (std::string_view text, Vec2 center, float scale, Color color)
 {
     float charWidth = 6 * scale;
     float charHeight = 7 * scale;
@@ -841,19 +821,23 @@ void Renderer::createNoiseTexture()
     SetTextureFilter (noiseTexture2, TEXTURE_FILTER_BILINEAR);
 }
 
+void Renderer::unloadNoiseTexture()
+{
+    if (noiseTexture1.id != 0)
+        UnloadTexture (noiseTexture1);
+    if (noiseTexture2.id != 0)
+        UnloadTexture (noiseTexture2);
+
+    noiseTexture1 = {};
+    noiseTexture2 = {};
+}
+
 void Renderer::loadShipTextures()
 {
-    // Scale factor applied to all ship textures on load
-    const float shipTextureScale = 0.5f;
-
-    // New ship textures: ship1.png (1 turret) through ship4.png (4 turrets)
-    const char* hullPaths[NUM_SHIP_TYPES] = {
-        "assets/ships/ship1.png",
-        "assets/ships/ship2.png",
-        "assets/ships/ship3.png",
-        "assets/ships/ship4.png"
-    };
+    // Scale factor applied to all ship textures on load (must match the hull images)
+    const float shipTextureScale = ShipHulls::textureScale;
 
+    // Turret textures: turret1.png (1 turret ship) through turret4.png (4 turret ship)
     const char* turretPaths[NUM_SHIP_TYPES] = {
         "assets/ships/turret1.png",
         "assets/ships/turret2.png",
@@ -861,30 +845,20 @@ void Renderer::loadShipTextures()
         "assets/ships/turret4.png"
     };
 
-    shipTexturesLoaded = true;
+    shipTexturesLoaded = hulls.isLoaded();
 
     for (int i = 0; i < NUM_SHIP_TYPES; ++i)
     {
-        // Load hull image, scale it, and keep for pixel-perfect hit testing
-        Image hullImage = LoadImage (getResourcePath (hullPaths[i]).c_str());
+        // Hull images are already loaded and scaled by ShipHulls (also used for hit testing)
+        const Image& hullImage = hulls.getHullImage (i);
         if (hullImage.data != nullptr)
         {
-            int newWidth = (int) (hullImage.width * shipTextureScale);
-            int newHeight = (int) (hullImage.height * shipTextureScale);
-            ImageResize (&hullImage, newWidth, newHeight);
-
-            shipHullImages[i] = hullImage;
-            shipHullTextures[i] = LoadTextureFromImage (shipHullImages[i]);
+            shipHullTextures[i] = LoadTextureFromImage (hullImage);
             SetTextureFilter (shipHullTextures[i], TEXTURE_FILTER_BILINEAR);
         }
-        else
-        {
-            TraceLog (LOG_WARNING, "Failed to load ship hull texture: %s", hullPaths[i]);
-            shipTexturesLoaded = false;
-        }
 
         // Load turret image and scale it
-        Image turretImage = LoadImage (getResourcePath (turretPaths[i]).c_str());
+        Image turretImage = LoadImage (Platform::getResourcePath (turretPaths[i]).c_str());
         if (turretImage.data != nullptr)
         {
             int newWidth = (int) (turretImage.width * shipTextureScale);
@@ -903,24 +877,6 @@ void Renderer::loadShipTextures()
     }
 }
 
-float Renderer::getShipLength (int shipType) const
-{
-    // Ship length is the hull texture height (bow points up in image)
-    int idx = std::clamp (shipType, 0, NUM_SHIP_TYPES - 1);
-    if (shipTexturesLoaded && shipHullTextures[idx].id != 0)
-        return (float) shipHullTextures[idx].height;
-    return 100.0f; // Fallback
-}
-
-float Renderer::getShipWidth (int shipType) const
-{
-    // Ship width is the hull texture width
-    int idx = std::clamp (shipType, 0, NUM_SHIP_TYPES - 1);
-    if (shipTexturesLoaded && shipHullTextures[idx].id != 0)
-        return (float) shipHullTextures[idx].width;
-    return 25.0f; // Fallback
-}
-
 int Renderer::getShipColorIndex (const Ship& ship) const
 {
     int team = ship.getTeam();
@@ -1004,101 +960,6 @@ void Renderer::drawShipPreview (int shipType, Vec2 position, float angle, int pl
     }
 }
 
-bool Renderer::checkShipHit (const Ship& ship, Vec2 worldPos) const
-{
-    if (!shipTexturesLoaded)
-        return true; // Fallback to always hit if no textures
-
-    int texIdx = ship.getShipType();
-    const Image& img = shipHullImages[texIdx];
-    if (img.data == nullptr)
-        return true; // Fallback
-
-    // Transform world position to ship-local coordinates
-    Vec2 shipPos = ship.getPosition();
-    float angle = ship.getAngle();
-    float cosA = std::cos (angle);
-    float sinA = std::sin (angle);
-
-    float dx = worldPos.x - shipPos.x;
-    float dy = worldPos.y - shipPos.y;
-
-    // Rotate to ship-local (X = forward toward bow, Y = starboard)
-    float localX = dx * cosA + dy * sinA;
-    float localY = -dx * sinA + dy * cosA;
-
-    // Convert to image coordinates
-    // Image has bow pointing UP, so:
-    // - imageX corresponds to ship's Y (starboard)
-    // - imageY corresponds to -ship's X (bow is up = negative Y in image)
-    float imgCenterX = img.width / 2.0f;
-    float imgCenterY = img.height / 2.0f;
-
-    int imageX = (int) (imgCenterX + localY);
-    int imageY = (int) (imgCenterY - localX);
-
-    // Check bounds
-    if (imageX < 0 || imageX >= img.width || imageY < 0 || imageY >= img.height)
-        return false; // Outside image bounds = miss
-
-    // Get pixel color and check alpha
-    Color pixel = GetImageColor (img, imageX, imageY);
-    return pixel.a > 0; // Hit if not fully transparent
-}
-
-bool Renderer::checkShipCollision (const Ship& shipA, const Ship& shipB, Vec2& collisionPoint) const
-{
-    if (!shipTexturesLoaded)
-        return false;
-
-    int texIdxA = shipA.getShipType();
-    const Image& imgA = shipHullImages[texIdxA];
-    if (imgA.data == nullptr)
-        return false;
-
-    // Quick bounding check first
-    Vec2 posA = shipA.getPosition();
-    Vec2 posB = shipB.getPosition();
-    float maxDist = (shipA.getLength() + shipB.getLength()) / 2.0f;
-    if ((posA - posB).length() > maxDist)
-        return false;
-
-    // Sample points along ship A's hull outline and check against ship B
-    float angleA = shipA.getAngle();
-    float cosA = std::cos (angleA);
-    float sinA = std::sin (angleA);
-
-    // Scan through ship A's image and check non-transparent edge pixels against ship B
-    int stepSize = 2; // Check every 2nd pixel for performance
-    for (int iy = 0; iy < imgA.height; iy += stepSize)
-    {
-        for (int ix = 0; ix < imgA.width; ix += stepSize)
-        {
-            Color pixelA = GetImageColor (imgA, ix, iy);
-            if (pixelA.a == 0)
-                continue; // Skip transparent pixels
-
-            // Convert image coords to ship-local coords
-            float localX = (imgA.height / 2.0f) - iy; // Forward direction
-            float localY = ix - (imgA.width / 2.0f);  // Starboard direction
-
-            // Convert to world coords
-            Vec2 worldPos;
-            worldPos.x = posA.x + localX * cosA - localY * sinA;
-            worldPos.y = posA.y + localX * sinA + localY * cosA;
-
-            // Check if this point hits ship B
-            if (checkShipHit (shipB, worldPos))
-            {
-                collisionPoint = worldPos;
-                return true;
-            }
-        }
-    }
-
-    return false;
-}
-
 void Renderer::drawIsland (const Island& island)
 {
     const auto& vertices = island.getVertices();
@@ -1124,7 +985,8 @@ void Renderer::drawIsland (const Island& island)
     for (const auto& layer : layers)
     {
         // Scale vertices toward center
-        std::vector<Vec2> scaledVerts;
+        auto& scaledVerts = islandVertices;
+        scaledVerts.clear();
         for (const auto& v : vertices)
         {
             Vec2 scaled;
@@ -1147,7 +1009,8 @@ void Renderer::drawIsland (const Island& island)
         // Fill using horizontal scanlines
         for (int y = (int) minY; y <= (int) maxY; ++y)
         {
-            std::vector<float> intersections;
+            auto& intersections = scanlineCrossings;
+            intersections.clear();
             int n = (int) scaledVerts.size();
 
             for (int i = 0; i < n; ++i)
@@ -2,28 +2,39 @@
 
 #include "Vec2.h"
 #include <raylib.h>
-#include <string>
+#include <string_view>
+#include <vector>
 
 class Ship;
 class Shell;
 class Island;
-struct Explosion;
+class ShipHulls;
+class ParticlePool;
+struct Fleet;
+struct ConfigChanges;
 
 class Renderer
 {
 public:
-    Renderer();
+    explicit Renderer (const ShipHulls& hulls);
     ~Renderer();
 
     void clear();
+
+    // Rebuilds the textures made from config values that have changed
+    void configChanged (const ConfigChanges& changes);
+
+    // Blend factor between the previous and current simulation step (0-1) used
+    // when drawing moving objects, so motion stays smooth at any display rate
+    void setInterpolation (float alpha) { interpolation = alpha; }
     void drawWater (float time, float screenWidth, float screenHeight);
     void present();
 
     void drawShip (const Ship& ship);
-    void drawBubbleTrail (const Ship& ship);
-    void drawSmoke (const Ship& ship);
+    void drawBubbles (const ParticlePool& particles);
+    void drawSmoke (const ParticlePool& particles, const Fleet& fleet);  // Shaded by how far each ship has sunk
     void drawShell (const Shell& shell);
-    void drawExplosion (const Explosion& explosion);
+    void drawExplosions (const ParticlePool& particles);
     void drawCrosshair (const Ship& ship);
     void drawShipHUD (const Ship& ship, int slot, int totalSlots, float screenWidth, float hudWidth, float alpha = 1.0f);
     void drawWindIndicator (Vec2 wind, float screenWidth, float screenHeight);
@@ -37,28 +48,32 @@ public:
     void drawFilledRect (Vec2 topLeft, float width, float height, Color color);
 
     // Simple bitmap text rendering (blocky letters)
-    void drawText (const std::string& text, Vec2 position, float scale, Color color);
-    void drawTextCentered (const std::string& text, Vec2 center, float scale, Color color);
-
-    // Ship dimensions from loaded textures
-    float getShipLength (int shipType = 3) const;  // Default to battleship (type 4, index 3)
-    float getShipWidth (int shipType = 3) const;
+    void drawText (std::string_view text, Vec2 position, float scale, Color color);
+    void drawTextCentered (std::string_view text, Vec2 center, float scale, Color color);
 
     // Draw ship selection preview
     void drawShipPreview (int shipType, Vec2 position, float angle, int playerIndex = 0);
 
-    // Pixel-perfect hit testing
-    bool checkShipHit (const Ship& ship, Vec2 worldPos) const;
-    bool checkShipCollision (const Ship& shipA, const Ship& shipB, Vec2& collisionPoint) const;
-
 private:
     void createNoiseTexture();
+    void unloadNoiseTexture();
     void loadShipTextures();
     void drawFilledOval (Vec2 center, float width, float height, float angle, Color color);
     void drawFilledCircle (Vec2 center, float radius, Color color);
     void drawChar (char c, Vec2 position, float scale, Color color);
+    void drawExplosion (Vec2 position, float maxRadius, float progress, bool isHit);
     int getShipColorIndex (const Ship& ship) const;  // Returns color index (0-3) based on team/player
 
+    const ShipHulls& hulls;
+    float interpolation = 1.0f;
+
+    // Island fill scratch, kept between frames so drawing doesn't allocate
+    std::vector<Vec2> islandVertices;
+    std::vector<float> scanlineCrossings;
+
+    // Smoke positions and alphas for this frame, worked out all at once
+    std::vector<float> smokeX, smokeY, smokeAlpha;
+
     Texture2D noiseTexture1 = { 0 };
     Texture2D noiseTexture2 = { 0 };
     static constexpr int noiseTextureSize = 128;
@@ -67,6 +82,5 @@ private:
     static constexpr int NUM_SHIP_TYPES = 4;
     Texture2D shipHullTextures[NUM_SHIP_TYPES] = {};
     Texture2D shipTurretTextures[NUM_SHIP_TYPES] = {};
-    Image shipHullImages[NUM_SHIP_TYPES] = {};  // Keep images for pixel-perfect hit testing
     bool shipTexturesLoaded = false;
 };
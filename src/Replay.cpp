@@ -0,0 +1,328 @@
+#include "Replay.h"
+#include <algorithm>
+#include <cmath>
+
+// File layout:
+//   "HLRP" u8 version, header fields, then per tick:
+//     varint flags (TickFlag, plus one bit per ship whose input changed from shipChangedShift up),
+//     optional arena size / human mask,
+//     then for each changed human ship (ascending index): u8 change bits + zigzag varint deltas.
+//   The tick stream ends with TickFlag::end, followed by a fixed size trailer:
+//     u8 completed, i32 winner, u32 tick count
+
+namespace
+{
+    const uint8_t magic[4] = { 'H', 'L', 'R', 'P' };
+    constexpr uint8_t formatVersion = 1;
+    constexpr size_t trailerSize = 9;
+
+    // The buffer is reserved for a match this long up front so recording doesn't reallocate
+    // mid-match. A tick with every human changing their input is about this big; longer
+    // matches still record, the buffer just grows
+    constexpr float reservedMatchSeconds = 20.0f * 60.0f;
+    constexpr size_t reservedBytesPerTick = 24;
+
+    // Stored precision
+    constexpr float stickScale = 127.0f;     // Stick axes: 1/127 steps
+    constexpr float crosshairScale = 8.0f;   // Mouse crosshair: 1/8 pixel
+
+    enum TickFlag : uint32_t
+    {
+        arenaChanged = 1 << 0,
+        humansChanged = 1 << 1,
+        end = 1 << 2
+    };
+
+    constexpr int shipChangedShift = 3;
+
+    enum ChangeBit : uint8_t
+    {
+        moveX = 1 << 0,
+        moveY = 1 << 1,
+        aimX = 1 << 2,
+        aimY = 1 << 3,
+        fireToggled = 1 << 4,
+        crosshairToggled = 1 << 5,
+        crosshairX = 1 << 6,
+        crosshairY = 1 << 7
+    };
+
+    int32_t quantiseStick (float v)     { return (int32_t) std::lround (std::clamp (v, -1.0f, 1.0f) * stickScale); }
+    int32_t quantiseCrosshair (float v) { return (int32_t) std::lround (v * crosshairScale); }
+}
+
+namespace Replay
+{
+    void quantise (ShipInput& input)
+    {
+        input.move = { quantiseStick (input.move.x) / stickScale, quantiseStick (input.move.y) / stickScale };
+        input.aim = { quantiseStick (input.aim.x) / stickScale, quantiseStick (input.aim.y) / stickScale };
+        input.crosshair = { quantiseCrosshair (input.crosshair.x) / crosshairScale, quantiseCrosshair (input.crosshair.y) / crosshairScale };
+    }
+}
+
+//==============================================================================
+ReplayRecorder::PackedInput ReplayRecorder::pack (const ShipInput& input)
+{
+    PackedInput p;
+    p.moveX = quantiseStick (input.move.x);
+    p.moveY = quantiseStick (input.move.y);
+    p.aimX = quantiseStick (input.aim.x);
+    p.aimY = quantiseStick (input.aim.y);
+    p.crosshairX = quantiseCrosshair (input.crosshair.x);
+    p.crosshairY = quantiseCrosshair (input.crosshair.y);
+    p.fire = input.fire;
+    p.hasCrosshair = input.hasCrosshair;
+    return p;
+}
+
+ShipInput ReplayRecorder::unpack (const PackedInput& p)
+{
+    ShipInput input;
+    input.human = true;
+    input.move = { p.moveX / stickScale, p.moveY / stickScale };
+    input.aim = { p.aimX / stickScale, p.aimY / stickScale };
+    input.fire = p.fire;
+    input.hasCrosshair = p.hasCrosshair;
+    input.crosshair = { p.crosshairX / crosshairScale, p.crosshairY / crosshairScale };
+    return input;
+}
+
+void ReplayRecorder::begin (const ReplayHeader& header)
+{
+    writer.clear();
+    writer.reserve ((size_t) (std::max (1.0f, header.physicsRate) * reservedMatchSeconds) * reservedBytesPerTick);
+    previous = {};
+    humanMask = 0;
+    lastArenaWidth = header.arenaWidth;
+    lastArenaHeight = header.arenaHeight;
+    numTicks = 0;
+    recording = true;
+    finished = false;
+
+    writer.writeBytes (magic, sizeof (magic));
+    writer.writeU8 (formatVersion);
+    writer.writeVarint (header.version.size());
+    writer.writeBytes (header.version.data(), header.version.size());
+    writer.writeU8 ((uint8_t) header.mode);
+    writer.writeU64 (header.seed);
+    for (int type : header.shipTypes)
+        writer.writeSigned (type);
+    writer.writeFloat (header.arenaWidth);
+    writer.writeFloat (header.arenaHeight);
+    writer.writeFloat (header.physicsRate);
+    writer.writeFloat (header.aiRate);
+}
+
+void ReplayRecorder::recordTick (const World::ShipInputs& inputs, float arenaWidth, float arenaHeight)
+{
+    if (! recording)
+        return;
+
+    uint32_t mask = 0;
+    for (int i = 0; i < World::MAX_SHIPS; ++i)
+        if (inputs[i].human)
+            mask |= 1u << i;
+
+    uint32_t flags = 0;
+    if (arenaWidth != lastArenaWidth || arenaHeight != lastArenaHeight)
+        flags |= arenaChanged;
+    if (mask != humanMask)
+        flags |= humansChanged;
+
+    std::array<PackedInput, World::MAX_SHIPS> current;
+    std::array<uint8_t, World::MAX_SHIPS> changes = {};
+    for (int i = 0; i < World::MAX_SHIPS; ++i)
+    {
+        if (! (mask & (1u << i)))
+            continue;
+
+        const PackedInput& cur = current[i] = pack (inputs[i]);
+        const PackedInput& prev = previous[i];
+
+        uint8_t& c = changes[i];
+        if (cur.moveX != prev.moveX)                c |= moveX;
+        if (cur.moveY != prev.moveY)                c |= moveY;
+        if (cur.aimX != prev.aimX)                  c |= aimX;
+        if (cur.aimY != prev.aimY)                  c |= aimY;
+        if (cur.fire != prev.fire)                  c |= fireToggled;
+        if (cur.hasCrosshair != prev.hasCrosshair)  c |= crosshairToggled;
+        if (cur.crosshairX != prev.crosshairX)      c |= crosshairX;
+        if (cur.crosshairY != prev.crosshairY)      c |= crosshairY;
+
+        if (c != 0)
+            flags |= 1u << (shipChangedShift + i);
+    }
+
+    writer.writeVarint (flags);
+
+    if (flags & arenaChanged)
+    {
+        writer.writeFloat (arenaWidth);
+        writer.writeFloat (arenaHeight);
+        lastArenaWidth = arenaWidth;
+        lastArenaHeight = arenaHeight;
+    }
+
+    if (flags & humansChanged)
+    {
+        writer.writeVarint (mask);
+        humanMask = mask;
+    }
+
+    // Ships holding the same input as last tick cost nothing beyond their flag bit
+    for (int i = 0; i < World::MAX_SHIPS; ++i)
+    {
+        uint8_t c = changes[i];
+        if (c == 0)
+            continue;
+
+        const PackedInput& cur = current[i];
+        PackedInput& prev = previous[i];
+
+        writer.writeU8 (c);
+        if (c & moveX)          writer.writeSigned (cur.moveX - prev.moveX);
+        if (c & moveY)          writer.writeSigned (cur.moveY - prev.moveY);
+        if (c & aimX)           writer.writeSigned (cur.aimX - prev.aimX);
+        if (c & aimY)           writer.writeSigned (cur.aimY - prev.aimY);
+        if (c & crosshairX)     writer.writeSigned (cur.crosshairX - prev.crosshairX);
+        if (c & crosshairY)     writer.writeSigned (cur.crosshairY - prev.crosshairY);
+
+        prev = cur;
+    }
+
+    numTicks++;
+}
+
+void ReplayRecorder::finish (int winnerIndex, bool completed)
+{
+    if (! recording)
+        return;
+
+    writer.writeVarint (end);
+    writer.writeU8 (completed ? 1 : 0);
+    writer.writeU32 ((uint32_t) (int32_t) winnerIndex);
+    writer.writeU32 (numTicks);
+
+    recording = false;
+    finished = true;
+}
+
+bool ReplayRecorder::save (const std::string& path) const
+{
+    if (! finished)
+        return false;
+    return writeFile (path, writer.data());
+}
+
+//==============================================================================
+bool ReplayPlayer::load (const std::string& path)
+{
+    bytes.clear();
+    if (! readFile (path, bytes) || bytes.size() < sizeof (magic) + trailerSize)
+        return false;
+
+    ByteReader r (bytes.data(), bytes.size());
+
+    uint8_t fileMagic[4] = {};
+    r.readBytes (fileMagic, sizeof (fileMagic));
+    if (memcmp (fileMagic, magic, sizeof (magic)) != 0 || r.readU8() != formatVersion)
+        return false;
+
+    header = {};
+    size_t versionLength = (size_t) r.readVarint();
+    if (versionLength > 64)
+        return false;
+    header.version.resize (versionLength);
+    r.readBytes (header.version.data(), versionLength);
+
+    header.mode = (GameMode) r.readU8();
+    header.seed = r.readU64();
+    for (int& type : header.shipTypes)
+        type = (int) r.readSigned();
+    header.arenaWidth = r.readFloat();
+    header.arenaHeight = r.readFloat();
+    header.physicsRate = r.readFloat();
+    header.aiRate = r.readFloat();
+
+    if (! r.ok() || (int) header.mode > (int) GameMode::Battle)
+        return false;
+
+    // Fixed size trailer at the end of the file, straight after the end of stream marker.
+    // A missing marker means the file was cut short.
+    size_t trailerStart = bytes.size() - trailerSize;
+    if (trailerStart <= r.position() || bytes[trailerStart - 1] != end || bytes[trailerStart] > 1)
+        return false;
+
+    ByteReader trailer (bytes.data() + trailerStart, trailerSize);
+    resultKnown = trailer.readU8() != 0;
+    recordedWinner = (int) (int32_t) trailer.readU32();
+    recordedTicks = trailer.readU32();
+
+    firstTickOffset = r.position();
+    rewind();
+    return true;
+}
+
+void ReplayPlayer::rewind()
+{
+    reader = ByteReader (bytes.data(), bytes.size() - trailerSize);
+    reader.seek (firstTickOffset);
+    previous = {};
+    humanMask = 0;
+    arenaWidth = header.arenaWidth;
+    arenaHeight = header.arenaHeight;
+    ended = bytes.empty();
+}
+
+bool ReplayPlayer::nextTick (World::ShipInputs& inputs, float& arenaWidth_, float& arenaHeight_)
+{
+    if (ended)
+        return false;
+
+    uint32_t flags = (uint32_t) reader.readVarint();
+    if (! reader.ok() || (flags & end))
+    {
+        ended = true;
+        return false;
+    }
+
+    if (flags & arenaChanged)
+    {
+        arenaWidth = reader.readFloat();
+        arenaHeight = reader.readFloat();
+    }
+
+    if (flags & humansChanged)
+        humanMask = (uint32_t) reader.readVarint();
+
+    inputs = {};
+    for (int i = 0; i < World::MAX_SHIPS; ++i)
+    {
+        if (! (humanMask & (1u << i)))
+            continue;
+
+        auto& p = previous[i];
+        uint8_t changes = (flags & (1u << (shipChangedShift + i))) ? reader.readU8() : 0;
+        if (changes & moveX)            p.moveX += (int32_t) reader.readSigned();
+        if (changes & moveY)            p.moveY += (int32_t) reader.readSigned();
+        if (changes & aimX)             p.aimX += (int32_t) reader.readSigned();
+        if (changes & aimY)             p.aimY += (int32_t) reader.readSigned();
+        if (changes & crosshairX)       p.crosshairX += (int32_t) reader.readSigned();
+        if (changes & crosshairY)       p.crosshairY += (int32_t) reader.readSigned();
+        if (changes & fireToggled)      p.fire = ! p.fire;
+        if (changes & crosshairToggled) p.hasCrosshair = ! p.hasCrosshair;
+
+        inputs[i] = ReplayRecorder::unpack (p);
+    }
+
+    if (! reader.ok())
+    {
+        ended = true;
+        return false;
+    }
+
+    arenaWidth_ = arenaWidth;
+    arenaHeight_ = arenaHeight;
+    return true;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "BinaryIO.h"
+#include "World.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// Input replays
+// A match is fully determined by its seed, settings and the human inputs, so a
+// replay stores just those: a header plus one record per simulation tick with
+// each human ship's inputs, delta and varint coded against the previous tick.
+// AI ships are simulated live on playback.
+// =============================================================================
+
+struct ReplayHeader
+{
+    GameMode mode = GameMode::FFA;
+    uint64_t seed = 0;
+    World::ShipTypes shipTypes = {};
+    float arenaWidth = World::DEFAULT_ARENA_WIDTH;
+    float arenaHeight = World::DEFAULT_ARENA_HEIGHT;
+    float physicsRate = 60.0f;  // config.simPhysicsRate when recorded
+    float aiRate = 20.0f;       // config.simAIRate when recorded
+    std::string version;        // Game version that recorded it
+
+    float getStepTime() const   { return 1.0f / std::max (1.0f, physicsRate); }
+};
+
+namespace Replay
+{
+    constexpr const char* fileExtension = ".hlr";
+
+    // Rounds an input to the precision stored in replays. The game feeds the
+    // world quantised inputs, so playback sees exactly what was simulated.
+    void quantise (ShipInput& input);
+}
+
+class ReplayRecorder
+{
+public:
+    void begin (const ReplayHeader& header);
+
+    // Appends one tick. Call with the inputs (already quantised) passed to World::update
+    void recordTick (const World::ShipInputs& inputs, float arenaWidth, float arenaHeight);
+
+    // Ends the recording. completed = false when the match was abandoned before a result
+    void finish (int winnerIndex, bool completed = true);
+
+    bool isRecording() const                { return recording; }
+    bool isFinished() const                 { return finished; }
+    uint32_t getNumTicks() const            { return numTicks; }
+    size_t getSizeInBytes() const           { return writer.size(); }
+
+    bool save (const std::string& path) const;
+
+private:
+    struct PackedInput
+    {
+        int32_t moveX = 0, moveY = 0, aimX = 0, aimY = 0;
+        int32_t crosshairX = 0, crosshairY = 0;
+        bool fire = false;
+        bool hasCrosshair = false;
+    };
+
+    ByteWriter writer;
+    std::array<PackedInput, World::MAX_SHIPS> previous = {};
+    uint32_t humanMask = 0;
+    float lastArenaWidth = 0.0f;
+    float lastArenaHeight = 0.0f;
+    uint32_t numTicks = 0;
+    bool recording = false;
+    bool finished = false;
+
+    friend class ReplayPlayer;
+    static PackedInput pack (const ShipInput& input);
+    static ShipInput unpack (const PackedInput& packed);
+};
+
+class ReplayPlayer
+{
+public:
+    bool load (const std::string& path);
+
+    const ReplayHeader& getHeader() const   { return header; }
+
+    // Fills in the inputs and arena size for the next tick.
+    // Returns false at the end of the recording (or if the data is damaged).
+    bool nextTick (World::ShipInputs& inputs, float& arenaWidth, float& arenaHeight);
+
+    // Back to the first tick
+    void rewind();
+
+    // Result stored at the end of the recording (only if the match was played to the end)
+    bool hasResult() const                  { return resultKnown; }
+    int getRecordedWinner() const           { return recordedWinner; }
+    uint32_t getRecordedTicks() const       { return recordedTicks; }
+
+private:
+    std::vector<uint8_t> bytes;
+    ByteReader reader;
+    size_t firstTickOffset = 0;
+
+    ReplayHeader header;
+    std::array<ReplayRecorder::PackedInput, World::MAX_SHIPS> previous = {};
+    uint32_t humanMask = 0;
+    float arenaWidth = 0.0f;
+    float arenaHeight = 0.0f;
+    bool ended = false;
+
+    bool resultKnown = false;
+    int recordedWinner = -1;
+    uint32_t recordedTicks = 0;
+};
@@ -1,7 +1,7 @@
 #include "Shell.h"
 
 Shell::Shell (Vec2 startPos, Vec2 vel, int owner, float range, float dmg)
-    : position (startPos), velocity (vel), ownerIndex (owner), damage (dmg)
+    : position (startPos), prevPosition (startPos), velocity (vel), ownerIndex (owner), damage (dmg)
 {
     // Calculate flight time based on range and initial speed
     float speed = vel.length();
@@ -10,6 +10,8 @@ Shell::Shell (Vec2 startPos, Vec2 vel, int owner, float range, float dmg)
 
 void Shell::update (float dt, Vec2 windDrift)
 {
+    prevPosition = position;
+
     if (landed)
         return;
 
@@ -27,3 +29,15 @@ void Shell::update (float dt, Vec2 windDrift)
         velocity = { 0, 0 };
     }
 }
+
+void Shell::hashState (StateHasher& hasher) const
+{
+    hasher.add ("position", position);
+    hasher.add ("velocity", velocity);
+    hasher.add ("owner", ownerIndex);
+    hasher.add ("damage", damage);
+    hasher.add ("alive", alive);
+    hasher.add ("landed", landed);
+    hasher.add ("flightTime", flightTime);
+    hasher.add ("maxFlightTime", maxFlightTime);
+}
@@ -1,16 +1,19 @@
 #pragma once
 
 #include "Config.h"
+#include "StateHash.h"
 #include "Vec2.h"
 
 class Shell
 {
 public:
+    Shell() = default;  // Placeholder slot in preallocated arrays (world snapshots)
     Shell (Vec2 startPos, Vec2 velocity, int ownerIndex, float maxRange, float damage);
 
     void update (float dt, Vec2 windDrift);
 
     Vec2 getPosition() const { return position; }
+    Vec2 getRenderPosition (float alpha) const { return Vec2::lerp (prevPosition, position, alpha); }
     Vec2 getVelocity() const { return velocity; }
     int getOwnerIndex() const { return ownerIndex; }
     float getRadius() const { return config.shellRadius; }
@@ -20,11 +23,14 @@ public:
     bool hasLanded() const { return landed; } // True when shell reaches target range
     void kill() { alive = false; }
 
+    void hashState (StateHasher& hasher) const;
+
 private:
     Vec2 position;
+    Vec2 prevPosition; // Position at the start of the last step (for render interpolation)
     Vec2 velocity;
-    int ownerIndex; // Which player fired this shell
-    float damage;   // Damage this shell deals on hit
+    int ownerIndex = -1;  // Which player fired this shell
+    float damage = 0.0f;  // Damage this shell deals on hit
     bool alive = true;
     bool landed = false; // True when shell reaches target range
     float flightTime = 0.0f;    // Time shell has been in flight
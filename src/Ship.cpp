@@ -3,18 +3,60 @@
 #include <algorithm>
 #include <cmath>
 
-Ship::Ship (int playerIndex_, Vec2 startPos, float startAngle, float shipLength, float shipWidth, int team_, int shipType_)
+namespace
+{
+    // The config's sink decays are per frame at this rate
+    constexpr float decayReferenceRate = 60.0f;
+
+    // Scales a decay to the step length. At the reference rate the exponent is exactly 1,
+    // so the decay is used as-is and existing recordings play back identically
+    float getDecayForStep (float decayPerStep, float dt)
+    {
+        return std::pow (decayPerStep, dt * decayReferenceRate);
+    }
+}
+
+Ship::Ship (Fleet& fleet, ParticlePool& particles_, int playerIndex_, Vec2 startPos, float startAngle, float shipLength, float shipWidth, int team_, int shipType_, uint64_t matchSeed,
+            std::pmr::memory_resource* memory)
     : playerIndex (playerIndex_), team (team_), shipType (std::clamp (shipType_, 0, NUM_SHIP_TYPES - 1)),
-      position (startPos), angle (startAngle),
+      position (fleet.position[playerIndex_]), velocity (fleet.velocity[playerIndex_]), angle (fleet.angle[playerIndex_]),
+      prevPosition (fleet.prevPosition[playerIndex_]), prevAngle (fleet.prevAngle[playerIndex_]),
+      angularVelocity (fleet.angularVelocity[playerIndex_]),
+      throttle (fleet.throttle[playerIndex_]), rudder (fleet.rudder[playerIndex_]),
+      crosshairOffset (fleet.crosshairOffset[playerIndex_]),
+      heading (fleet.heading[playerIndex_]), corners (fleet.corners[playerIndex_]),
+      health (fleet.health[playerIndex_]), sinking (fleet.sinking[playerIndex_]), sinkTimer (fleet.sinkTimer[playerIndex_]),
+      stats (fleet.stats[playerIndex_]),
       length (shipLength), width (shipWidth),
       turrets { {
-          Turret ({ 0.0f, 0.0f }, true),
-          Turret ({ 0.0f, 0.0f }, true),
-          Turret ({ 0.0f, 0.0f }, false),
-          Turret ({ 0.0f, 0.0f }, false)
-      } }
+          Turret (fleet, Fleet::getTurretSlot (playerIndex_, 0), { 0.0f, 0.0f }, true),
+          Turret (fleet, Fleet::getTurretSlot (playerIndex_, 1), { 0.0f, 0.0f }, true),
+          Turret (fleet, Fleet::getTurretSlot (playerIndex_, 2), { 0.0f, 0.0f }, false),
+          Turret (fleet, Fleet::getTurretSlot (playerIndex_, 3), { 0.0f, 0.0f }, false)
+      } },
+      particles (particles_),
+      hitLocations (memory),
+      pendingShells (memory),
+      firingRandom (matchSeed, RandomStream::ShipFiring, playerIndex_),
+      wakeRandom (matchSeed, RandomStream::ShipWake, playerIndex_),
+      smokeRandom (matchSeed, RandomStream::ShipSmoke, playerIndex_)
 {
+    // The fleet row may hold a ship from an earlier match
+    position = startPos;
+    velocity = {};
+    angle = startAngle;
+    prevPosition = startPos;
+    prevAngle = startAngle;
+    angularVelocity = 0.0f;
+    throttle = 0.0f;
+    rudder = 0.0f;
+    sinking = false;
+    sinkTimer = 0.0f;
+    fleet.boundingRadius[playerIndex] = 0.5f * std::sqrt (length * length + width * width);
+    updateTransform();
+
     // Initialize health based on ship type
+    stats = ShipStats::forType (shipType);
     health = getMaxHealth();
 
     // Configure turrets based on ship type
@@ -22,17 +64,32 @@ Ship::Ship (int playerIndex_, Vec2 startPos, float startAngle, float shipLength,
     for (int i = 0; i < typeConfig.numTurrets; ++i)
     {
         float offsetX = typeConfig.turrets[i].localOffsetX * length;
-        turrets[i] = Turret ({ offsetX, 0.0f }, typeConfig.turrets[i].isFront);
+        turrets[i].setMount ({ offsetX, 0.0f }, typeConfig.turrets[i].isFront);
         turrets[i].setReloadMultiplier (typeConfig.reloadMultiplier);
         turrets[i].setRotationSpeedMultiplier (typeConfig.turretSpeedMultiplier);
     }
 
     // Start crosshair in front of ship
-    crosshairOffset = Vec2::fromAngle (angle) * config.crosshairStartDistance;
+    crosshairOffset = heading * config.crosshairStartDistance;
+
+    // Both are bounded, so size them once rather than growing them mid-match
+    hitLocations.reserve (MAX_HIT_LOCATIONS + 1);
+    pendingShells.reserve ((size_t) typeConfig.numTurrets);
 }
 
-void Ship::update (float dt, Vec2 moveInput, Vec2 aimInput, bool fireInput, float arenaWidth, float arenaHeight, Vec2 wind, Vec2 current)
+size_t Ship::getMatchMemorySize()
 {
+    size_t maxTurrets = std::tuple_size_v<decltype (turrets)>;
+    return sizeof (Ship) + alignof (Ship)
+         + (MAX_HIT_LOCATIONS + 1) * sizeof (Vec2) + alignof (Vec2)
+         + maxTurrets * sizeof (Shell) + alignof (Shell);
+}
+
+void Ship::update (float dt, Vec2 moveInput, Vec2 aimInput, bool fireInput, float arenaWidth, float arenaHeight, Vec2 current)
+{
+    prevPosition = position;
+    prevAngle = angle;
+
     // Handle sinking
     if (isSinking())
     {
@@ -41,28 +98,26 @@ void Ship::update (float dt, Vec2 moveInput, Vec2 aimInput, bool fireInput, floa
             sinkTimer = config.shipSinkDuration; // Cap to prevent alpha wraparound
 
         // Slow down while sinking
-        velocity *= config.shipSinkVelocityDecay;
-        angularVelocity *= config.shipSinkAngularDecay;
-        
+        velocity *= getDecayForStep (config.shipSinkVelocityDecay, dt);
+        angularVelocity *= getDecayForStep (config.shipSinkAngularDecay, dt);
+
         // Update position
         position += velocity * dt;
+        updateCorners();
 
         // Clamp to arena
         clampToArena (arenaWidth, arenaHeight);
 
         // Still update smoke and bubbles while sinking
-        updateSmoke (dt, wind);
-        updateBubbles (dt);
+        updateCosmetics (dt);
         return; // Don't process any other input while sinking
     }
 
     // Calculate damage penalty (up to configured reduction in speed and turning)
-    float damagePercent = getDamagePercent();
-    float damagePenalty = 1.0f - (damagePercent * config.shipDamagePenaltyMax);
+    float damagePenalty = stats.damagePenalty;
 
     // Get ship type multipliers
     const auto& typeConfig = config.shipTypes[shipType];
-    float speedMult = typeConfig.speedMultiplier;
     float turnMult = typeConfig.turnMultiplier;
 
     // Fire if requested (turrets handle their own reload timers)
@@ -103,8 +158,8 @@ void Ship::update (float dt, Vec2 moveInput, Vec2 aimInput, bool fireInput, floa
     }
 
     // Apply throttle to velocity (reduced by damage, modified by ship type)
-    Vec2 forward = Vec2::fromAngle (angle);
-    float effectiveMaxSpeed = config.shipMaxSpeed * damagePenalty * speedMult;
+    Vec2 forward = heading;
+    float effectiveMaxSpeed = stats.maxSpeed * damagePenalty;
     float effectiveThrottle = throttle;
     if (throttle < 0)
         effectiveThrottle = throttle * config.shipReverseSpeedMultiplier; // Reverse is slower
@@ -167,6 +222,7 @@ void Ship::update (float dt, Vec2 moveInput, Vec2 aimInput, bool fireInput, floa
     // Update position (include current drift)
     Vec2 currentDrift = current * config.currentShipEffect;
     position += (velocity + currentDrift) * dt;
+    updateTransform();
 
     // Clamp to arena
     clampToArena (arenaWidth, arenaHeight);
@@ -195,8 +251,8 @@ void Ship::update (float dt, Vec2 moveInput, Vec2 aimInput, bool fireInput, floa
 
     // Update turrets to aim at crosshair from their individual positions
     crosshairWorldPos = position + crosshairOffset;
-    float cosA = std::cos (angle);
-    float sinA = std::sin (angle);
+    float cosA = heading.x;
+    float sinA = heading.y;
 
     int numTurrets = getNumTurrets();
     for (int i = 0; i < numTurrets; ++i)
@@ -213,23 +269,18 @@ void Ship::update (float dt, Vec2 moveInput, Vec2 aimInput, bool fireInput, floa
         turret.update (dt, angle, aimDir);
     }
 
-    // Update bubble trail
-    updateBubbles (dt);
-
-    // Update smoke
-    updateSmoke (dt, wind);
+    // Update bubble trail and smoke
+    updateCosmetics (dt);
 }
 
 void Ship::clampToArena (float arenaWidth, float arenaHeight)
 {
-    // Get actual corners of the rotated ship
-    auto corners = getCorners();
-
-    // Find how far each corner is outside the arena
+    // Find how far each corner of the rotated ship is outside the arena
     float pushLeft = 0.0f, pushRight = 0.0f, pushUp = 0.0f, pushDown = 0.0f;
 
-    for (const auto& corner : corners)
+    for (int i = 0; i < 4; ++i)
     {
+        Vec2 corner = corners[i];
         if (corner.x < 0)
             pushLeft = std::max (pushLeft, -corner.x);
         if (corner.x > arenaWidth)
@@ -262,6 +313,9 @@ void Ship::clampToArena (float arenaWidth, float arenaHeight)
         position.y -= pushDown;
         velocity.y = -std::abs (velocity.y) * 0.3f;
     }
+
+    if (pushLeft > 0 || pushRight > 0 || pushUp > 0 || pushDown > 0)
+        updateCorners();
 }
 
 Color Ship::getColor() const
@@ -299,15 +353,15 @@ void Ship::takeDamage (float damage, Vec2 hitWorldPos)
     if (hitWorldPos.x != 0 || hitWorldPos.y != 0)
     {
         Vec2 localHit;
-        float cosA = std::cos (-angle);  // Negative angle to rotate world->local
-        float sinA = std::sin (-angle);
+        float cosA = heading.x;     // Negative angle to rotate world->local
+        float sinA = -heading.y;
         Vec2 diff = hitWorldPos - position;
         localHit.x = diff.x * cosA - diff.y * sinA;
         localHit.y = diff.x * sinA + diff.y * cosA;
         hitLocations.push_back (localHit);
 
         // Limit stored hits to prevent unbounded growth
-        if (hitLocations.size() > 20)
+        if (hitLocations.size() > MAX_HIT_LOCATIONS)
             hitLocations.erase (hitLocations.begin());
     }
 
@@ -318,12 +372,21 @@ void Ship::takeDamage (float damage, Vec2 hitWorldPos)
         sinking = true;
         sinkTimer = 0.0f;
     }
+
+    stats.setHealth (health);
+}
+
+void Ship::refreshStats()
+{
+    stats = ShipStats::forType (shipType);
+    stats.setHealth (health);
 }
 
 void Ship::applyCollision (Vec2 pushDirection, float pushDistance, Vec2 myVel, Vec2 otherVel)
 {
     // Push apart to resolve overlap
     position += pushDirection * pushDistance;
+    updateCorners();
 
     // Calculate collision response using elastic collision formula
     // For equal mass objects: v1' = v2 and v2' = v1 along collision normal
@@ -351,37 +414,28 @@ void Ship::applyCollision (Vec2 pushDirection, float pushDistance, Vec2 myVel, V
     }
 }
 
-std::array<Vec2, 4> Ship::getCorners() const
+void Ship::updateTransform()
+{
+    heading = Vec2::fromAngle (angle);
+    updateCorners();
+}
+
+void Ship::updateCorners()
 {
     float halfLength = length / 2.0f;
     float halfWidth = width / 2.0f;
 
-    float cosA = std::cos (angle);
-    float sinA = std::sin (angle);
-
-    // Local corners (unrotated)
-    Vec2 corners[4] = {
-        { -halfLength, -halfWidth }, // Back-left
-        { halfLength, -halfWidth }, // Front-left
-        { halfLength, halfWidth }, // Front-right
-        { -halfLength, halfWidth } // Back-right
-    };
-
-    // Rotate and translate to world coordinates
-    std::array<Vec2, 4> worldCorners;
-    for (int i = 0; i < 4; ++i)
-    {
-        worldCorners[i].x = position.x + corners[i].x * cosA - corners[i].y * sinA;
-        worldCorners[i].y = position.y + corners[i].x * sinA + corners[i].y * cosA;
-    }
+    // Back-left, front-left, front-right, back-right, unrotated
+    Vec2x4 local = { { -halfLength, halfLength, halfLength, -halfLength },
+                     { -halfWidth, -halfWidth, halfWidth, halfWidth } };
 
-    return worldCorners;
+    corners = Vec2x4::transform (local, position, heading);
 }
 
 bool Ship::fireShells()
 {
-    float cosA = std::cos (angle);
-    float sinA = std::sin (angle);
+    float cosA = heading.x;
+    float sinA = heading.y;
     float shellSpeed = config.shipMaxSpeed * config.shellSpeedMultiplier;
     bool firedAny = false;
 
@@ -424,11 +478,11 @@ bool Ship::fireShells()
             Vec2 barrelTip = turretPos + fireDir * barrelLength + perpDir * sideOffset;
 
             // Apply random range variation (per shell)
-            float rangeVariation = ((float) rand() / RAND_MAX - 0.5f) * 2.0f * config.shellRangeVariation;
+            float rangeVariation = firingRandom.nextSigned() * config.shellRangeVariation;
             float shellRange = targetRange * (1.0f + rangeVariation);
 
             // Apply random angle spread (per shell)
-            float spreadAngle = ((float) rand() / RAND_MAX - 0.5f) * 2.0f * config.shellSpread;
+            float spreadAngle = firingRandom.nextSigned() * config.shellSpread;
             float shellAngle = fireAngle + spreadAngle;
 
             // Shell fires in direction turret is facing (with spread)
@@ -437,6 +491,7 @@ bool Ship::fireShells()
                           + velocity * config.shellShipVelocityFactor;
 
             pendingShells.push_back (Shell (barrelTip, shellVel, playerIndex, shellRange, getShellDamage()));
+            shotsFired++;
         }
 
         turret.fire();
@@ -479,6 +534,17 @@ bool Ship::isReadyToFire() const
     return false;
 }
 
+float Ship::getRenderAngle (float alpha) const
+{
+    // Take the short way round when the angle wraps at +/- PI
+    float delta = angle - prevAngle;
+    if (delta > pi)
+        delta -= 2.0f * pi;
+    else if (delta < -pi)
+        delta += 2.0f * pi;
+    return prevAngle + delta * alpha;
+}
+
 float Ship::getReloadProgress() const
 {
     // Return the progress of the slowest turret (minimum progress)
@@ -489,20 +555,19 @@ float Ship::getReloadProgress() const
     return minProgress;
 }
 
-void Ship::updateBubbles (float dt)
+void Ship::updateCosmetics (float dt)
 {
-    float speed = velocity.length();
-    float fadeRate = 1.0f / config.bubbleFadeTime;
+    if (! cosmeticsEnabled)
+        return;
 
-    // Fade and remove old bubbles
-    for (auto it = bubbles.begin(); it != bubbles.end();)
-    {
-        it->alpha -= fadeRate * dt;
-        if (it->alpha <= 0.0f)
-            it = bubbles.erase (it);
-        else
-            ++it;
-    }
+    // The world fades, moves and retires them, the ship just adds new ones
+    spawnBubbles (dt);
+    spawnSmoke (dt);
+}
+
+void Ship::spawnBubbles (float dt)
+{
+    float speed = velocity.length();
 
     // Spawn new bubbles at the rear of the ship when moving or throttle applied
     if (isVisible() && (speed > config.bubbleMinSpeed || (isAlive() && std::abs (throttle) > 0.1f)))
@@ -518,44 +583,24 @@ void Ship::updateBubbles (float dt)
             bubbleSpawnTimer -= spawnRate;
 
             // Spawn position at rear of ship with some randomness
-            Vec2 backward = Vec2::fromAngle (angle + pi);
+            Vec2 backward = heading * -1.0f;
             Vec2 spawnPos = position + backward * (length * 0.5f);
 
             // Add some random offset perpendicular to ship direction
-            float perpOffset = ((float) rand() / RAND_MAX - 0.5f) * width * 0.8f;
-            Vec2 perp = Vec2::fromAngle (angle + pi * 0.5f);
+            float perpOffset = (wakeRandom.nextFloat() - 0.5f) * width * 0.8f;
+            Vec2 perp = { -heading.y, heading.x };
             spawnPos += perp * perpOffset;
 
             // Random bubble size
-            float bubbleRadius = config.bubbleMinRadius + ((float) rand() / RAND_MAX) * config.bubbleRadiusVariation;
+            float bubbleRadius = config.bubbleMinRadius + wakeRandom.nextFloat() * config.bubbleRadiusVariation;
 
-            bubbles.push_back ({ spawnPos, bubbleRadius, 1.0f });
+            particles.spawnBubble (playerIndex, spawnPos, bubbleRadius);
         }
     }
 }
 
-void Ship::updateSmoke (float dt, Vec2 wind)
+void Ship::spawnSmoke (float dt)
 {
-    // Update existing smoke - fade and move with wind
-    for (auto it = smoke.begin(); it != smoke.end();)
-    {
-        it->alpha -= it->fadeRate * dt;
-
-        // Apply wind with this particle's fixed angle offset
-        float cosR = std::cos (it->windAngleOffset);
-        float sinR = std::sin (it->windAngleOffset);
-        Vec2 dispersedWind;
-        dispersedWind.x = wind.x * cosR - wind.y * sinR;
-        dispersedWind.y = wind.x * sinR + wind.y * cosR;
-
-        it->position += dispersedWind * config.smokeWindStrength * dt;
-
-        if (it->alpha <= 0.0f)
-            it = smoke.erase (it);
-        else
-            ++it;
-    }
-
     // Spawn new smoke - all ships make some engine smoke, damaged ships make more
     // Sinking ships produce less and less smoke
     float damagePercent = getDamagePercent();
@@ -575,14 +620,14 @@ void Ship::updateSmoke (float dt, Vec2 wind)
 
         // Spawn position depends on damage level
         Vec2 spawnPos;
-        float cosA = std::cos (angle);
-        float sinA = std::sin (angle);
+        float cosA = heading.x;
+        float sinA = heading.y;
 
         if (damagePercent < 0.3f)
         {
             // Light/no damage: smoke from smoke stacks
             const auto& shipTypeConfig = config.shipTypes[shipType];
-            int stackIdx = rand() % shipTypeConfig.numSmokeStacks;
+            int stackIdx = smokeRandom.nextInt (shipTypeConfig.numSmokeStacks);
             float stackOffset = shipTypeConfig.smokeStackOffsets[stackIdx] * length;
             spawnPos.x = position.x + stackOffset * cosA;
             spawnPos.y = position.y + stackOffset * sinA;
@@ -590,12 +635,12 @@ void Ship::updateSmoke (float dt, Vec2 wind)
         else if (!hitLocations.empty())
         {
             // Heavy damage: smoke from random hit locations with some variation
-            int hitIdx = rand() % hitLocations.size();
+            int hitIdx = smokeRandom.nextInt ((int) hitLocations.size());
             Vec2 localHit = hitLocations[hitIdx];
 
             // Add random offset but clamp to stay on ship
-            float offsetX = ((float) rand() / RAND_MAX - 0.5f) * 10.0f;
-            float offsetY = ((float) rand() / RAND_MAX - 0.5f) * 6.0f;
+            float offsetX = (smokeRandom.nextFloat() - 0.5f) * 10.0f;
+            float offsetY = (smokeRandom.nextFloat() - 0.5f) * 6.0f;
             localHit.x = std::clamp (localHit.x + offsetX, -length * 0.4f, length * 0.4f);
             localHit.y = std::clamp (localHit.y + offsetY, -width * 0.3f, width * 0.3f);
 
@@ -605,26 +650,65 @@ void Ship::updateSmoke (float dt, Vec2 wind)
         else
         {
             // Fallback: smoke from random locations across ship
-            float randomX = ((float) rand() / RAND_MAX - 0.5f) * length * 0.8f;
-            float randomY = ((float) rand() / RAND_MAX - 0.5f) * width * 0.6f;
+            float randomX = (smokeRandom.nextFloat() - 0.5f) * length * 0.8f;
+            float randomY = (smokeRandom.nextFloat() - 0.5f) * width * 0.6f;
             spawnPos.x = position.x + randomX * cosA - randomY * sinA;
             spawnPos.y = position.y + randomX * sinA + randomY * cosA;
         }
 
         // Smoke size: small wisps for undamaged, bigger with damage
         float baseRadius = config.smokeBaseRadius + damagePercent * 2.0f;
-        float smokeRadius = baseRadius + ((float) rand() / RAND_MAX) * 1.5f;
+        float smokeRadius = baseRadius + smokeRandom.nextFloat() * 1.5f;
 
         // Lower starting alpha for thinner smoke, reduce further when sinking
         float startAlpha = (config.smokeBaseAlpha + damagePercent * 0.4f) * sinkFactor;
 
         // Random fade rate based on lifetime range
-        float lifetime = config.smokeFadeTimeMin + ((float) rand() / RAND_MAX) * (config.smokeFadeTimeMax - config.smokeFadeTimeMin);
+        float lifetime = smokeRandom.nextFloat (config.smokeFadeTimeMin, config.smokeFadeTimeMax);
         float fadeRate = 1.0f / lifetime;
 
         // Random wind angle offset
-        float windAngleOffset = ((float) rand() / RAND_MAX - 0.5f) * config.smokeWindAngleVariation;
+        float windAngleOffset = (smokeRandom.nextFloat() - 0.5f) * config.smokeWindAngleVariation;
+
+        particles.spawnSmoke (playerIndex, { spawnPos, smokeRadius, startAlpha, fadeRate, windAngleOffset });
+    }
+}
 
-        smoke.push_back ({ spawnPos, smokeRadius, startAlpha, fadeRate, windAngleOffset });
+void Ship::getState (State& state) const
+{
+    state.damageDealt = damageDealt;
+    state.shotsFired = shotsFired;
+    state.firingRandom = firingRandom;
+}
+
+void Ship::setState (const State& state)
+{
+    damageDealt = state.damageDealt;
+    shotsFired = state.shotsFired;
+    firingRandom = state.firingRandom;
+
+    pendingShells.clear();
+}
+
+void Ship::hashState (StateHasher& hasher) const
+{
+    hasher.add ("position", position);
+    hasher.add ("velocity", velocity);
+    hasher.add ("angle", angle);
+    hasher.add ("angularVelocity", angularVelocity);
+    hasher.add ("throttle", throttle);
+    hasher.add ("rudder", rudder);
+    hasher.add ("crosshairOffset", crosshairOffset);
+    hasher.add ("health", health);
+    hasher.add ("damageDealt", damageDealt);
+    hasher.add ("sinking", sinking);
+    hasher.add ("sinkTimer", sinkTimer);
+    hasher.add ("firingRandom", firingRandom.getState());
+
+    for (int i = 0; i < getNumTurrets(); ++i)
+    {
+        hasher.setItem (i);
+        turrets[i].hashState (hasher);
     }
+    hasher.setItem (-1);
 }
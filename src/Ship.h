@@ -1,57 +1,55 @@
 #pragma once
 
 #include "Config.h"
+#include "Fleet.h"
+#include "ParticlePool.h"
+#include "Random.h"
 #include "Shell.h"
 #include "Turret.h"
 #include "Vec2.h"
 #include <raylib.h>
 #include <array>
+#include <memory_resource>
 #include <vector>
 
-struct Bubble
-{
-    Vec2 position;
-    float radius;
-    float alpha; // 0.0 to 1.0
-};
-
-struct Smoke
-{
-    Vec2 position;
-    float radius;
-    float alpha; // 0.0 to 1.0
-    float fadeRate; // Alpha reduction per second
-    float windAngleOffset; // Random offset added to wind direction
-};
-
 class Ship
 {
 public:
-    Ship (int playerIndex, Vec2 startPos, float startAngle, float shipLength, float shipWidth, int team = -1, int shipType = 3);  // team: -1=FFA, 0=team1, 1=team2; shipType: 0-3
+    static constexpr int MAX_HIT_LOCATIONS = 20;  // Kept for damage smoke
+
+    // team: -1=FFA, 0=team1, 1=team2; shipType: 0-3. The ship's moving state lives in row
+    // playerIndex of fleet, its wake and smoke go into particles, and its buffers are allocated from memory
+    Ship (Fleet& fleet, ParticlePool& particles, int playerIndex, Vec2 startPos, float startAngle, float shipLength, float shipWidth, int team = -1, int shipType = 3, uint64_t matchSeed = 0,
+          std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+    // Roughly what a ship and its buffers take from its memory resource
+    static size_t getMatchMemorySize();
 
-    void update (float dt, Vec2 moveInput, Vec2 aimInput, bool fireInput, float arenaWidth, float arenaHeight, Vec2 wind, Vec2 current);
+    void update (float dt, Vec2 moveInput, Vec2 aimInput, bool fireInput, float arenaWidth, float arenaHeight, Vec2 current);
 
     Vec2 getPosition() const                        { return position; }
     float getAngle() const                          { return angle; }
+    Vec2 getHeading() const                         { return heading; }  // cos, sin of the angle
+    Vec2 getRenderPosition (float alpha) const      { return Vec2::lerp (prevPosition, position, alpha); }
+    float getRenderAngle (float alpha) const;  // Interpolated between the last two steps (alpha 0-1)
     float getLength() const                         { return length; }
     float getWidth() const                          { return width; }
-    float getMaxSpeed() const                       { return config.shipMaxSpeed * config.shipTypes[shipType].speedMultiplier; }
+    float getMaxSpeed() const                       { return stats.maxSpeed; }
     int getPlayerIndex() const                      { return playerIndex; }
     int getTeam() const                             { return team; }  // -1=FFA, 0=team1, 1=team2
     int getShipType() const                         { return shipType; }  // 0-3 (1-4 turrets)
     int getNumTurrets() const                       { return config.shipTypes[shipType].numTurrets; }
-    const std::array<Turret, 4>& getTurrets() const { return turrets; }
+    const std::array<Turret, Fleet::MAX_TURRETS>& getTurrets() const { return turrets; }
     Vec2 getCrosshairPosition() const               { return position + crosshairOffset; }
     void setCrosshairPosition (Vec2 worldPos);  // For mouse aiming
-    const std::vector<Bubble>& getBubbles() const   { return bubbles; }
-    const std::vector<Smoke>& getSmoke() const      { return smoke; }
-    float getDamagePercent() const                  { return 1.0f - (health / getMaxHealth()); }
-    std::vector<Shell>& getPendingShells()          { return pendingShells; }
+    void setCosmeticsEnabled (bool enabled)   { cosmeticsEnabled = enabled; }  // Off skips bubbles and smoke entirely (fast-forward, headless)
+    float getDamagePercent() const                  { return stats.damagePercent; }
+    std::pmr::vector<Shell>& getPendingShells()     { return pendingShells; }
     Color getColor() const;
 
     // Health system
     float getHealth() const         { return health; }
-    float getMaxHealth() const      { return config.shipMaxHealth * config.shipTypes[shipType].healthMultiplier; }
+    float getMaxHealth() const      { return stats.maxHealth; }
     bool isAlive() const            { return health > 0; }
     bool isVisible() const          { return isAlive() || isSinking(); }
     bool isSinking() const          { return sinking && sinkTimer < config.shipSinkDuration; }
@@ -59,18 +57,22 @@ public:
     float getSinkProgress() const   { return sinking ? sinkTimer / config.shipSinkDuration : 0.0f; }
     void takeDamage (float damage, Vec2 hitWorldPos = { 0, 0 });
 
+    // Rebakes the stats from the config, after it has been reloaded
+    void refreshStats();
+
     // Combat stats
-    float getMaxRange() const       { return config.maxShellRange * config.shipTypes[shipType].rangeMultiplier; }
-    float getMinRange() const       { return config.minShellRange * config.shipTypes[shipType].rangeMultiplier; }
-    float getShellDamage() const    { return config.shellDamage * config.shipTypes[shipType].damageMultiplier; }
+    float getMaxRange() const       { return stats.maxRange; }
+    float getMinRange() const       { return stats.minRange; }
+    float getShellDamage() const    { return stats.shellDamage; }
     float getDamageDealt() const    { return damageDealt; }
     void addDamageDealt (float damage) { damageDealt += damage; }
+    int getShotsFired() const       { return shotsFired; }
 
     // Collision
     Vec2 getVelocity() const        { return velocity; }
     float getSpeed() const          { return velocity.length(); }
     void applyCollision (Vec2 pushDirection, float pushDistance, Vec2 myVel, Vec2 otherVel);
-    std::array<Vec2, 4> getCorners() const; // Get 4 corners for OBB collision
+    const Vec2x4& getCorners() const { return corners; }  // Hull rectangle for OBB collision, as the ship is now
 
     // HUD info
     float getThrottle() const       { return throttle; }
@@ -80,49 +82,72 @@ public:
     bool isReadyToFire() const; // True if reloaded AND turrets on target AND in range
     bool isCrosshairInRange() const { return crosshairOffset.length() >= getMinRange(); }
 
+    // Gameplay state only - bubbles and smoke are cosmetic and left out
+    void hashState (StateHasher& hasher) const;
+
+    // What changes during a match besides the fleet row and the cosmetics, for world snapshots
+    struct State
+    {
+        float damageDealt = 0.0f;
+        int shotsFired = 0;
+        Random firingRandom;
+    };
+
+    void getState (State& state) const;
+    void setState (const State& state);
+
 private:
     int playerIndex;
     int team;  // -1=FFA, 0=team1, 1=team2
     int shipType;  // 0-3 (determines turret count and stats)
-    Vec2 position;
-    Vec2 velocity;
-    float angle = 0.0f; // Ship facing direction (radians)
-    float angularVelocity = 0.0f;
+
+    // Moving state, in this ship's row of the fleet
+    Vec2& position;
+    Vec2& velocity;
+    float& angle; // Ship facing direction (radians)
+    Vec2& prevPosition; // State at the start of the last step, for render interpolation
+    float& prevAngle;
+    float& angularVelocity;
+    float& throttle; // -1 to 1 (current throttle position)
+    float& rudder; // -1 to 1 (current rudder position)
+    Vec2& crosshairOffset; // Offset from ship position (moves with aim stick)
+    Vec2& heading;
+    Vec2x4& corners;
+    float& health;
+    bool& sinking;
+    float& sinkTimer;
+    ShipStats& stats;
 
     float length;
     float width;
 
-    float throttle = 0.0f; // -1 to 1 (current throttle position)
-    float rudder = 0.0f; // -1 to 1 (current rudder position)
-
-    Vec2 crosshairOffset; // Offset from ship position (moves with aim stick)
-
-    std::array<Turret, 4> turrets;
+    std::array<Turret, Fleet::MAX_TURRETS> turrets;
 
-    std::vector<Bubble> bubbles;
+    ParticlePool& particles;
     float bubbleSpawnTimer = 0.0f;
-
-    std::vector<Smoke> smoke;
     float smokeSpawnTimer = 0.0f;
+    bool cosmeticsEnabled = true;
 
     // Hit locations in local ship coordinates (for damage smoke)
-    std::vector<Vec2> hitLocations;
-
-    // Health (initialized in constructor based on ship type)
-    float health;
+    std::pmr::vector<Vec2> hitLocations;
 
     // Damage tracking
     float damageDealt = 0.0f;
-
-    // Sinking
-    bool sinking = false;
-    float sinkTimer = 0.0f;
+    int shotsFired = 0;  // Shells, not salvos
 
     // Shooting
-    std::vector<Shell> pendingShells; // Shells to be added to game
+    std::pmr::vector<Shell> pendingShells; // Shells to be added to game
+
+    // Random streams (seeded from the match seed and player index)
+    Random firingRandom;
+    Random wakeRandom;
+    Random smokeRandom;
 
+    void updateTransform();     // After the angle changes
+    void updateCorners();       // After the position changes
     void clampToArena (float arenaWidth, float arenaHeight);
-    void updateBubbles (float dt);
-    void updateSmoke (float dt, Vec2 wind);
+    void updateCosmetics (float dt);
+    void spawnBubbles (float dt);
+    void spawnSmoke (float dt);
     bool fireShells(); // Returns true if any shells were fired
 };
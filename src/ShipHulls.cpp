@@ -0,0 +1,161 @@
+#include "ShipHulls.h"
+#include "Platform.h"
+#include "Ship.h"
+#include <algorithm>
+#include <cmath>
+
+ShipHulls::ShipHulls()
+{
+    // ship1.png (1 turret) through ship4.png (4 turrets)
+    const char* hullPaths[NUM_SHIP_TYPES] = {
+        "assets/ships/ship1.png",
+        "assets/ships/ship2.png",
+        "assets/ships/ship3.png",
+        "assets/ships/ship4.png"
+    };
+
+    loaded = true;
+
+    for (int i = 0; i < NUM_SHIP_TYPES; ++i)
+    {
+        Image hullImage = LoadImage (Platform::getResourcePath (hullPaths[i]).c_str());
+        if (hullImage.data == nullptr)
+        {
+            TraceLog (LOG_WARNING, "Failed to load ship hull image: %s", hullPaths[i]);
+            loaded = false;
+            continue;
+        }
+
+        int newWidth = (int) (hullImage.width * textureScale);
+        int newHeight = (int) (hullImage.height * textureScale);
+        ImageResize (&hullImage, newWidth, newHeight);
+        images[i] = hullImage;
+
+        // Bake the alpha channel into a solid/empty mask so hit tests don't decode pixel formats
+        Mask& mask = masks[i];
+        mask.width = hullImage.width;
+        mask.height = hullImage.height;
+        mask.solid.resize ((size_t) (mask.width * mask.height));
+        for (int y = 0; y < mask.height; ++y)
+            for (int x = 0; x < mask.width; ++x)
+                mask.solid[(size_t) (y * mask.width + x)] = GetImageColor (hullImage, x, y).a > 0 ? 1 : 0;
+    }
+}
+
+ShipHulls::~ShipHulls()
+{
+    for (auto& image : images)
+        if (image.data != nullptr)
+            UnloadImage (image);
+}
+
+const Image& ShipHulls::getHullImage (int shipType) const
+{
+    return images[std::clamp (shipType, 0, NUM_SHIP_TYPES - 1)];
+}
+
+float ShipHulls::getShipLength (int shipType) const
+{
+    // Ship length is the hull image height (bow points up in image)
+    int idx = std::clamp (shipType, 0, NUM_SHIP_TYPES - 1);
+    if (loaded && masks[idx].height > 0)
+        return (float) masks[idx].height;
+    return 100.0f; // Fallback
+}
+
+float ShipHulls::getShipWidth (int shipType) const
+{
+    // Ship width is the hull image width
+    int idx = std::clamp (shipType, 0, NUM_SHIP_TYPES - 1);
+    if (loaded && masks[idx].width > 0)
+        return (float) masks[idx].width;
+    return 25.0f; // Fallback
+}
+
+bool ShipHulls::checkShipHit (const Ship& ship, Vec2 worldPos) const
+{
+    if (! loaded)
+        return true; // Fallback to always hit if no hull images
+
+    const Mask& mask = masks[ship.getShipType()];
+    if (mask.solid.empty())
+        return true; // Fallback
+
+    // Transform world position to ship-local coordinates
+    Vec2 shipPos = ship.getPosition();
+    float cosA = ship.getHeading().x;
+    float sinA = ship.getHeading().y;
+
+    float dx = worldPos.x - shipPos.x;
+    float dy = worldPos.y - shipPos.y;
+
+    // Rotate to ship-local (X = forward toward bow, Y = starboard)
+    float localX = dx * cosA + dy * sinA;
+    float localY = -dx * sinA + dy * cosA;
+
+    // Convert to image coordinates
+    // Image has bow pointing UP, so:
+    // - imageX corresponds to ship's Y (starboard)
+    // - imageY corresponds to -ship's X (bow is up = negative Y in image)
+    float imgCenterX = mask.width / 2.0f;
+    float imgCenterY = mask.height / 2.0f;
+
+    int imageX = (int) (imgCenterX + localY);
+    int imageY = (int) (imgCenterY - localX);
+
+    // Check bounds
+    if (imageX < 0 || imageX >= mask.width || imageY < 0 || imageY >= mask.height)
+        return false; // Outside image bounds = miss
+
+    return isSolid (mask, imageX, imageY);
+}
+
+bool ShipHulls::checkShipCollision (const Ship& shipA, const Ship& shipB, Vec2& collisionPoint) const
+{
+    if (! loaded)
+        return false;
+
+    const Mask& maskA = masks[shipA.getShipType()];
+    if (maskA.solid.empty())
+        return false;
+
+    // Quick bounding check first
+    Vec2 posA = shipA.getPosition();
+    Vec2 posB = shipB.getPosition();
+    float maxDist = (shipA.getLength() + shipB.getLength()) / 2.0f;
+    if ((posA - posB).length() > maxDist)
+        return false;
+
+    // Sample points along ship A's hull outline and check against ship B
+    float cosA = shipA.getHeading().x;
+    float sinA = shipA.getHeading().y;
+
+    // Scan through ship A's mask and check solid pixels against ship B
+    int stepSize = 2; // Check every 2nd pixel for performance
+    for (int iy = 0; iy < maskA.height; iy += stepSize)
+    {
+        for (int ix = 0; ix < maskA.width; ix += stepSize)
+        {
+            if (! isSolid (maskA, ix, iy))
+                continue; // Skip transparent pixels
+
+            // Convert image coords to ship-local coords
+            float localX = (maskA.height / 2.0f) - iy; // Forward direction
+            float localY = ix - (maskA.width / 2.0f);  // Starboard direction
+
+            // Convert to world coords
+            Vec2 worldPos;
+            worldPos.x = posA.x + localX * cosA - localY * sinA;
+            worldPos.y = posA.y + localX * sinA + localY * cosA;
+
+            // Check if this point hits ship B
+            if (checkShipHit (shipB, worldPos))
+            {
+                collisionPoint = worldPos;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
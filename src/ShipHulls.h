@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Config.h"
+#include "Vec2.h"
+#include <raylib.h>
+#include <array>
+#include <vector>
+
+class Ship;
+
+// Hull silhouettes for each ship type. Provides ship dimensions and
+// pixel-perfect hit testing. Images are decoded on the CPU only, so this
+// works without a window or GPU (headless simulation).
+class ShipHulls
+{
+public:
+    ShipHulls();
+    ~ShipHulls();
+
+    ShipHulls (const ShipHulls&) = delete;
+    ShipHulls& operator= (const ShipHulls&) = delete;
+
+    bool isLoaded() const { return loaded; }
+
+    // Scaled hull image (bow pointing up), for the renderer to build textures from
+    const Image& getHullImage (int shipType) const;
+
+    // Ship dimensions from the hull images
+    float getShipLength (int shipType) const;
+    float getShipWidth (int shipType) const;
+
+    // Pixel-perfect hit testing
+    bool checkShipHit (const Ship& ship, Vec2 worldPos) const;
+    bool checkShipCollision (const Ship& shipA, const Ship& shipB, Vec2& collisionPoint) const;
+
+    // Scale factor applied to all ship textures on load
+    static constexpr float textureScale = 0.5f;
+
+private:
+    struct Mask
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> solid; // 1 where the hull pixel is not fully transparent
+    };
+
+    std::array<Image, NUM_SHIP_TYPES> images = {};
+    std::array<Mask, NUM_SHIP_TYPES> masks;
+    bool loaded = false;
+
+    bool isSolid (const Mask& mask, int x, int y) const { return mask.solid[(size_t) (y * mask.width + x)] != 0; }
+};
@@ -0,0 +1,28 @@
+#include "ShipStats.h"
+#include "Config.h"
+
+ShipStats ShipStats::forType (int shipType)
+{
+    const ShipType& type = config.shipTypes[shipType];
+
+    ShipStats stats;
+    stats.maxSpeed = config.shipMaxSpeed * type.speedMultiplier;
+    stats.maxHealth = config.shipMaxHealth * type.healthMultiplier;
+    stats.maxRange = config.maxShellRange * type.rangeMultiplier;
+    stats.minRange = config.minShellRange * type.rangeMultiplier;
+    stats.shellDamage = config.shellDamage * type.damageMultiplier;
+    stats.setHealth (stats.maxHealth);
+    return stats;
+}
+
+bool ShipStats::isAffectedBy (const ConfigChanges& changes)
+{
+    // The sections holding the base values above and the damage penalty
+    return changes.has ("shipPhysics") || changes.has ("shipHealth") || changes.has ("shells");
+}
+
+void ShipStats::setHealth (float health)
+{
+    damagePercent = 1.0f - (health / maxHealth);
+    damagePenalty = 1.0f - (damagePercent * config.shipDamagePenaltyMax);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+struct ConfigChanges;
+
+// =============================================================================
+// ShipStats
+// A ship's figures with the config's base values and its type's multipliers
+// already multiplied out, plus what its damage currently costs it. Each ship
+// keeps one in its fleet row: baked from its type when it's built and again
+// when the config is reloaded, with the damage part redone whenever the ship
+// is hit. The getters the AI, turrets, firing and HUD call every frame then
+// read one value instead of reaching into the config twice.
+// =============================================================================
+
+struct ShipStats
+{
+    // From the config and the ship type
+    float maxSpeed = 0.0f;
+    float maxHealth = 1.0f;
+    float maxRange = 0.0f;
+    float minRange = 0.0f;
+    float shellDamage = 0.0f;
+
+    // From the ship's health
+    float damagePercent = 0.0f;     // 0 undamaged, 1 sunk
+    float damagePenalty = 1.0f;     // What's left of speed and turning
+
+    static ShipStats forType (int shipType);  // Undamaged
+    static bool isAffectedBy (const ConfigChanges& changes);
+
+    void setHealth (float health);
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// =============================================================================
+// SpscQueue
+// Fixed capacity, lock-free queue for exactly one producer thread and one
+// consumer thread. Neither side ever blocks or allocates after construction.
+// =============================================================================
+
+template <typename T>
+class SpscQueue
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscQueue (size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+
+        mask = size - 1;
+        items = std::make_unique<T[]> (size);
+    }
+
+    // Producer: returns false (and drops the item) if the queue is full
+    bool push (const T& item)
+    {
+        size_t tail = writeIndex.load (std::memory_order_relaxed);
+        if (tail - cachedReadIndex > mask)
+        {
+            cachedReadIndex = readIndex.load (std::memory_order_acquire);
+            if (tail - cachedReadIndex > mask)
+                return false;
+        }
+
+        items[tail & mask] = item;
+        writeIndex.store (tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: returns nullptr if empty. The item stays valid until pop()
+    const T* front()
+    {
+        size_t head = readIndex.load (std::memory_order_relaxed);
+        if (head == cachedWriteIndex)
+        {
+            cachedWriteIndex = writeIndex.load (std::memory_order_acquire);
+            if (head == cachedWriteIndex)
+                return nullptr;
+        }
+
+        return &items[head & mask];
+    }
+
+    void pop()
+    {
+        readIndex.store (readIndex.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool isEmpty() const
+    {
+        return readIndex.load (std::memory_order_acquire) == writeIndex.load (std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<T[]> items;
+    size_t mask = 0;
+
+    // Each side's index and its cached copy of the other side's index share a cache line
+    alignas (64) std::atomic<size_t> writeIndex { 0 };
+    size_t cachedReadIndex = 0;
+    alignas (64) std::atomic<size_t> readIndex { 0 };
+    size_t cachedWriteIndex = 0;
+};
@@ -0,0 +1,180 @@
+#include "StateHash.h"
+#include "BinaryIO.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// Trace file layout:
+//   "HLHT" u8 version, u8 mode, u64 seed, varint-length replay file name, varint tick count
+//   Per tick: u64 hash, varint group count, then per group u8 group, varint index, u32 hash
+
+namespace
+{
+    const uint8_t magic[4] = { 'H', 'L', 'H', 'T' };
+    constexpr uint8_t formatVersion = 1;
+
+    const char* getGroupName (StateGroup group)
+    {
+        switch (group)
+        {
+            case StateGroup::Match:  return "match";
+            case StateGroup::Ship:   return "ship";
+            case StateGroup::AI:     return "ai";
+            case StateGroup::Shells: return "shells";
+        }
+        return "?";
+    }
+
+    std::string formatValue (const StateHasher::Field& field)
+    {
+        char text[64];
+        snprintf (text, sizeof (text), "%.9g", field.value);
+        return text;
+    }
+}
+
+std::string StateHasher::describe (StateGroup group, int index, int item, const char* name)
+{
+    std::string text = getGroupName (group);
+    if (group == StateGroup::Ship || group == StateGroup::AI)
+        text += " " + std::to_string (index + 1);
+
+    if (item >= 0)
+        text += (group == StateGroup::Shells ? " shell " : " turret ") + std::to_string (item + 1);
+
+    if (name != nullptr)
+        text += std::string (" ") + name;
+
+    return text;
+}
+
+std::string findFirstDifference (const StateHasher& a, const StateHasher& b)
+{
+    const auto& fa = a.getFields();
+    const auto& fb = b.getFields();
+
+    size_t n = std::min (fa.size(), fb.size());
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto& x = fa[i];
+        const auto& y = fb[i];
+
+        // Different layout (a ship or shell exists in one run only)
+        if (x.group != y.group || x.index != y.index || x.item != y.item || strcmp (x.name, y.name) != 0)
+            return "different state layout at " + StateHasher::describe (x.group, x.index, x.item, x.name)
+                   + " vs " + StateHasher::describe (y.group, y.index, y.item, y.name);
+
+        if (x.bits != y.bits)
+            return StateHasher::describe (x.group, x.index, x.item, x.name) + ": " + formatValue (x) + " vs " + formatValue (y);
+    }
+
+    if (fa.size() != fb.size())
+        return "different number of fields (" + std::to_string (fa.size()) + " vs " + std::to_string (fb.size()) + ")";
+
+    return "";
+}
+
+//==============================================================================
+void HashTrace::addTick (const StateHasher& hasher)
+{
+    ticks.push_back ({ hasher.getHash(), hasher.getGroups() });
+}
+
+bool HashTrace::save (const std::string& path) const
+{
+    ByteWriter w;
+    w.writeBytes (magic, sizeof (magic));
+    w.writeU8 (formatVersion);
+    w.writeU8 (mode);
+    w.writeU64 (seed);
+    w.writeVarint (replayFile.size());
+    w.writeBytes (replayFile.data(), replayFile.size());
+    w.writeVarint (ticks.size());
+
+    for (const auto& tick : ticks)
+    {
+        w.writeU64 (tick.hash);
+        w.writeVarint (tick.groups.size());
+        for (const auto& group : tick.groups)
+        {
+            w.writeU8 ((uint8_t) group.group);
+            w.writeVarint ((uint64_t) group.index);
+            w.writeU32 (group.hash);
+        }
+    }
+
+    return writeFile (path, w.data());
+}
+
+bool HashTrace::load (const std::string& path)
+{
+    std::vector<uint8_t> bytes;
+    if (! readFile (path, bytes))
+        return false;
+
+    ByteReader r (bytes.data(), bytes.size());
+    uint8_t fileMagic[4] = {};
+    r.readBytes (fileMagic, sizeof (fileMagic));
+    if (memcmp (fileMagic, magic, sizeof (magic)) != 0 || r.readU8() != formatVersion)
+        return false;
+
+    mode = r.readU8();
+    seed = r.readU64();
+    size_t nameLength = (size_t) r.readVarint();
+    if (nameLength > bytes.size())
+        return false;
+    replayFile.resize (nameLength);
+    r.readBytes (replayFile.data(), nameLength);
+
+    size_t numTicks = (size_t) r.readVarint();
+    if (numTicks > bytes.size())
+        return false;
+
+    ticks.resize (numTicks);
+    for (auto& tick : ticks)
+    {
+        tick.hash = r.readU64();
+        size_t numGroups = (size_t) r.readVarint();
+        if (numGroups > 1024 || ! r.ok())
+            return false;
+
+        tick.groups.resize (numGroups);
+        for (auto& group : tick.groups)
+        {
+            group.group = (StateGroup) r.readU8();
+            group.index = (int) r.readVarint();
+            group.hash = r.readU32();
+        }
+    }
+
+    return r.ok();
+}
+
+std::string HashTrace::compare (size_t tick, const StateHasher& hasher) const
+{
+    if (tick >= ticks.size())
+        return "trace ends at tick " + std::to_string (ticks.size());
+
+    const Tick& expected = ticks[tick];
+    if (expected.hash == hasher.getHash())
+        return "";
+
+    const auto& groups = hasher.getGroups();
+    std::string differences;
+    size_t n = std::max (groups.size(), expected.groups.size());
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i >= groups.size() || i >= expected.groups.size()
+            || groups[i].group != expected.groups[i].group || groups[i].index != expected.groups[i].index)
+        {
+            differences += (differences.empty() ? "" : ", ") + std::string ("different state layout");
+            break;
+        }
+
+        if (groups[i].hash != expected.groups[i].hash)
+            differences += (differences.empty() ? "" : ", ") + StateHasher::describe (groups[i].group, groups[i].index, -1);
+    }
+
+    return differences.empty() ? "hash differs" : differences;
+}
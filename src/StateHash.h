@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Vec2.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+class World;
+
+// =============================================================================
+// State hashing
+// A cheap hash of all gameplay state after a simulation step (cosmetics such as
+// smoke and bubbles are left out). Two runs that should be identical can be
+// compared tick by tick, and when they differ the hasher can list every field
+// so the first one that diverged can be named.
+// =============================================================================
+
+enum class StateGroup : uint8_t
+{
+    Match,      // Timers, wind, current, match-wide random streams
+    Ship,       // index = ship, item = turret
+    AI,         // index = ship
+    Shells      // item = shell
+};
+
+class StateHasher
+{
+public:
+    struct GroupHash
+    {
+        StateGroup group;
+        int index;
+        uint32_t hash;
+    };
+
+    struct Field
+    {
+        StateGroup group;
+        int index;
+        int item;           // -1 when the field isn't part of a turret / shell
+        const char* name;
+        uint64_t bits;      // Exact value
+        double value;       // For printing
+    };
+
+    // recordFields: keep every field for diagnosis (slower, only needed after a mismatch)
+    explicit StateHasher (bool recordFields_ = false) : recordFields (recordFields_) {}
+
+    void clear()
+    {
+        hash = offsetBasis;
+        groups.clear();
+        fields.clear();
+    }
+
+    void beginGroup (StateGroup group, int index = 0)
+    {
+        groups.push_back ({ group, index, 0 });
+        groupHash = offsetBasis;
+        item = -1;
+    }
+
+    void setItem (int newItem)      { item = newItem; }
+
+    void add (const char* name, float v)
+    {
+        uint32_t bits;
+        memcpy (&bits, &v, sizeof (bits));
+        addBits (name, bits, v);
+    }
+
+    void add (const char* name, Vec2 v)
+    {
+        add (name, v.x);
+        add (name, v.y);
+    }
+
+    void add (const char* name, int v)          { addBits (name, (uint64_t) (int64_t) v, v); }
+    void add (const char* name, bool v)         { addBits (name, v ? 1 : 0, v ? 1 : 0); }
+    void add (const char* name, uint64_t v)     { addBits (name, v, (double) v); }
+
+    uint64_t getHash() const                        { return hash; }
+    const std::vector<GroupHash>& getGroups() const { return groups; }
+    const std::vector<Field>& getFields() const     { return fields; }
+
+    // "ship 3 turret 2 angle" style name for reports
+    static std::string describe (StateGroup group, int index, int item, const char* name = nullptr);
+
+private:
+    static constexpr uint64_t offsetBasis = 0xcbf29ce484222325ULL;
+    static constexpr uint64_t prime = 0x100000001b3ULL;
+
+    bool recordFields = false;
+    uint64_t hash = offsetBasis;
+    uint64_t groupHash = offsetBasis;
+    int item = -1;
+    std::vector<GroupHash> groups;
+    std::vector<Field> fields;
+
+    // FNV-1a over whole values rather than bytes
+    void addBits (const char* name, uint64_t bits, double value)
+    {
+        hash = (hash ^ bits) * prime;
+        groupHash = (groupHash ^ bits) * prime;
+        if (! groups.empty())
+            groups.back().hash = (uint32_t) (groupHash ^ (groupHash >> 32));
+
+        if (recordFields)
+            fields.push_back ({ groups.empty() ? StateGroup::Match : groups.back().group, groups.empty() ? 0 : groups.back().index, item, name, bits, value });
+    }
+};
+
+// Describes where two hashers of the same tick first differ, e.g.
+// "ship 3 turret 2 angle: 0.51234 vs 0.51236". Empty if they match.
+std::string findFirstDifference (const StateHasher& a, const StateHasher& b);
+
+// =============================================================================
+// Hash traces
+// The state hash of every tick of one run, saved so a later build can check it
+// still simulates the same match. Each tick also keeps a short hash per group
+// (each ship, AI, the shells...) so a mismatch can say where it started.
+// =============================================================================
+
+class HashTrace
+{
+public:
+    struct Tick
+    {
+        uint64_t hash = 0;
+        std::vector<StateHasher::GroupHash> groups;
+    };
+
+    // What the run was, so a check can re-create it
+    uint8_t mode = 0;
+    uint64_t seed = 0;
+    std::string replayFile;     // Non-empty if the run was driven by a replay
+
+    void clear()                            { ticks.clear(); }
+    void addTick (const StateHasher& hasher);
+    size_t getNumTicks() const              { return ticks.size(); }
+    const Tick& getTick (size_t i) const    { return ticks[i]; }
+
+    bool save (const std::string& path) const;
+    bool load (const std::string& path);
+
+    // Compares a tick (0-based) against the trace. Returns an empty string if it
+    // matches, otherwise which groups differ.
+    std::string compare (size_t tick, const StateHasher& hasher) const;
+
+private:
+    std::vector<Tick> ticks;
+};
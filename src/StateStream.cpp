@@ -0,0 +1,594 @@
+#include "StateStream.h"
+#include <algorithm>
+#include <cmath>
+
+// File layout:
+//   "HLSS" u8 version, match header, u32 keyframe interval, islands
+//   Chunks:
+//     'K' u32 tick, u32 size, fixed width frame
+//     'D' varint size, varint tick step, then only the values that changed since the previous chunk
+//     'E' end of chunks
+//   Index: (u32 tick, u64 offset) per keyframe, u32 count, u32 last tick, u64 index offset, "HLSI"
+// An unfinished file (no index) is still readable by scanning the chunks.
+
+namespace
+{
+    const uint8_t magic[4] = { 'H', 'L', 'S', 'S' };
+    const uint8_t indexMagic[4] = { 'H', 'L', 'S', 'I' };
+    constexpr uint8_t formatVersion = 2;
+    constexpr size_t footerSize = 4 + 4 + 8 + 4;
+
+    constexpr uint8_t keyframeChunk = 'K';
+    constexpr uint8_t deltaChunk = 'D';
+    constexpr uint8_t endChunk = 'E';
+
+    // Fixed point scales
+    constexpr float positionScale = 16.0f;    // 1/16 pixel
+    constexpr float velocityScale = 256.0f;
+    constexpr float angleScale = 4096.0f;     // ~0.014 degrees
+    constexpr float healthScale = 16.0f;
+    constexpr float unitScale = 4096.0f;      // Values in the 0-1 or -1-1 range
+
+    constexpr float twoPi = 6.28318530718f;
+
+    int32_t toFixed (float v, float scale)  { return (int32_t) std::lround (v * scale); }
+    float fromFixed (int32_t v, float scale) { return v / scale; }
+    int32_t toFixedAngle (float a)          { return toFixed (std::remainder (a, twoPi), angleScale); }
+
+    void writeFrameRaw (ByteWriter& w, const StateFrame& frame)
+    {
+        for (int32_t v : frame.environment)
+            w.writeU32 ((uint32_t) v);
+        for (const auto& ship : frame.ships)
+            for (int32_t v : ship)
+                w.writeU32 ((uint32_t) v);
+        w.writeU16 ((uint16_t) frame.numShells);
+        for (int i = 0; i < frame.numShells; ++i)
+        {
+            w.writeU32 ((uint32_t) frame.shells[i].x);
+            w.writeU32 ((uint32_t) frame.shells[i].y);
+            w.writeU8 ((uint8_t) frame.shells[i].owner);
+        }
+    }
+
+    bool readFrameRaw (ByteReader& r, StateFrame& frame)
+    {
+        for (int32_t& v : frame.environment)
+            v = (int32_t) r.readU32();
+        for (auto& ship : frame.ships)
+            for (int32_t& v : ship)
+                v = (int32_t) r.readU32();
+        frame.numShells = r.readU16();
+        if (frame.numShells > StateFrame::MAX_SHELLS)
+            return false;
+        for (int i = 0; i < frame.numShells; ++i)
+        {
+            frame.shells[i].x = (int32_t) r.readU32();
+            frame.shells[i].y = (int32_t) r.readU32();
+            frame.shells[i].owner = r.readU8();
+        }
+        return r.ok();
+    }
+
+    // Everything that differs from prev. Bit masks say which values follow, so unchanged ships cost nothing
+    void writeFrameDelta (ByteWriter& w, const StateFrame& frame, const StateFrame& prev)
+    {
+        w.writeVarint (frame.tick - prev.tick);
+
+        uint32_t environmentMask = 0;
+        for (int i = 0; i < 4; ++i)
+            if (frame.environment[i] != prev.environment[i])
+                environmentMask |= 1u << i;
+        w.writeU8 ((uint8_t) environmentMask);
+        for (int i = 0; i < 4; ++i)
+            if (environmentMask & (1u << i))
+                w.writeSigned ((int64_t) frame.environment[i] - prev.environment[i]);
+
+        std::array<uint32_t, World::MAX_SHIPS> fieldMasks = {};
+        uint32_t shipMask = 0;
+        for (int s = 0; s < World::MAX_SHIPS; ++s)
+        {
+            for (int f = 0; f < StateFrame::numShipFields; ++f)
+                if (frame.ships[s][f] != prev.ships[s][f])
+                    fieldMasks[s] |= 1u << f;
+            if (fieldMasks[s] != 0)
+                shipMask |= 1u << s;
+        }
+
+        w.writeVarint (shipMask);
+        for (int s = 0; s < World::MAX_SHIPS; ++s)
+        {
+            if (fieldMasks[s] == 0)
+                continue;
+            w.writeVarint (fieldMasks[s]);
+            for (int f = 0; f < StateFrame::numShipFields; ++f)
+                if (fieldMasks[s] & (1u << f))
+                    w.writeSigned ((int64_t) frame.ships[s][f] - prev.ships[s][f]);
+        }
+
+        // Shells are coded against the shell at the same index last time (zero for new slots)
+        w.writeVarint ((uint64_t) frame.numShells);
+        StateFrame::ShellState none;
+        for (int i = 0; i < frame.numShells; ++i)
+        {
+            const auto& shell = frame.shells[i];
+            const auto& before = i < prev.numShells ? prev.shells[i] : none;
+            w.writeSigned ((int64_t) shell.x - before.x);
+            w.writeSigned ((int64_t) shell.y - before.y);
+            w.writeSigned ((int64_t) shell.owner - before.owner);
+        }
+    }
+
+    // Applies a delta to the frame in place
+    bool readFrameDelta (ByteReader& r, StateFrame& frame)
+    {
+        frame.tick += (uint32_t) r.readVarint();
+
+        uint32_t environmentMask = r.readU8();
+        for (int i = 0; i < 4; ++i)
+            if (environmentMask & (1u << i))
+                frame.environment[i] += (int32_t) r.readSigned();
+
+        uint32_t shipMask = (uint32_t) r.readVarint();
+        for (int s = 0; s < World::MAX_SHIPS; ++s)
+        {
+            if (! (shipMask & (1u << s)))
+                continue;
+            uint32_t fieldMask = (uint32_t) r.readVarint();
+            for (int f = 0; f < StateFrame::numShipFields; ++f)
+                if (fieldMask & (1u << f))
+                    frame.ships[s][f] += (int32_t) r.readSigned();
+        }
+
+        int previousShells = frame.numShells;
+        int numShells = (int) r.readVarint();
+        if (numShells > StateFrame::MAX_SHELLS)
+            return false;
+
+        for (int i = previousShells; i < numShells; ++i)
+            frame.shells[i] = {};
+        for (int i = 0; i < numShells; ++i)
+        {
+            frame.shells[i].x += (int32_t) r.readSigned();
+            frame.shells[i].y += (int32_t) r.readSigned();
+            frame.shells[i].owner += (int32_t) r.readSigned();
+        }
+        frame.numShells = numShells;
+
+        return r.ok();
+    }
+}
+
+//==============================================================================
+void StateFrame::capture (const World& world, uint32_t tickNumber)
+{
+    tick = tickNumber;
+
+    Vec2 wind = world.getWind();
+    Vec2 current = world.getCurrent();
+    environment = { toFixed (wind.x, unitScale), toFixed (wind.y, unitScale), toFixed (current.x, unitScale), toFixed (current.y, unitScale) };
+
+    const auto& worldShips = world.getShips();
+    for (int i = 0; i < World::MAX_SHIPS; ++i)
+    {
+        auto& s = ships[i];
+        const Ship* ship = worldShips[i].get();
+        if (ship == nullptr)
+        {
+            s = {};
+            continue;
+        }
+
+        Vec2 position = ship->getPosition();
+        Vec2 velocity = ship->getVelocity();
+        Vec2 crosshair = ship->getCrosshairPosition();
+
+        s[shipFlags] = present | (ship->isAlive() ? alive : 0) | (ship->isVisible() ? visible : 0);
+        s[shipX] = toFixed (position.x, positionScale);
+        s[shipY] = toFixed (position.y, positionScale);
+        s[shipVelocityX] = toFixed (velocity.x, velocityScale);
+        s[shipVelocityY] = toFixed (velocity.y, velocityScale);
+        s[shipAngle] = toFixedAngle (ship->getAngle());
+        s[shipHealth] = toFixed (ship->getHealth(), healthScale);
+        s[shipThrottle] = toFixed (ship->getThrottle(), unitScale);
+        s[shipRudder] = toFixed (ship->getRudder(), unitScale);
+        s[shipSinkProgress] = toFixed (ship->getSinkProgress(), unitScale);
+        s[shipCrosshairX] = toFixed (crosshair.x, positionScale);
+        s[shipCrosshairY] = toFixed (crosshair.y, positionScale);
+
+        const auto& turrets = ship->getTurrets();
+        for (int t = 0; t < 4; ++t)
+        {
+            bool used = t < ship->getNumTurrets();
+            s[shipTurretAngle + t] = used ? toFixedAngle (turrets[t].getAngle()) : 0;
+            s[shipTurretReload + t] = used ? toFixed (turrets[t].getReloadProgress(), unitScale) : 0;
+        }
+    }
+
+    const auto& worldShells = world.getShells();
+    numShells = (int32_t) std::min (worldShells.size(), (size_t) MAX_SHELLS);
+    for (int i = 0; i < numShells; ++i)
+    {
+        Vec2 position = worldShells[i].getPosition();
+        shells[i] = { toFixed (position.x, positionScale), toFixed (position.y, positionScale), worldShells[i].getOwnerIndex() };
+    }
+}
+
+Vec2 StateFrame::getShipPosition (int i) const         { return { fromFixed (ships[i][shipX], positionScale), fromFixed (ships[i][shipY], positionScale) }; }
+Vec2 StateFrame::getShipVelocity (int i) const         { return { fromFixed (ships[i][shipVelocityX], velocityScale), fromFixed (ships[i][shipVelocityY], velocityScale) }; }
+float StateFrame::getShipAngle (int i) const           { return fromFixed (ships[i][shipAngle], angleScale); }
+float StateFrame::getShipHealth (int i) const          { return fromFixed (ships[i][shipHealth], healthScale); }
+float StateFrame::getShipThrottle (int i) const        { return fromFixed (ships[i][shipThrottle], unitScale); }
+float StateFrame::getShipRudder (int i) const          { return fromFixed (ships[i][shipRudder], unitScale); }
+float StateFrame::getShipSinkProgress (int i) const    { return fromFixed (ships[i][shipSinkProgress], unitScale); }
+Vec2 StateFrame::getCrosshairPosition (int i) const    { return { fromFixed (ships[i][shipCrosshairX], positionScale), fromFixed (ships[i][shipCrosshairY], positionScale) }; }
+float StateFrame::getTurretAngle (int i, int t) const  { return fromFixed (ships[i][shipTurretAngle + t], angleScale); }
+float StateFrame::getTurretReload (int i, int t) const { return fromFixed (ships[i][shipTurretReload + t], unitScale); }
+Vec2 StateFrame::getShellPosition (int n) const        { return { fromFixed (shells[n].x, positionScale), fromFixed (shells[n].y, positionScale) }; }
+Vec2 StateFrame::getWind() const                       { return { fromFixed (environment[0], unitScale), fromFixed (environment[1], unitScale) }; }
+Vec2 StateFrame::getCurrent() const                    { return { fromFixed (environment[2], unitScale), fromFixed (environment[3], unitScale) }; }
+
+//==============================================================================
+void StateStreamHeader::setFromWorld (const World& world, float ticksPerSecond)
+{
+    MatchHeader::setFromWorld (world, ticksPerSecond);
+
+    islands.clear();
+    for (const auto& island : world.getIslands())
+        islands.emplace_back (island.getVertices().begin(), island.getVertices().end());
+}
+
+//==============================================================================
+StateStreamWriter::StateStreamWriter()
+    : queue (128)  // ~2 seconds of ticks at 60Hz
+{
+}
+
+StateStreamWriter::~StateStreamWriter()
+{
+    close();
+}
+
+bool StateStreamWriter::open (const std::string& path, const StateStreamHeader& header_)
+{
+    close();
+
+    file.open (path, std::ios::binary | std::ios::trunc);
+    if (! file.is_open())
+        return false;
+
+    header = header_;
+    header.keyframeInterval = std::max (1u, header.keyframeInterval);
+    fileOffset = 0;
+    hasPrevious = false;
+    droppedFrames = 0;
+    keyframeIndex.clear();
+
+    ByteWriter w;
+    header.write (w, magic, formatVersion);
+    w.writeU32 (header.keyframeInterval);
+    w.writeVarint (header.islands.size());
+    for (const auto& outline : header.islands)
+    {
+        w.writeVarint (outline.size());
+        for (Vec2 v : outline)
+        {
+            w.writeFloat (v.x);
+            w.writeFloat (v.y);
+        }
+    }
+    writeBytes (w.data());
+
+    thread.start ([this] { drainQueue(); });
+    return true;
+}
+
+void StateStreamWriter::addFrame (const World& world, uint32_t tick, bool waitIfFull)
+{
+    if (! isOpen())
+        return;
+
+    pending.capture (world, tick);
+    while (! queue.push (pending))
+    {
+        if (! waitIfFull)
+        {
+            droppedFrames++;  // The next delta just spans the gap
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void StateStreamWriter::close()
+{
+    if (! isOpen())
+        return;
+
+    thread.stop();
+
+    // End marker then the keyframe index
+    ByteWriter w;
+    w.writeU8 (endChunk);
+    uint64_t indexOffset = fileOffset + w.size();
+    for (const auto& [tick, offset] : keyframeIndex)
+    {
+        w.writeU32 (tick);
+        w.writeU64 (offset);
+    }
+    w.writeU32 ((uint32_t) keyframeIndex.size());
+    w.writeU32 (hasPrevious ? previous.tick : 0);
+    w.writeU64 (indexOffset);
+    w.writeBytes (indexMagic, sizeof (indexMagic));
+    writeBytes (w.data());
+
+    file.close();
+}
+
+void StateStreamWriter::drainQueue()
+{
+    while (const StateFrame* frame = queue.front())
+    {
+        bool keyframe = keyframeIndex.empty() || frame->tick >= keyframeIndex.back().first + header.keyframeInterval;
+        writeFrame (*frame, keyframe);
+        queue.pop();
+    }
+}
+
+void StateStreamWriter::writeFrame (const StateFrame& frame, bool keyframe)
+{
+    chunk.clear();
+    payload.clear();
+
+    if (keyframe)
+    {
+        keyframeIndex.push_back ({ frame.tick, fileOffset });
+
+        writeFrameRaw (payload, frame);
+        chunk.writeU8 (keyframeChunk);
+        chunk.writeU32 (frame.tick);
+        chunk.writeU32 ((uint32_t) payload.size());
+        chunk.writeBytes (payload.data().data(), payload.size());
+    }
+    else
+    {
+        writeFrameDelta (payload, frame, previous);
+        chunk.writeU8 (deltaChunk);
+        chunk.writeVarint (payload.size());
+        chunk.writeBytes (payload.data().data(), payload.size());
+    }
+
+    writeBytes (chunk.data());
+    previous = frame;
+    hasPrevious = true;
+}
+
+void StateStreamWriter::writeBytes (const std::vector<uint8_t>& bytes)
+{
+    file.write ((const char*) bytes.data(), (std::streamsize) bytes.size());
+    fileOffset += bytes.size();
+}
+
+//==============================================================================
+bool StateStreamReader::open (const std::string& path)
+{
+    close();
+
+    if (! file.open (path))
+        return false;
+
+    ByteReader reader (file.getData(), file.getSize());
+    if (! readHeader (reader))
+    {
+        close();
+        return false;
+    }
+
+    chunksStart = reader.position();
+    chunksEnd = file.getSize();
+
+    if (! readIndex() && ! scanChunks())
+    {
+        close();
+        return false;
+    }
+
+    position = chunksStart;
+    return true;
+}
+
+void StateStreamReader::close()
+{
+    file.close();
+    keyframes.clear();
+    header = {};
+    chunksStart = chunksEnd = position = 0;
+    firstTick = lastTick = 0;
+}
+
+bool StateStreamReader::readHeader (ByteReader& r)
+{
+    if (! header.read (r, magic, formatVersion))
+        return false;
+
+    header.keyframeInterval = r.readU32();
+
+    size_t numIslands = (size_t) r.readVarint();
+    if (numIslands > 1000)
+        return false;
+    header.islands.resize (numIslands);
+    for (auto& outline : header.islands)
+    {
+        size_t numVertices = (size_t) r.readVarint();
+        if (numVertices > 10000)
+            return false;
+        outline.resize (numVertices);
+        for (Vec2& v : outline)
+        {
+            v.x = r.readFloat();
+            v.y = r.readFloat();
+        }
+    }
+
+    return r.ok();
+}
+
+bool StateStreamReader::readIndex()
+{
+    size_t size = file.getSize();
+    if (size < chunksStart + footerSize)
+        return false;
+
+    const uint8_t* data = file.getData();
+    if (memcmp (data + size - sizeof (indexMagic), indexMagic, sizeof (indexMagic)) != 0)
+        return false;
+
+    ByteReader footer (data + size - footerSize, footerSize);
+    uint32_t count = footer.readU32();
+    uint32_t last = footer.readU32();
+    uint64_t indexOffset = footer.readU64();
+
+    if (indexOffset < chunksStart + 1 || indexOffset + (uint64_t) count * 12 + footerSize != size || count == 0)
+        return false;
+
+    ByteReader r (data + indexOffset, (size_t) count * 12);
+    keyframes.resize (count);
+    for (auto& keyframe : keyframes)
+    {
+        keyframe.tick = r.readU32();
+        keyframe.offset = r.readU64();
+        if (keyframe.offset < chunksStart || keyframe.offset >= indexOffset)
+            return false;
+    }
+
+    chunksEnd = (size_t) indexOffset - 1;  // Before the end marker
+    firstTick = keyframes.front().tick;
+    lastTick = last;
+    return r.ok();
+}
+
+bool StateStreamReader::scanChunks()
+{
+    // No index (the recording didn't finish) - walk the chunks to rebuild it
+    keyframes.clear();
+    ByteReader r (file.getData(), file.getSize());
+    r.seek (chunksStart);
+
+    uint32_t tick = 0;
+    size_t lastGood = chunksStart;
+
+    while (! r.atEnd())
+    {
+        size_t chunkStart = r.position();
+        uint8_t type = r.readU8();
+
+        if (type == keyframeChunk)
+        {
+            uint32_t keyTick = r.readU32();
+            uint32_t size = r.readU32();
+            if (! r.ok() || size > r.getSize() - r.position())
+                break;
+            keyframes.push_back ({ keyTick, chunkStart });
+            tick = keyTick;
+            r.seek (r.position() + size);
+        }
+        else if (type == deltaChunk && ! keyframes.empty())
+        {
+            size_t size = (size_t) r.readVarint();
+            if (! r.ok() || size > r.getSize() - r.position())
+                break;
+            size_t payloadStart = r.position();
+            tick += (uint32_t) r.readVarint();
+            r.seek (payloadStart + size);
+        }
+        else
+        {
+            break;
+        }
+
+        lastGood = r.position();
+        lastTick = tick;
+    }
+
+    if (keyframes.empty())
+        return false;
+
+    chunksEnd = lastGood;
+    firstTick = keyframes.front().tick;
+    return true;
+}
+
+bool StateStreamReader::readChunk (StateFrame& frame)
+{
+    if (position >= chunksEnd)
+        return false;
+
+    ByteReader r (file.getData(), chunksEnd);
+    r.seek (position);
+
+    uint8_t type = r.readU8();
+    bool ok = false;
+
+    if (type == keyframeChunk)
+    {
+        frame.tick = r.readU32();
+        uint32_t size = r.readU32();
+        ByteReader payload (file.getData() + r.position(), std::min ((size_t) size, chunksEnd - r.position()));
+        ok = r.ok() && readFrameRaw (payload, frame);
+        r.seek (r.position() + size);
+    }
+    else if (type == deltaChunk)
+    {
+        size_t size = (size_t) r.readVarint();
+        ByteReader payload (file.getData() + r.position(), std::min (size, chunksEnd - r.position()));
+        ok = r.ok() && readFrameDelta (payload, frame);
+        r.seek (r.position() + size);
+    }
+
+    if (! ok || ! r.ok())
+        return false;
+
+    position = r.position();
+    return true;
+}
+
+bool StateStreamReader::seek (uint32_t tick, StateFrame& frame)
+{
+    if (keyframes.empty())
+        return false;
+
+    // Last keyframe at or before the tick
+    auto it = std::upper_bound (keyframes.begin(), keyframes.end(), tick,
+                                [] (uint32_t t, const Keyframe& k) { return t < k.tick; });
+    if (it != keyframes.begin())
+        --it;
+
+    position = (size_t) it->offset;
+    if (! readChunk (frame))
+        return false;
+
+    // Step forward through the deltas, stopping before the first one past the tick
+    for (;;)
+    {
+        size_t chunkStart = position;
+        if (chunkStart >= chunksEnd || file.getData()[chunkStart] != deltaChunk)
+            break;
+
+        ByteReader r (file.getData(), chunksEnd);
+        r.seek (chunkStart + 1);
+        r.readVarint();
+        uint32_t step = (uint32_t) r.readVarint();
+        if (! r.ok() || frame.tick + step > tick)
+            break;
+
+        if (! readChunk (frame))
+            return false;
+    }
+
+    return true;
+}
+
+bool StateStreamReader::next (StateFrame& frame)
+{
+    return readChunk (frame);
+}
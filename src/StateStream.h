@@ -0,0 +1,183 @@
+#pragma once
+
+#include "BinaryIO.h"
+#include "Recording.h"
+#include "SpscQueue.h"
+#include "World.h"
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// State streams
+// An optional companion to input replays for viewers: the world's visible state
+// (ships, turrets, shells, wind and current) recorded every tick, so any point
+// can be shown without re-simulating from the start. A full keyframe is stored
+// every few seconds with compact per-tick deltas in between, and an index of
+// keyframes at the end of the file. Seeking decodes at most one keyframe
+// interval.
+//
+// Values are stored as fixed point integers, so deltas are exact and a frame
+// decodes to the same numbers whichever keyframe it was reached from.
+// =============================================================================
+
+struct StateFrame
+{
+    static constexpr int MAX_SHELLS = 256;
+
+    enum ShipField
+    {
+        shipFlags,                          // ShipFlag bits
+        shipX, shipY,
+        shipVelocityX, shipVelocityY,
+        shipAngle,
+        shipHealth,
+        shipThrottle, shipRudder,
+        shipSinkProgress,
+        shipCrosshairX, shipCrosshairY,
+        shipTurretAngle,                    // 4 turrets
+        shipTurretReload = shipTurretAngle + 4,
+        numShipFields = shipTurretReload + 4
+    };
+
+    enum ShipFlag
+    {
+        present = 1 << 0,
+        alive = 1 << 1,
+        visible = 1 << 2
+    };
+
+    struct ShellState
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+        int32_t owner = 0;
+    };
+
+    uint32_t tick = 0;
+    std::array<int32_t, 4> environment = {};  // Wind x/y, current x/y
+    std::array<std::array<int32_t, numShipFields>, World::MAX_SHIPS> ships = {};
+    int32_t numShells = 0;
+    std::array<ShellState, MAX_SHELLS> shells;
+
+    // Copies the world's visible state. Shells beyond MAX_SHELLS are left out
+    void capture (const World& world, uint32_t tickNumber);
+
+    // Decoded values
+    bool hasShip (int i) const              { return (ships[i][shipFlags] & present) != 0; }
+    bool isShipAlive (int i) const          { return (ships[i][shipFlags] & alive) != 0; }
+    bool isShipVisible (int i) const        { return (ships[i][shipFlags] & visible) != 0; }
+    Vec2 getShipPosition (int i) const;
+    Vec2 getShipVelocity (int i) const;
+    float getShipAngle (int i) const;
+    float getShipHealth (int i) const;
+    float getShipThrottle (int i) const;
+    float getShipRudder (int i) const;
+    float getShipSinkProgress (int i) const;
+    Vec2 getCrosshairPosition (int i) const;
+    float getTurretAngle (int i, int turret) const;
+    float getTurretReload (int i, int turret) const;
+    Vec2 getShellPosition (int n) const;
+    Vec2 getWind() const;
+    Vec2 getCurrent() const;
+};
+
+struct StateStreamHeader : MatchHeader
+{
+    uint32_t keyframeInterval = 300;                 // Ticks between keyframes
+    std::vector<std::vector<Vec2>> islands;          // Island outlines (islands don't move)
+
+    // Fills in everything except the keyframe interval from a started world
+    void setFromWorld (const World& world, float ticksPerSecond);
+};
+
+namespace StateStream
+{
+    constexpr const char* fileExtension = ".hls";
+}
+
+// Records one match in the format above, written out on a RecordingThread
+class StateStreamWriter
+{
+public:
+    StateStreamWriter();
+    ~StateStreamWriter();
+
+    bool open (const std::string& path, const StateStreamHeader& header);
+
+    // Game thread: queue the world's state after a tick. If the writer falls
+    // behind the frame is dropped, and the next delta spans the gap. Offline
+    // recordings (headless runs) can wait for space instead.
+    void addFrame (const World& world, uint32_t tick, bool waitIfFull = false);
+
+    // Flushes the queue, writes the keyframe index and closes the file
+    void close();
+
+    bool isOpen() const                     { return thread.isRunning(); }
+    uint32_t getNumDroppedFrames() const    { return droppedFrames; }
+
+private:
+    SpscQueue<StateFrame> queue;
+    StateFrame pending;               // Game thread scratch frame
+    uint32_t droppedFrames = 0;
+
+    RecordingThread thread;
+
+    // Writer thread
+    std::ofstream file;
+    uint64_t fileOffset = 0;
+    StateStreamHeader header;
+    StateFrame previous;
+    bool hasPrevious = false;
+    ByteWriter chunk;
+    ByteWriter payload;
+    std::vector<std::pair<uint32_t, uint64_t>> keyframeIndex;  // Tick, file offset
+
+    void drainQueue();
+    void writeFrame (const StateFrame& frame, bool keyframe);
+    void writeBytes (const std::vector<uint8_t>& bytes);
+};
+
+// Reads a state stream through a memory mapping
+class StateStreamReader
+{
+public:
+    bool open (const std::string& path);
+    void close();
+
+    const StateStreamHeader& getHeader() const  { return header; }
+    uint32_t getFirstTick() const               { return firstTick; }
+    uint32_t getLastTick() const                { return lastTick; }
+    size_t getNumKeyframes() const              { return keyframes.size(); }
+
+    // Decodes the frame at tick (or the closest one before it, if that tick
+    // wasn't recorded). Starts from the nearest keyframe, then applies deltas.
+    bool seek (uint32_t tick, StateFrame& frame);
+
+    // Decodes the frame after the one last returned by seek() or next()
+    bool next (StateFrame& frame);
+
+private:
+    struct Keyframe
+    {
+        uint32_t tick;
+        uint64_t offset;
+    };
+
+    MappedFile file;
+    StateStreamHeader header;
+    std::vector<Keyframe> keyframes;
+    size_t chunksStart = 0;
+    size_t chunksEnd = 0;
+    size_t position = 0;   // Next chunk to decode
+    uint32_t firstTick = 0;
+    uint32_t lastTick = 0;
+
+    bool readHeader (ByteReader& reader);
+    bool readIndex();
+    bool scanChunks();
+    bool readChunk (StateFrame& frame);
+};
@@ -0,0 +1,231 @@
+#include "Sweep.h"
+#include "Config.h"
+#include "Random.h"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+    struct Stat
+    {
+        const char* name;
+        float ShipType::*value;
+    };
+
+    const Stat shipStats[] = {
+        { "health", &ShipType::healthMultiplier },
+        { "speed", &ShipType::speedMultiplier },
+        { "turn", &ShipType::turnMultiplier },
+        { "reload", &ShipType::reloadMultiplier },
+        { "range", &ShipType::rangeMultiplier },
+        { "damage", &ShipType::damageMultiplier },
+        { "turretSpeed", &ShipType::turretSpeedMultiplier },
+        { "accel", &ShipType::accelMultiplier },
+    };
+
+    std::string toLower (std::string text)
+    {
+        for (auto& c : text)
+            c = (char) tolower ((unsigned char) c);
+        return text;
+    }
+
+    bool parseFloat (const std::string& text, float& value)
+    {
+        char* end = nullptr;
+        value = strtof (text.c_str(), &end);
+        return ! text.empty() && end == text.c_str() + text.size();
+    }
+}
+
+float* Sweep::findParameter (Config& config, const std::string& name)
+{
+    if (name == "fireInterval")  return &config.fireInterval;
+    if (name == "shellSpread")   return &config.shellSpread;
+    if (name == "maxShellRange") return &config.maxShellRange;
+
+    size_t dot = name.find ('.');
+    if (dot == std::string::npos)
+        return nullptr;
+
+    std::string typeName = name.substr (0, dot);
+    std::string statName = name.substr (dot + 1);
+
+    for (auto& type : config.shipTypes)
+    {
+        if (toLower (type.name) != typeName)
+            continue;
+
+        for (const auto& stat : shipStats)
+            if (statName == stat.name)
+                return &(type.*stat.value);
+    }
+
+    return nullptr;
+}
+
+std::vector<std::string> Sweep::getParameterNames()
+{
+    std::vector<std::string> names;
+    for (const auto& type : config.shipTypes)
+        for (const auto& stat : shipStats)
+            names.push_back (toLower (type.name) + "." + stat.name);
+
+    names.push_back ("fireInterval");
+    names.push_back ("shellSpread");
+    names.push_back ("maxShellRange");
+    return names;
+}
+
+bool Sweep::parseParameter (const std::string& text, SweepParameter& parameter, std::string& error)
+{
+    size_t equals = text.find ('=');
+    parameter.name = text.substr (0, equals);
+    parameter.values.clear();
+
+    if (findParameter (config, parameter.name) == nullptr)
+    {
+        error = "unknown sweep parameter '" + parameter.name + "'";
+        return false;
+    }
+
+    std::string range = equals == std::string::npos ? "" : text.substr (equals + 1);
+
+    // min:max:steps
+    size_t colon1 = range.find (':');
+    size_t colon2 = colon1 == std::string::npos ? std::string::npos : range.find (':', colon1 + 1);
+    if (colon2 != std::string::npos)
+    {
+        float min, max, steps;
+        if (! parseFloat (range.substr (0, colon1), min) || ! parseFloat (range.substr (colon1 + 1, colon2 - colon1 - 1), max)
+            || ! parseFloat (range.substr (colon2 + 1), steps) || steps < 1.0f)
+        {
+            error = "expected " + parameter.name + "=min:max:steps";
+            return false;
+        }
+
+        int n = (int) steps;
+        for (int i = 0; i < n; ++i)
+            parameter.values.push_back (n == 1 ? min : min + (max - min) * (float) i / (float) (n - 1));
+        return true;
+    }
+
+    // a,b,c
+    size_t start = 0;
+    while (start <= range.size())
+    {
+        size_t comma = range.find (',', start);
+        if (comma == std::string::npos)
+            comma = range.size();
+
+        float value;
+        if (! parseFloat (range.substr (start, comma - start), value))
+        {
+            error = "expected " + parameter.name + "=min:max:steps or " + parameter.name + "=a,b,c";
+            return false;
+        }
+
+        parameter.values.push_back (value);
+        start = comma + 1;
+    }
+
+    return true;
+}
+
+std::vector<std::vector<float>> Sweep::makeGrid (const std::vector<SweepParameter>& parameters)
+{
+    std::vector<std::vector<float>> points (1);
+
+    for (const auto& parameter : parameters)
+    {
+        std::vector<std::vector<float>> expanded;
+        for (const auto& point : points)
+        {
+            for (float value : parameter.values)
+            {
+                expanded.push_back (point);
+                expanded.back().push_back (value);
+            }
+        }
+        points = std::move (expanded);
+    }
+
+    return points;
+}
+
+std::vector<std::vector<float>> Sweep::makeSamples (const std::vector<SweepParameter>& parameters, int numSamples, uint64_t seed)
+{
+    Random random (seed, 0);
+    std::vector<std::vector<float>> points ((size_t) std::max (0, numSamples));
+
+    for (auto& point : points)
+        for (const auto& parameter : parameters)
+            point.push_back (random.nextFloat (parameter.values.front(), parameter.values.back()));
+
+    return points;
+}
+
+void Sweep::getWilsonInterval (int wins, int total, double& low, double& high, double z)
+{
+    if (total <= 0)
+    {
+        low = 0.0;
+        high = 1.0;
+        return;
+    }
+
+    double n = total;
+    double p = wins / n;
+    double z2 = z * z;
+    double centre = (p + z2 / (2.0 * n)) / (1.0 + z2 / n);
+    double spread = z * std::sqrt (p * (1.0 - p) / n + z2 / (4.0 * n * n)) / (1.0 + z2 / n);
+
+    low = std::max (0.0, centre - spread);
+    high = std::min (1.0, centre + spread);
+}
+
+std::vector<PairingResult> Sweep::runPairings (BatchRunner& runner, int matchesPerPairing, uint64_t seed, float maxMatchTime)
+{
+    std::vector<PairingResult> pairings;
+    std::vector<MatchSpec> specs;
+
+    for (int a = 0; a < NUM_SHIP_TYPES; ++a)
+    {
+        for (int b = a + 1; b < NUM_SHIP_TYPES; ++b)
+        {
+            pairings.push_back ({ a, b });
+
+            for (int m = 0; m < matchesPerPairing; ++m)
+            {
+                MatchSpec spec;
+                spec.mode = GameMode::Duel;
+                spec.seed = seed + (uint64_t) m;
+                spec.maxMatchTime = maxMatchTime;
+
+                // Alternate sides so neither type gets the same start every time
+                bool swapped = (m % 2) != 0;
+                spec.shipTypes[0] = swapped ? b : a;
+                spec.shipTypes[1] = swapped ? a : b;
+                specs.push_back (spec);
+            }
+        }
+    }
+
+    auto results = runner.run (specs);
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        PairingResult& pairing = pairings[i / (size_t) matchesPerPairing];
+        const MatchResult& result = results[i];
+
+        if (result.winnerIndex < 0)
+            pairing.draws++;
+        else if (result.shipTypes[result.winnerIndex] == pairing.typeA)
+            pairing.winsA++;
+        else
+            pairing.winsB++;
+    }
+
+    return pairings;
+}
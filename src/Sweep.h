@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Batch.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Config;
+
+// =============================================================================
+// Sweep
+// Balance sweeps: varies ship type multipliers and firing constants over a
+// grid or random samples, and at each point plays every pairing of different
+// ship types against each other in AI duels. Every point uses the same seeds,
+// so differences between points come from the parameters rather than luck.
+// =============================================================================
+
+struct SweepParameter
+{
+    std::string name;             // e.g. "cruiser.reload" or "shellSpread"
+    std::vector<float> values;    // Grid values, random samples are drawn between the first and last
+};
+
+struct PairingResult
+{
+    int typeA = 0;
+    int typeB = 0;
+    int winsA = 0;
+    int winsB = 0;
+    int draws = 0;
+
+    int getNumDecided() const   { return winsA + winsB; }
+    double getWinRateA() const  { return getNumDecided() > 0 ? (double) winsA / getNumDecided() : 0.5; }
+};
+
+namespace Sweep
+{
+    // The values a sweep can vary: "<type>.<stat>" for scout, frigate, cruiser
+    // and battleship with stats health, speed, turn, reload, range, damage,
+    // turretSpeed and accel, plus fireInterval, shellSpread and maxShellRange
+    float* findParameter (Config& config, const std::string& name);
+    std::vector<std::string> getParameterNames();
+
+    // "name=min:max:steps" for evenly spaced values, or "name=a,b,c"
+    bool parseParameter (const std::string& text, SweepParameter& parameter, std::string& error);
+
+    // Every combination of the parameters' values, the last parameter varying fastest
+    std::vector<std::vector<float>> makeGrid (const std::vector<SweepParameter>& parameters);
+
+    // Points drawn uniformly from each parameter's range
+    std::vector<std::vector<float>> makeSamples (const std::vector<SweepParameter>& parameters, int numSamples, uint64_t seed);
+
+    // Wilson score interval for a win rate, z = 1.96 for 95% confidence
+    void getWilsonInterval (int wins, int total, double& low, double& high, double z = 1.96);
+
+    // Plays matchesPerPairing duels for each pairing of different ship types
+    // using the current config. Types swap sides every other match
+    std::vector<PairingResult> runPairings (BatchRunner& runner, int matchesPerPairing, uint64_t seed, float maxMatchTime);
+}
@@ -3,9 +3,21 @@
 #include <algorithm>
 #include <cmath>
 
-Turret::Turret (Vec2 localOffset_, bool isFrontTurret)
-    : localOffset (localOffset_), isFront (isFrontTurret), reloadTime (config.fireInterval)
+Turret::Turret (Fleet& fleet, int slot, Vec2 localOffset_, bool isFrontTurret)
+    : angle (fleet.turretAngle[slot]), targetAngle (fleet.turretTargetAngle[slot]),
+      desiredAngle (fleet.turretDesiredAngle[slot]), fireTimer (fleet.turretFireTimer[slot]),
+      reloadTime (config.fireInterval)
 {
+    setMount (localOffset_, isFrontTurret);
+}
+
+void Turret::setMount (Vec2 localOffset_, bool isFrontTurret)
+{
+    localOffset = localOffset_;
+    isFront = isFrontTurret;
+    desiredAngle = 0.0f;
+    fireTimer = 0.0f;
+
     // Angle is relative to ship: 0 = ship forward, PI = ship backward
     // Front turrets start facing forward, rear turrets start facing backward
     if (isFront)
@@ -243,3 +255,12 @@ bool Turret::isAtArcLimit() const
         return std::abs (angle - minAngle) < tolerance || std::abs (angle + minAngle) < tolerance;
     }
 }
+
+void Turret::hashState (StateHasher& hasher) const
+{
+    hasher.add ("angle", angle);
+    hasher.add ("targetAngle", targetAngle);
+    hasher.add ("desiredAngle", desiredAngle);
+    hasher.add ("fireTimer", fireTimer);
+    hasher.add ("reloadTime", reloadTime);
+}
@@ -1,12 +1,17 @@
 #pragma once
 
 #include "Config.h"
+#include "Fleet.h"
+#include "StateHash.h"
 #include "Vec2.h"
 
 class Turret
 {
 public:
-    Turret (Vec2 localOffset, bool isFrontTurret = true);
+    // The turret's moving state lives at slot in fleet's turret arrays
+    Turret (Fleet& fleet, int slot, Vec2 localOffset, bool isFrontTurret = true);
+
+    void setMount (Vec2 localOffset, bool isFrontTurret);  // Also turns it to face its default direction
 
     void update (float dt, float shipAngle, Vec2 targetDir);
     void setTargetAngle (float angle);
@@ -24,13 +29,17 @@ public:
     void setReloadMultiplier (float mult) { reloadTime = config.fireInterval * mult; }
     void setRotationSpeedMultiplier (float mult) { rotationSpeedMultiplier = mult; }
 
+    void hashState (StateHasher& hasher) const;
+
 private:
+    // Moving state, in the fleet
+    float& angle; // Current turret rotation relative to ship (radians)
+    float& targetAngle; // Clamped to arc
+    float& desiredAngle; // Original unclamped desired angle
+    float& fireTimer; // Time until turret can fire again
+
     Vec2 localOffset; // Position relative to ship center
-    float angle = 0.0f; // Current turret rotation relative to ship (radians)
-    float targetAngle = 0.0f; // Clamped to arc
-    float desiredAngle = 0.0f; // Original unclamped desired angle
     bool isFront = true; // Front turrets can't point backward, rear can't point forward
-    float fireTimer = 0.0f; // Time until turret can fire again
     float reloadTime = 15.0f; // Reload time for this turret (can be modified by ship type)
     float rotationSpeedMultiplier = 1.0f; // Rotation speed multiplier (can be modified by ship type)
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <numbers>
 
@@ -59,4 +60,48 @@ struct Vec2
     {
         return std::atan2 (y, x);
     }
+
+    static Vec2 lerp (Vec2 a, Vec2 b, float t)
+    {
+        return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+    }
+};
+
+// =============================================================================
+// Vec2x4
+// Four points stored as x and y lanes, for doing the same sums to all of them
+// at once (a hull's corners). The loops are simple enough for the compiler to
+// turn into vector instructions, and each lane rounds exactly as the Vec2
+// version of the same sum would.
+// =============================================================================
+
+struct Vec2x4
+{
+    float x[4] = {};
+    float y[4] = {};
+
+    Vec2 operator[] (int i) const { return { x[i], y[i] }; }
+
+    // Turned by rotation (cos, sin of the angle), then moved by offset
+    static Vec2x4 transform (const Vec2x4& points, Vec2 offset, Vec2 rotation)
+    {
+        Vec2x4 result;
+        for (int i = 0; i < 4; ++i)
+        {
+            result.x[i] = offset.x + points.x[i] * rotation.x - points.y[i] * rotation.y;
+            result.y[i] = offset.y + points.x[i] * rotation.y + points.y[i] * rotation.x;
+        }
+        return result;
+    }
+
+    // The range of the points' dot products with axis, their shadow on it
+    void project (const Vec2& axis, float& min, float& max) const
+    {
+        float d[4];
+        for (int i = 0; i < 4; ++i)
+            d[i] = x[i] * axis.x + y[i] * axis.y;
+
+        min = std::min (std::min (d[0], d[1]), std::min (d[2], d[3]));
+        max = std::max (std::max (d[0], d[1]), std::max (d[2], d[3]));
+    }
 };
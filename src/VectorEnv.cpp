@@ -0,0 +1,298 @@
+#include "VectorEnv.h"
+#include "Batch.h"
+#include "Config.h"
+#include "Ship.h"
+#include <algorithm>
+
+static_assert (HELIGOLAND_OBS_OTHER_SHIPS == World::MAX_SHIPS - 1);
+
+namespace
+{
+    int getSide (GameMode mode, int shipIndex)
+    {
+        bool isTeamMode = (mode == GameMode::Teams || mode == GameMode::Battle);
+        return isTeamMode ? World::getTeamForMode (mode, shipIndex) : shipIndex;
+    }
+
+    float clampUnit (float value)
+    {
+        return std::clamp (value, -1.0f, 1.0f);
+    }
+}
+
+VectorEnv::VectorEnv (const ShipHulls& hulls, const Settings& settings_)
+    : settings (settings_), arenas ((size_t) settings_.numArenas)
+{
+    for (auto& arena : arenas)
+    {
+        arena.world = std::make_unique<World> (hulls);
+        arena.world->setCosmeticsEnabled (false);  // Nothing is drawn
+    }
+
+    // No point in more threads than arenas. This thread works a slice too
+    int numThreads = settings.numThreads > 0 ? settings.numThreads : Batch::getDefaultNumThreads();
+    numThreads = std::clamp (numThreads, 1, settings.numArenas);
+
+    for (int slice = 0; slice < numThreads - 1; ++slice)
+        workers.emplace_back ([this, slice] { workerLoop (slice); });
+}
+
+VectorEnv::~VectorEnv()
+{
+    quitting = true;
+    jobNumber.fetch_add (1);
+    jobNumber.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+bool VectorEnv::isValid (const Settings& settings)
+{
+    return settings.numArenas > 0
+        && settings.agentsPerArena > 0
+        && settings.agentsPerArena <= World::getNumShipsForMode (settings.mode)
+        && settings.ticksPerStep > 0
+        && settings.maxEpisodeTime > 0.0f;
+}
+
+void VectorEnv::reset (float* observations_)
+{
+    observations = observations_;
+    resetting = true;
+    runJob();
+}
+
+void VectorEnv::step (const float* actions_, float* observations_, float* rewards_, uint8_t* dones_)
+{
+    actions = actions_;
+    observations = observations_;
+    rewards = rewards_;
+    dones = dones_;
+    resetting = false;
+    runJob();
+}
+
+void VectorEnv::runJob()
+{
+    int numWorkers = (int) workers.size();
+    numBusy = numWorkers;
+    jobNumber.fetch_add (1);
+    jobNumber.notify_all();
+
+    runSlice (numWorkers);
+
+    for (int busy = numBusy.load(); busy != 0; busy = numBusy.load())
+        numBusy.wait (busy);
+}
+
+void VectorEnv::workerLoop (int slice)
+{
+    uint32_t lastJob = 0;
+
+    for (;;)
+    {
+        jobNumber.wait (lastJob);
+        lastJob = jobNumber.load();
+
+        if (quitting)
+            return;
+
+        runSlice (slice);
+
+        if (numBusy.fetch_sub (1) == 1)
+            numBusy.notify_one();
+    }
+}
+
+void VectorEnv::runSlice (int slice)
+{
+    int numSlices = (int) workers.size() + 1;
+    int begin = settings.numArenas * slice / numSlices;
+    int end = settings.numArenas * (slice + 1) / numSlices;
+
+    for (int i = begin; i < end; ++i)
+    {
+        if (resetting)
+        {
+            startEpisode (i);
+            writeObservations (i);
+        }
+        else
+        {
+            stepArena (i);
+        }
+    }
+}
+
+void VectorEnv::startEpisode (int arenaIndex)
+{
+    Arena& arena = arenas[(size_t) arenaIndex];
+
+    World::ShipTypes shipTypes;
+    shipTypes.fill (-1);
+    arena.world->start (settings.mode, shipTypes, settings.seed + arena.episode * (uint64_t) settings.numArenas + (uint64_t) arenaIndex);
+    arena.episode++;
+
+    const auto& ships = arena.world->getShips();
+    for (int s = 0; s < settings.agentsPerArena; ++s)
+    {
+        arena.lastHealth[s] = ships[s]->getHealth();
+        arena.lastDamageDealt[s] = ships[s]->getDamageDealt();
+    }
+}
+
+void VectorEnv::stepArena (int arenaIndex)
+{
+    Arena& arena = arenas[(size_t) arenaIndex];
+    World& world = *arena.world;
+    int numAgents = getNumAgents();
+    int firstAgent = arenaIndex * settings.agentsPerArena;
+
+    World::ShipInputs inputs = {};
+    for (int s = 0; s < settings.agentsPerArena; ++s)
+    {
+        auto action = [&] (int value) { return clampUnit (actions[value * numAgents + firstAgent + s]); };
+
+        ShipInput& input = inputs[s];
+        input.human = true;
+        input.move = { action (HELIGOLAND_ACTION_MOVE_X), action (HELIGOLAND_ACTION_MOVE_Y) };
+        input.aim = { action (HELIGOLAND_ACTION_AIM_X), action (HELIGOLAND_ACTION_AIM_Y) };
+        input.fire = action (HELIGOLAND_ACTION_FIRE) > 0.5f;
+    }
+
+    float stepTime = 1.0f / std::max (1.0f, config.simPhysicsRate);
+    for (int tick = 0; tick < settings.ticksPerStep && ! world.isOver(); ++tick)
+        world.update (stepTime, inputs);
+
+    bool finished = world.isOver() || world.getMatchTime() >= settings.maxEpisodeTime;
+    int winner = world.isOver() ? world.getWinnerIndex() : -1;
+
+    const auto& ships = world.getShips();
+    for (int s = 0; s < settings.agentsPerArena; ++s)
+    {
+        const Ship& ship = *ships[s];
+        float dealt = ship.getDamageDealt() - arena.lastDamageDealt[s];
+        float taken = arena.lastHealth[s] - ship.getHealth();
+        arena.lastDamageDealt[s] = ship.getDamageDealt();
+        arena.lastHealth[s] = ship.getHealth();
+
+        float reward = (dealt - taken) / config.shipMaxHealth;
+        if (finished && winner >= 0)
+            reward += winner == getSide (settings.mode, s) ? 1.0f : -1.0f;
+
+        rewards[firstAgent + s] = reward;
+        dones[firstAgent + s] = finished ? 1 : 0;
+    }
+
+    if (finished)
+    {
+        numEpisodesFinished++;
+        startEpisode (arenaIndex);
+    }
+
+    writeObservations (arenaIndex);
+}
+
+void VectorEnv::writeObservations (int arenaIndex)
+{
+    const World& world = *arenas[(size_t) arenaIndex].world;
+    const auto& ships = world.getShips();
+    int numAgents = getNumAgents();
+    int numShips = world.getNumShips();
+    float arenaWidth = world.getArenaWidth();
+    float arenaHeight = world.getArenaHeight();
+
+    for (int s = 0; s < settings.agentsPerArena; ++s)
+    {
+        int agent = arenaIndex * settings.agentsPerArena + s;
+        auto write = [&] (int value, float x) { observations[value * numAgents + agent] = x; };
+
+        const Ship& self = *ships[s];
+        Vec2 pos = self.getPosition();
+        Vec2 heading = self.getHeading();
+        float speedScale = 1.0f / std::max (1.0f, self.getMaxSpeed());
+        Vec2 crosshair = self.getCrosshairPosition() - pos;
+        float rangeScale = 1.0f / std::max (1.0f, self.getMaxRange());
+
+        write (HELIGOLAND_OBS_X, pos.x / arenaWidth);
+        write (HELIGOLAND_OBS_Y, pos.y / arenaHeight);
+        write (HELIGOLAND_OBS_HEADING_X, heading.x);
+        write (HELIGOLAND_OBS_HEADING_Y, heading.y);
+        write (HELIGOLAND_OBS_VELOCITY_X, self.getVelocity().x * speedScale);
+        write (HELIGOLAND_OBS_VELOCITY_Y, self.getVelocity().y * speedScale);
+        write (HELIGOLAND_OBS_HEALTH, self.getHealth() / self.getMaxHealth());
+        write (HELIGOLAND_OBS_RELOAD, self.getReloadProgress());
+        write (HELIGOLAND_OBS_CROSSHAIR_X, crosshair.x * rangeScale);
+        write (HELIGOLAND_OBS_CROSSHAIR_Y, crosshair.y * rangeScale);
+        write (HELIGOLAND_OBS_WIND_X, world.getWind().x);
+        write (HELIGOLAND_OBS_WIND_Y, world.getWind().y);
+        write (HELIGOLAND_OBS_TIME, world.getMatchTime() / settings.maxEpisodeTime);
+
+        // Other ships, in index order
+        int base = HELIGOLAND_OBS_SELF_SIZE;
+        for (int i = 0; i < World::MAX_SHIPS; ++i)
+        {
+            if (i == s)
+                continue;
+
+            const Ship* other = i < numShips ? ships[i].get() : nullptr;
+            bool present = other != nullptr && other->isAlive();
+            Vec2 offset = present ? other->getPosition() - pos : Vec2 { 0, 0 };
+            Vec2 otherHeading = present ? other->getHeading() : Vec2 { 0, 0 };
+            Vec2 velocity = present ? other->getVelocity() * speedScale : Vec2 { 0, 0 };
+
+            write (base + HELIGOLAND_OBS_SHIP_PRESENT, present ? 1.0f : 0.0f);
+            write (base + HELIGOLAND_OBS_SHIP_ENEMY, present && world.areEnemies (s, i) ? 1.0f : 0.0f);
+            write (base + HELIGOLAND_OBS_SHIP_X, offset.x / arenaWidth);
+            write (base + HELIGOLAND_OBS_SHIP_Y, offset.y / arenaHeight);
+            write (base + HELIGOLAND_OBS_SHIP_HEADING_X, otherHeading.x);
+            write (base + HELIGOLAND_OBS_SHIP_HEADING_Y, otherHeading.y);
+            write (base + HELIGOLAND_OBS_SHIP_VELOCITY_X, velocity.x);
+            write (base + HELIGOLAND_OBS_SHIP_VELOCITY_Y, velocity.y);
+            write (base + HELIGOLAND_OBS_SHIP_HEALTH, present ? other->getHealth() / other->getMaxHealth() : 0.0f);
+            base += HELIGOLAND_OBS_SHIP_SIZE;
+        }
+
+        // The nearest enemy shells, kept sorted by insertion
+        std::array<const Shell*, HELIGOLAND_OBS_SHELLS> nearest = {};
+        std::array<float, HELIGOLAND_OBS_SHELLS> nearestDistance = {};
+        int numNearest = 0;
+
+        for (const Shell& shell : world.getShells())
+        {
+            int owner = shell.getOwnerIndex();
+            if (! shell.isAlive() || shell.hasLanded() || owner == s || ! world.areEnemies (s, owner))
+                continue;
+
+            float distance = (shell.getPosition() - pos).lengthSquared();
+            if (numNearest == HELIGOLAND_OBS_SHELLS && distance >= nearestDistance[numNearest - 1])
+                continue;
+
+            int slot = std::min (numNearest, HELIGOLAND_OBS_SHELLS - 1);
+            while (slot > 0 && nearestDistance[slot - 1] > distance)
+            {
+                nearest[slot] = nearest[slot - 1];
+                nearestDistance[slot] = nearestDistance[slot - 1];
+                slot--;
+            }
+            nearest[slot] = &shell;
+            nearestDistance[slot] = distance;
+            numNearest = std::min (numNearest + 1, (int) HELIGOLAND_OBS_SHELLS);
+        }
+
+        for (int i = 0; i < HELIGOLAND_OBS_SHELLS; ++i)
+        {
+            const Shell* shell = i < numNearest ? nearest[i] : nullptr;
+            Vec2 offset = shell != nullptr ? shell->getPosition() - pos : Vec2 { 0, 0 };
+            Vec2 velocity = shell != nullptr ? shell->getVelocity() * speedScale : Vec2 { 0, 0 };
+
+            write (base + HELIGOLAND_OBS_SHELL_PRESENT, shell != nullptr ? 1.0f : 0.0f);
+            write (base + HELIGOLAND_OBS_SHELL_X, offset.x / arenaWidth);
+            write (base + HELIGOLAND_OBS_SHELL_Y, offset.y / arenaHeight);
+            write (base + HELIGOLAND_OBS_SHELL_VELOCITY_X, velocity.x);
+            write (base + HELIGOLAND_OBS_SHELL_VELOCITY_Y, velocity.y);
+            base += HELIGOLAND_OBS_SHELL_SIZE;
+        }
+    }
+}
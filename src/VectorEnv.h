@@ -0,0 +1,85 @@
+#pragma once
+
+#include "HeligolandEnv.h"
+#include "World.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class ShipHulls;
+
+// =============================================================================
+// VectorEnv
+// The engine behind the C environment API in HeligolandEnv.h: a set of worlds
+// stepped in lockstep by a pool of threads that lives as long as the
+// environment. Each thread owns a fixed slice of the arenas and writes its
+// agents' observations straight into the caller's buffers, so a step is one
+// wake-up per thread and no allocation outside the simulation itself.
+// =============================================================================
+
+class VectorEnv
+{
+public:
+    struct Settings
+    {
+        int numArenas = 64;
+        int agentsPerArena = 1;
+        GameMode mode = GameMode::Duel;
+        int numThreads = 0;             // 0 = one per core
+        int ticksPerStep = 4;
+        float maxEpisodeTime = 300.0f;
+        uint64_t seed = 0;
+    };
+
+    VectorEnv (const ShipHulls& hulls, const Settings& settings);
+    ~VectorEnv();
+
+    // False if the settings can't be run (no arenas, more agents than ships...)
+    static bool isValid (const Settings& settings);
+
+    int getNumAgents() const                { return settings.numArenas * settings.agentsPerArena; }
+    int getNumThreads() const               { return (int) workers.size() + 1; }
+    uint64_t getNumEpisodesFinished() const { return numEpisodesFinished.load(); }
+
+    // See heligoland_env_reset() and heligoland_env_step()
+    void reset (float* observations);
+    void step (const float* actions, float* observations, float* rewards, uint8_t* dones);
+
+private:
+    struct Arena
+    {
+        std::unique_ptr<World> world;
+        uint64_t episode = 0;
+
+        // Per agent, at the end of the last step
+        std::array<float, World::MAX_SHIPS> lastHealth = {};
+        std::array<float, World::MAX_SHIPS> lastDamageDealt = {};
+    };
+
+    Settings settings;
+    std::vector<Arena> arenas;
+
+    // The job the pool is working on
+    const float* actions = nullptr;
+    float* observations = nullptr;
+    float* rewards = nullptr;
+    uint8_t* dones = nullptr;
+    bool resetting = false;
+
+    std::vector<std::thread> workers;
+    std::atomic<uint32_t> jobNumber { 0 };
+    std::atomic<int> numBusy { 0 };
+    std::atomic<bool> quitting { false };
+    std::atomic<uint64_t> numEpisodesFinished { 0 };
+
+    void runJob();
+    void workerLoop (int slice);
+    void runSlice (int slice);
+
+    void startEpisode (int arenaIndex);
+    void stepArena (int arenaIndex);
+    void writeObservations (int arenaIndex);
+};
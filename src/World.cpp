@@ -0,0 +1,1043 @@
+#include "World.h"
+#include "AllocTracker.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <type_traits>
+
+// Snapshots are copied around as plain memory
+static_assert (std::is_trivially_copyable_v<WorldSnapshot>);
+
+// Ships emit particles under their own index
+static_assert (World::MAX_SHIPS <= ParticlePool::MAX_EMITTERS);
+
+namespace
+{
+    // When enabled, adds the time until it goes out of scope to seconds and counts one more
+    class ProfileScope
+    {
+    public:
+        ProfileScope (bool enabled_, double& seconds_, uint64_t& count_)
+            : enabled (enabled_), seconds (seconds_), count (count_)
+        {
+            if (enabled)
+                start = std::chrono::steady_clock::now();
+        }
+
+        ~ProfileScope()
+        {
+            if (! enabled)
+                return;
+
+            seconds += std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+            count++;
+        }
+
+    private:
+        bool enabled;
+        double& seconds;
+        uint64_t& count;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+World::World (const ShipHulls& hulls_)
+    : hulls (hulls_)
+{
+    for (int i = 0; i < MAX_SHIPS; ++i)
+        aiControllers[i] = std::make_unique<AIController>();
+
+    islands.reserve (MAX_ISLANDS);
+
+    // Enough that a normal match never grows them, so steady-state steps don't allocate
+    shells.reserve (WorldSnapshot::MAX_SHELLS);
+    events.reserve (128);
+    aiEnemies.reserve (MAX_SHIPS);
+    aiFriendlies.reserve (MAX_SHIPS);
+}
+
+World::~World() = default;
+
+void World::setArenaSize (float width, float height)
+{
+    arenaWidth = width;
+    arenaHeight = height;
+}
+
+void World::setCosmeticsEnabled (bool enabled)
+{
+    // The pool is only sized once something will be drawn, headless worlds never need it
+    if (enabled && ! cosmeticsEnabled)
+        particles.configure();
+
+    cosmeticsEnabled = enabled;
+
+    for (auto& ship : ships)
+        if (ship)
+            ship->setCosmeticsEnabled (enabled);
+
+    if (! enabled)
+        particles.clear();
+}
+
+void World::setAIParams (int shipIndex, const AIParams& params)
+{
+    aiControllers[shipIndex]->setParams (params);
+}
+
+void World::start (GameMode mode_, const ShipTypes& shipTypes, uint64_t matchSeed_)
+{
+    clear();
+    appliedInputs = {};
+
+    // Picks up budget changes from the config
+    if (cosmeticsEnabled)
+        particles.configure();
+
+    mode = mode_;
+    matchSeed = matchSeed_;
+    setupRandom.seed (matchSeed, (uint64_t) RandomStream::MatchSetup);
+    windRandom.seed (matchSeed, (uint64_t) RandomStream::Wind);
+    currentRandom.seed (matchSeed, (uint64_t) RandomStream::Current);
+
+    // Create ships at starting positions
+    bool isTeamMode = (mode == GameMode::Teams || mode == GameMode::Battle);
+    int numShips = getNumShipsForMode (mode);
+
+    for (int i = 0; i < numShips; ++i)
+    {
+        int team = isTeamMode ? getTeam (i) : -1;
+
+        int shipType = shipTypes[i];
+        if (shipType < 0)
+            shipType = setupRandom.nextInt (NUM_SHIP_TYPES);
+
+        float shipLength = hulls.getShipLength (shipType);
+        float shipWidth = hulls.getShipWidth (shipType);
+
+        ships[i] = matchMemory.make<Ship> (fleet, particles, i, getShipStartPosition (i), getShipStartAngle (i), shipLength, shipWidth, team, shipType, matchSeed, &matchMemory);
+        ships[i]->setCosmeticsEnabled (cosmeticsEnabled);
+        aiControllers[i]->reset (matchSeed, i);
+    }
+
+    startDelay = config.gameStartDelay;
+
+    spawnIslands();
+
+    // Initialize wind (minimum strength)
+    float windAngle = windRandom.nextFloat() * 2.0f * pi;
+    float windStrength = windRandom.nextFloat (config.windMinStrength, 1.0f);
+    wind = Vec2::fromAngle (windAngle) * windStrength;
+    targetWind = wind;
+    windChangeTimer = config.windChangeInterval;
+
+    // Initialize current
+    float currentAngle = currentRandom.nextFloat() * 2.0f * pi;
+    float currentStrengthInit = currentRandom.nextFloat (config.currentMinStrength, config.currentMaxStrength);
+    current = Vec2::fromAngle (currentAngle) * currentStrengthInit;
+    targetCurrent = current;
+    currentChangeTimer = config.currentChangeInterval;
+}
+
+void World::clear()
+{
+    for (auto& ship : ships)
+        ship.reset();
+
+    shells.clear();
+    particles.clear();
+    islands.clear();
+    events.clear();
+
+    // Nothing is left in the arena now, so the whole match's memory goes in one go
+    matchMemory.reset (MAX_SHIPS * Ship::getMatchMemorySize() + MAX_ISLANDS * Island::getMatchMemorySize());
+
+    over = false;
+    winnerIndex = -1;
+    matchTime = 0.0f;
+    aiTimer = 0.0f;
+    aiElapsed = 0.0f;
+}
+
+void World::hashState (StateHasher& hasher) const
+{
+    hasher.beginGroup (StateGroup::Match);
+    hasher.add ("arenaWidth", arenaWidth);
+    hasher.add ("arenaHeight", arenaHeight);
+    hasher.add ("over", over);
+    hasher.add ("winner", winnerIndex);
+    hasher.add ("matchTime", matchTime);
+    hasher.add ("startDelay", startDelay);
+    hasher.add ("aiTimer", aiTimer);
+    hasher.add ("aiElapsed", aiElapsed);
+    hasher.add ("wind", wind);
+    hasher.add ("targetWind", targetWind);
+    hasher.add ("windChangeTimer", windChangeTimer);
+    hasher.add ("current", current);
+    hasher.add ("targetCurrent", targetCurrent);
+    hasher.add ("currentChangeTimer", currentChangeTimer);
+    hasher.add ("setupRandom", setupRandom.getState());
+    hasher.add ("windRandom", windRandom.getState());
+    hasher.add ("currentRandom", currentRandom.getState());
+
+    for (int i = 0; i < MAX_SHIPS; ++i)
+    {
+        if (! ships[i])
+            continue;
+
+        hasher.beginGroup (StateGroup::Ship, i);
+        ships[i]->hashState (hasher);
+
+        hasher.beginGroup (StateGroup::AI, i);
+        aiControllers[i]->hashState (hasher);
+    }
+
+    hasher.beginGroup (StateGroup::Shells);
+    hasher.add ("count", (int) shells.size());
+    for (size_t i = 0; i < shells.size(); ++i)
+    {
+        hasher.setItem ((int) i);
+        shells[i].hashState (hasher);
+    }
+}
+
+bool World::saveSnapshot (WorldSnapshot& snapshot) const
+{
+    if (shells.size() > (size_t) WorldSnapshot::MAX_SHELLS)
+        return false;
+
+    snapshot.matchSeed = matchSeed;
+    snapshot.mode = mode;
+    snapshot.over = over;
+    snapshot.winnerIndex = winnerIndex;
+    snapshot.matchTime = matchTime;
+    snapshot.startDelay = startDelay;
+    snapshot.aiTimer = aiTimer;
+    snapshot.aiElapsed = aiElapsed;
+    snapshot.wind = wind;
+    snapshot.targetWind = targetWind;
+    snapshot.windChangeTimer = windChangeTimer;
+    snapshot.current = current;
+    snapshot.targetCurrent = targetCurrent;
+    snapshot.currentChangeTimer = currentChangeTimer;
+    snapshot.setupRandom = setupRandom;
+    snapshot.windRandom = windRandom;
+    snapshot.currentRandom = currentRandom;
+
+    snapshot.fleet = fleet;
+    snapshot.shipMask = 0;
+    for (int i = 0; i < MAX_SHIPS; ++i)
+    {
+        if (! ships[i])
+            continue;
+
+        snapshot.shipMask |= 1u << i;
+        ships[i]->getState (snapshot.ships[i]);
+        snapshot.ai[i] = *aiControllers[i];
+    }
+
+    snapshot.numShells = (int) shells.size();
+    std::copy (shells.begin(), shells.end(), snapshot.shells.begin());
+    return true;
+}
+
+bool World::restoreSnapshot (const WorldSnapshot& snapshot)
+{
+    uint32_t shipMask = 0;
+    for (int i = 0; i < MAX_SHIPS; ++i)
+        if (ships[i])
+            shipMask |= 1u << i;
+
+    if (snapshot.matchSeed != matchSeed || snapshot.mode != mode || snapshot.shipMask != shipMask)
+        return false;
+
+    over = snapshot.over;
+    winnerIndex = snapshot.winnerIndex;
+    matchTime = snapshot.matchTime;
+    startDelay = snapshot.startDelay;
+    aiTimer = snapshot.aiTimer;
+    aiElapsed = snapshot.aiElapsed;
+    wind = snapshot.wind;
+    targetWind = snapshot.targetWind;
+    windChangeTimer = snapshot.windChangeTimer;
+    current = snapshot.current;
+    targetCurrent = snapshot.targetCurrent;
+    currentChangeTimer = snapshot.currentChangeTimer;
+    setupRandom = snapshot.setupRandom;
+    windRandom = snapshot.windRandom;
+    currentRandom = snapshot.currentRandom;
+    fleet = snapshot.fleet;
+
+    for (int i = 0; i < MAX_SHIPS; ++i)
+    {
+        if (! ships[i])
+            continue;
+
+        ships[i]->setState (snapshot.ships[i]);
+        *aiControllers[i] = snapshot.ai[i];
+    }
+
+    // Reserved once, so restoring never allocates
+    shells.reserve (WorldSnapshot::MAX_SHELLS);
+    shells.assign (snapshot.shells.begin(), snapshot.shells.begin() + snapshot.numShells);
+
+    events.clear();
+    return true;
+}
+
+void World::spawnIslands()
+{
+    int numShips = getNumShipsForMode (mode);
+
+    int numIslands = 1 + setupRandom.nextInt (MAX_ISLANDS); // 1-5 islands
+    for (int i = 0; i < numIslands; ++i)
+    {
+        bool validPosition = false;
+        Vec2 islandCenter;
+        float islandRadius = setupRandom.nextFloat (config.islandMinRadius, config.islandMaxRadius);
+
+        int attempts = 0;
+        while (!validPosition && attempts < 50)
+        {
+            attempts++;
+
+            // Random position with margin from edges
+            float margin = islandRadius + config.islandEdgeMargin;
+            islandCenter.x = margin + setupRandom.nextFloat() * (arenaWidth - 2 * margin);
+            islandCenter.y = margin + setupRandom.nextFloat() * (arenaHeight - 2 * margin);
+
+            validPosition = true;
+
+            // Check against ship starting positions
+            for (int s = 0; s < numShips; ++s)
+            {
+                Vec2 shipStart = getShipStartPosition (s);
+                float minDist = islandRadius + config.islandShipClearance;
+
+                if ((shipStart - islandCenter).length() < minDist)
+                {
+                    validPosition = false;
+                    break;
+                }
+            }
+
+            // Check against other islands
+            for (const auto& other : islands)
+            {
+                float minDist = islandRadius + other.getBoundingRadius() + config.islandIslandClearance;
+
+                if ((other.getCenter() - islandCenter).length() < minDist)
+                {
+                    validPosition = false;
+                    break;
+                }
+            }
+        }
+
+        if (validPosition)
+        {
+            islands.emplace_back (islandCenter, islandRadius, setupRandom.nextSeed(), &matchMemory);
+        }
+    }
+}
+
+void World::refreshShipStats()
+{
+    for (auto& ship : ships)
+        if (ship)
+            ship->refreshStats();
+}
+
+void World::updateWind (float dt)
+{
+    // Update wind change timer
+    windChangeTimer -= dt;
+    if (windChangeTimer <= 0)
+    {
+        // Pick new target wind - minor adjustment from current wind
+        float currentAngle = std::atan2 (wind.y, wind.x);
+        float angleChange = windRandom.nextSigned() * config.windAngleChangeMax;
+        float newAngle = currentAngle + angleChange;
+
+        // Small strength change, minimum strength enforced
+        float currentStrength = wind.length();
+        float strengthChange = (windRandom.nextFloat() - 0.5f) * config.windStrengthChangeMax;
+        float newStrength = std::clamp (currentStrength + strengthChange, config.windMinStrength, 1.0f);
+
+        targetWind = Vec2::fromAngle (newAngle) * newStrength;
+        windChangeTimer = config.windChangeInterval;
+    }
+
+    // Slowly lerp wind toward target
+    wind.x += (targetWind.x - wind.x) * config.windLerpSpeed * dt;
+    wind.y += (targetWind.y - wind.y) * config.windLerpSpeed * dt;
+}
+
+void World::updateCurrent (float dt)
+{
+    // Update current change timer
+    currentChangeTimer -= dt;
+    if (currentChangeTimer <= 0)
+    {
+        // Pick new target current - minor adjustment from current direction
+        float currentAngle = std::atan2 (current.y, current.x);
+        float angleChange = currentRandom.nextSigned() * config.windAngleChangeMax;
+        float newAngle = currentAngle + angleChange;
+
+        // Small strength change, minimum strength enforced
+        float currentStrength = current.length();
+        float strengthChange = (currentRandom.nextFloat() - 0.5f) * config.windStrengthChangeMax;
+        float newStrength = std::clamp (currentStrength + strengthChange, config.currentMinStrength, config.currentMaxStrength);
+
+        targetCurrent = Vec2::fromAngle (newAngle) * newStrength;
+        currentChangeTimer = config.currentChangeInterval;
+    }
+
+    // Slowly lerp current toward target
+    current.x += (targetCurrent.x - current.x) * config.currentLerpSpeed * dt;
+    current.y += (targetCurrent.y - current.y) * config.currentLerpSpeed * dt;
+}
+
+void World::update (float dt, const ShipInputs& inputs)
+{
+    AllocTracker::Scope scope (AllocTracker::Tag::Simulation);
+    events.clear();
+    matchTime += dt;
+
+    // Update start delay
+    if (startDelay > 0)
+    {
+        startDelay -= dt;
+    }
+
+    // Update wind and current
+    updateWind (dt);
+    updateCurrent (dt);
+
+    // AI decides at a lower rate than physics, ships keep the last decision in between
+    aiTimer -= dt;
+    aiElapsed += dt;
+    bool aiDecides = aiTimer < dt * 0.5f;
+    float aiDt = aiElapsed;
+    if (aiDecides)
+    {
+        float rate = aiRate > 0.0f ? aiRate : config.simAIRate;
+        aiTimer = std::max (0.0f, aiTimer + (rate > 0.0f ? 1.0f / rate : 0.0f));
+        aiElapsed = 0.0f;
+    }
+
+    // Fade and move the particles from earlier steps before ships add this step's
+    if (cosmeticsEnabled)
+        particles.update (dt, wind);
+
+    // Update ships
+    appliedInputs = {};
+    int numShips = getNumShipsForMode (mode);
+    for (int shipIdx = 0; shipIdx < numShips; ++shipIdx)
+    {
+        if (! ships[shipIdx] || ! ships[shipIdx]->isVisible())
+            continue; // Skip dead ships
+
+        Vec2 moveInput, aimInput;
+        bool fireInput = false;
+
+        const ShipInput& input = inputs[shipIdx];
+
+        if (input.human)
+        {
+            moveInput = input.move;
+            aimInput = input.aim;
+            // Only accept fire input after start delay
+            fireInput = (startDelay <= 0) && input.fire;
+        }
+        else
+        {
+            if (aiDecides)
+            {
+                // Find all living enemy ships for AI
+                AllocTracker::Scope scope (AllocTracker::Tag::AI);
+                ProfileScope timer (profiling, updateTimes.aiSeconds, updateTimes.aiUpdates);
+                aiEnemies.clear();
+                aiFriendlies.clear();
+                for (int j = 0; j < numShips; ++j)
+                {
+                    if (j == shipIdx || !ships[j] || !ships[j]->isAlive())
+                        continue;
+                    if (areEnemies (shipIdx, j))
+                        aiEnemies.push_back (ships[j].get());
+                    else
+                        aiFriendlies.push_back (ships[j].get());
+                }
+
+                aiControllers[shipIdx]->update (aiDt, *ships[shipIdx], aiEnemies, aiFriendlies, shells, islands, arenaWidth, arenaHeight);
+            }
+
+            moveInput = aiControllers[shipIdx]->getMoveInput();
+            aimInput = aiControllers[shipIdx]->getAimInput();
+            fireInput = aiControllers[shipIdx]->getFireInput();
+        }
+
+        appliedInputs[shipIdx] = { input.human, moveInput, aimInput, fireInput, input.hasCrosshair, input.crosshair };
+        {
+            ProfileScope timer (profiling, updateTimes.shipSeconds, updateTimes.shipUpdates);
+            ships[shipIdx]->update (dt, moveInput, aimInput, fireInput, arenaWidth, arenaHeight, current);
+        }
+
+        // Set crosshair directly for mouse aiming
+        if (input.human && input.hasCrosshair)
+            ships[shipIdx]->setCrosshairPosition (input.crosshair);
+
+        // Collect pending shells from ship
+        auto& pendingShells = ships[shipIdx]->getPendingShells();
+        if (! pendingShells.empty())
+            events.push_back ({ WorldEvent::Type::Fire, ships[shipIdx]->getPosition(), (float) pendingShells.size(), shipIdx });
+
+        for (auto& shell : pendingShells)
+            shells.push_back (std::move (shell));
+
+        pendingShells.clear();
+    }
+
+    // Update shells
+    updateShells (dt);
+
+    // Check for collisions
+    checkCollisions();
+
+    // Check for game over
+    checkGameOver();
+}
+
+void World::updateAftermath (float dt)
+{
+    events.clear();
+
+    if (cosmeticsEnabled)
+        particles.update (dt, wind);
+
+    // Keep updating ships (for smoke effects)
+    int numShips = getNumShipsForMode (mode);
+    for (int i = 0; i < numShips; ++i)
+        if (ships[i] && ships[i]->isVisible())
+            ships[i]->update (dt, { 0, 0 }, { 0, 0 }, false, arenaWidth, arenaHeight, current);
+
+    // Keep updating shells so they land and disappear
+    updateShells (dt);
+
+    // Kill landed shells and spawn splashes (normally done in checkCollisions)
+    for (auto& shell : shells)
+    {
+        if (shell.isAlive() && shell.hasLanded())
+        {
+            spawnExplosion (shell.getPosition(), false, config.explosionMaxRadius, config.explosionDuration);
+            shell.kill();
+        }
+    }
+
+}
+
+void World::updateShells (float dt)
+{
+    // Calculate wind drift force based on shell speed and max wind drift
+    float shellSpeed = config.shipMaxSpeed * config.shellSpeedMultiplier;
+    Vec2 windDrift = wind * shellSpeed * config.windMaxDrift;
+
+    for (auto& shell : shells)
+    {
+        shell.update (dt, windDrift);
+
+        // Check if shell hits an island (only while in flight, not after landing)
+        if (shell.isAlive() && !shell.hasLanded())
+        {
+            for (const auto& island : islands)
+            {
+                if (island.containsPoint (shell.getPosition()))
+                {
+                    shell.kill();
+                    break;
+                }
+            }
+        }
+    }
+
+    // Remove dead shells
+    shells.erase (
+        std::remove_if (shells.begin(), shells.end(), [] (const Shell& s)
+                        { return ! s.isAlive(); }),
+        shells.end());
+}
+
+void World::spawnExplosion (Vec2 position, bool isHit, float maxRadius, float duration)
+{
+    if (! cosmeticsEnabled)
+        return;
+
+    // Fades out over its duration, the renderer grows it as it goes
+    auto kind = isHit ? ParticlePool::Kind::Explosion : ParticlePool::Kind::Splash;
+    particles.spawn (kind, ParticlePool::noEmitter, { position, maxRadius, 1.0f, 1.0f / duration });
+}
+
+void World::checkCollisions()
+{
+    // Who last damaged each ship this step, for sink events
+    std::array<bool, MAX_SHIPS> wasAlive = {};
+    std::array<int, MAX_SHIPS> lastAttacker;
+    lastAttacker.fill (-1);
+    for (int i = 0; i < MAX_SHIPS; ++i)
+        wasAlive[i] = ships[i] && ships[i]->isAlive();
+
+    // Shell-to-ship collisions (only when shell has landed/splashed)
+    for (auto& shell : shells)
+    {
+        if (! shell.isAlive())
+            continue;
+        if (! shell.hasLanded())
+            continue; // Shells only hit when they land
+
+        for (auto& ship : ships)
+        {
+            if (! ship || ! ship->isVisible())
+                continue;
+            if (ship->getPlayerIndex() == shell.getOwnerIndex())
+                continue; // Don't hit own ship
+
+            // First do a quick bounding check, then pixel-perfect if within bounds
+            Vec2 diff = shell.getPosition() - ship->getPosition();
+            float dist = diff.length();
+            float boundingRadius = ship->getLength() / 2.0f + shell.getSplashRadius();
+
+            if (dist < boundingRadius && hulls.checkShipHit (*ship, shell.getPosition()))
+            {
+                ship->takeDamage (shell.getDamage(), shell.getPosition());
+
+                // Track damage dealt by the shooter
+                int ownerIdx = shell.getOwnerIndex();
+                if (ownerIdx >= 0 && ownerIdx < MAX_SHIPS && ships[ownerIdx])
+                    ships[ownerIdx]->addDamageDealt (shell.getDamage());
+
+                // Spawn hit explosion
+                spawnExplosion (shell.getPosition(), true, config.explosionMaxRadius, config.explosionDuration);
+
+                int shipIdx = ship->getPlayerIndex();
+                events.push_back ({ WorldEvent::Type::Hit, shell.getPosition(), shell.getDamage(), shipIdx, ownerIdx });
+                lastAttacker[shipIdx] = ownerIdx;
+
+                // Check if ship was sunk
+                if (! ship->isAlive())
+                {
+                    // Big explosion for sinking
+                    spawnExplosion (ship->getPosition(), true, config.sinkExplosionMaxRadius, config.sinkExplosionDuration);
+                }
+
+                shell.kill();
+                break;
+            }
+        }
+
+        // Kill landed shells after checking for hits (they splash and disappear)
+        if (shell.hasLanded() && shell.isAlive())
+        {
+            // Spawn splash (miss) - hits are handled above
+            spawnExplosion (shell.getPosition(), false, config.explosionMaxRadius, config.explosionDuration);
+
+            events.push_back ({ WorldEvent::Type::Splash, shell.getPosition(), 0.0f, shell.getOwnerIndex() });
+
+            shell.kill();
+        }
+    }
+
+    // Ship-to-ship collisions using OBB (Separating Axis Theorem)
+    int numShips = getNumShipsForMode (mode);
+    for (int i = 0; i < numShips; ++i)
+    {
+        if (! ships[i] || ! ships[i]->isVisible())
+            continue;
+
+        for (int j = i + 1; j < numShips; ++j)
+        {
+            if (! ships[j] || ! ships[j]->isVisible())
+                continue;
+
+            // Bounding circles first, straight from the fleet, so distant pairs skip the corners
+            if (! fleet.mightCollide (i, j))
+                continue;
+
+            // Corners of both ships, kept up to date by the ships as they move
+            const Vec2x4& cornersA = ships[i]->getCorners();
+            const Vec2x4& cornersB = ships[j]->getCorners();
+
+            // Check if OBBs overlap using SAT
+            float minOverlap = 999999.0f;
+            Vec2 minAxis;
+
+            bool separated = false;
+
+            // Test 4 axes (2 from each rectangle - perpendicular to edges)
+            Vec2 axes[4] = {
+                (cornersA[1] - cornersA[0]).normalized(), // Ship A forward axis
+                (cornersA[3] - cornersA[0]).normalized(), // Ship A side axis
+                (cornersB[1] - cornersB[0]).normalized(), // Ship B forward axis
+                (cornersB[3] - cornersB[0]).normalized() // Ship B side axis
+            };
+
+            for (int a = 0; a < 4 && ! separated; ++a)
+            {
+                Vec2 axis = axes[a];
+                // Get perpendicular for proper separation axis
+                Vec2 perpAxis = { -axis.y, axis.x };
+
+                // Project both shapes onto axis
+                float minA, maxA, minB, maxB;
+                cornersA.project (perpAxis, minA, maxA);
+                cornersB.project (perpAxis, minB, maxB);
+
+                // Check for separation
+                if (maxA < minB || maxB < minA)
+                {
+                    separated = true;
+                }
+                else
+                {
+                    // Calculate overlap on this axis
+                    float overlap = std::min (maxA - minB, maxB - minA);
+                    if (overlap < minOverlap)
+                    {
+                        minOverlap = overlap;
+                        minAxis = perpAxis;
+                    }
+                }
+            }
+
+            if (! separated)
+            {
+                // OBB overlap detected - now do pixel-perfect check
+                Vec2 collisionPoint;
+                if (!hulls.checkShipCollision (*ships[i], *ships[j], collisionPoint))
+                    continue; // No actual pixel overlap
+
+                // Collision detected!
+                Vec2 velA = ships[i]->getVelocity();
+                Vec2 velB = ships[j]->getVelocity();
+
+                // Calculate relative speed for damage
+                Vec2 relVel = velA - velB;
+                float impactSpeed = relVel.length();
+
+                // Damage proportional to impact speed
+                float damage = impactSpeed * config.collisionDamageScale;
+                ships[i]->takeDamage (damage);
+                ships[j]->takeDamage (damage);
+
+                events.push_back ({ WorldEvent::Type::Collision, collisionPoint, impactSpeed, i, j });
+                lastAttacker[i] = j;
+                lastAttacker[j] = i;
+
+                // Determine collision normal (from i to j)
+                Vec2 diff = ships[j]->getPosition() - ships[i]->getPosition();
+                if (diff.dot (minAxis) < 0)
+                    minAxis = minAxis * -1.0f;
+
+                Vec2 collisionNormal = minAxis;
+
+                // Push ships apart first
+                float pushDist = minOverlap / 2.0f + 2.0f;
+                ships[i]->applyCollision (collisionNormal * -1.0f, pushDist, velA, velB);
+                ships[j]->applyCollision (collisionNormal, pushDist, velB, velA);
+            }
+        }
+    }
+
+    // Ship-to-island collisions
+    for (int i = 0; i < numShips; ++i)
+    {
+        if (!ships[i] || !ships[i]->isVisible())
+            continue;
+
+        // A copy: the corners tested stay where the ship was before any island pushed it
+        Vec2x4 corners = ships[i]->getCorners();
+
+        for (const auto& island : islands)
+        {
+            // Quick bounding circle check first
+            Vec2 shipPos = ships[i]->getPosition();
+            float maxShipRadius = ships[i]->getLength() / 2.0f;
+
+            if ((shipPos - island.getCenter()).length() > island.getBoundingRadius() + maxShipRadius)
+                continue;
+
+            // Check each corner of the ship
+            for (int c = 0; c < 4; ++c)
+            {
+                Vec2 corner = corners[c];
+                Vec2 pushDir;
+                float pushDist;
+
+                if (island.getCollisionResponse (corner, pushDir, pushDist))
+                {
+                    // Apply collision response (island is stationary)
+                    Vec2 shipVel = ships[i]->getVelocity();
+                    ships[i]->applyCollision (pushDir, pushDist, shipVel, Vec2 (0, 0));
+
+                    // Apply some damage based on impact speed
+                    float impactSpeed = std::abs (shipVel.dot (pushDir));
+                    if (impactSpeed > 2.0f)
+                    {
+                        float damage = impactSpeed * config.collisionDamageScale * 0.5f;
+                        ships[i]->takeDamage (damage);
+
+                        events.push_back ({ WorldEvent::Type::Grounding, shipPos, impactSpeed, i });
+                    }
+
+                    break; // Only handle one corner collision per frame
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < numShips; ++i)
+        if (wasAlive[i] && ! ships[i]->isAlive())
+            events.push_back ({ WorldEvent::Type::Sink, ships[i]->getPosition(), 0.0f, i, lastAttacker[i] });
+}
+
+void World::checkGameOver()
+{
+    if (over)
+        return;
+
+    // Helper to check if a ship can still fight (alive and not sinking)
+    auto canFight = [this] (int i) -> bool
+    {
+        return ships[i] && ships[i]->isAlive() && ! ships[i]->isSinking();
+    };
+
+    int numShips = getNumShipsForMode (mode);
+
+    if (mode == GameMode::Teams || mode == GameMode::Battle)
+    {
+        // Count fighting ships per team
+        int team0Alive = 0;
+        int team1Alive = 0;
+
+        for (int i = 0; i < numShips; ++i)
+        {
+            if (canFight (i))
+            {
+                if (getTeam (i) == 0)
+                    team0Alive++;
+                else
+                    team1Alive++;
+            }
+        }
+
+        // Game ends when one team is eliminated
+        if (team0Alive == 0 || team1Alive == 0)
+        {
+            if (team0Alive == 0 && team1Alive == 0)
+                winnerIndex = -1;  // Draw
+            else if (team0Alive > 0)
+                winnerIndex = 0;   // Team 1 wins (index 0)
+            else
+                winnerIndex = 1;   // Team 2 wins (index 1)
+
+            over = true;
+        }
+    }
+    else
+    {
+        // FFA and Duel modes - last ship standing wins
+        int aliveCount = 0;
+        int lastAlive = -1;
+
+        for (int i = 0; i < numShips; ++i)
+        {
+            if (canFight (i))
+            {
+                aliveCount++;
+                lastAlive = i;
+            }
+        }
+
+        if (aliveCount <= 1)
+        {
+            winnerIndex = lastAlive;
+            over = true;
+        }
+    }
+
+    if (over)
+        events.push_back ({ WorldEvent::Type::MatchEnd, { 0, 0 }, matchTime, winnerIndex });
+}
+
+Vec2 World::getShipStartPosition (int index) const
+{
+    float w = arenaWidth;
+    float h = arenaHeight;
+
+    if (mode == GameMode::Duel)
+    {
+        // 1v1 mode: ships on left and right, centered vertically
+        float margin = w * 0.15f;
+        if (index == 0)
+            return { margin, h / 2.0f };
+        else
+            return { w - margin, h / 2.0f };
+    }
+
+    if (mode == GameMode::Teams)
+    {
+        // 2v2 mode: teams on left and right sides
+        float margin = w * 0.15f;
+        float verticalSpacing = h * 0.25f;
+
+        if (index < 2)
+        {
+            // Team 0 (players 0, 1) on left
+            float x = margin;
+            float y = h / 2.0f + (index == 0 ? -verticalSpacing : verticalSpacing);
+            return { x, y };
+        }
+        else
+        {
+            // Team 1 (players 2, 3) on right
+            float x = w - margin;
+            float y = h / 2.0f + (index == 2 ? -verticalSpacing : verticalSpacing);
+            return { x, y };
+        }
+    }
+
+    if (mode == GameMode::Battle)
+    {
+        // 6v6 mode: 6 ships per team in a single column on each side
+        float margin = w * 0.12f;
+        int shipsPerTeam = 6;
+
+        int team = getTeam (index);
+        int row = (team == 0) ? index : index - shipsPerTeam;
+
+        float verticalSpacing = h / (shipsPerTeam + 1);
+        float y = verticalSpacing + row * verticalSpacing;
+
+        if (team == 0)
+            return { margin, y };
+        else
+            return { w - margin, y };
+    }
+
+    // FFA mode: Place ships equidistant in a circle around the center
+    Vec2 center = { w / 2.0f, h / 2.0f };
+    float radius = std::min (w, h) * 0.35f;
+    int numShips = getNumShipsForMode (mode);
+    float angleOffset = -pi / 2.0f;  // Start from top
+    float angle = angleOffset + (index * 2.0f * pi / numShips);
+    return center + Vec2::fromAngle (angle) * radius;
+}
+
+float World::getShipStartAngle (int index) const
+{
+    if (mode == GameMode::Duel)
+    {
+        // 1v1 mode: ships face each other
+        if (index == 0)
+            return 0.0f;  // Player 1 faces right
+        else
+            return pi;    // Player 2 faces left
+    }
+
+    if (mode == GameMode::Teams)
+    {
+        // 2v2 mode: teams face each other
+        if (index < 2)
+            return 0.0f;  // Team 0 faces right
+        else
+            return pi;    // Team 1 faces left
+    }
+
+    if (mode == GameMode::Battle)
+    {
+        // 6v6 mode: teams face each other
+        if (getTeam (index) == 0)
+            return 0.0f;  // Team 0 faces right
+        else
+            return pi;    // Team 1 faces left
+    }
+
+    // FFA mode: Point ships toward center from circle position
+    int numShips = getNumShipsForMode (mode);
+    float angleOffset = -pi / 2.0f;
+    float posAngle = angleOffset + (index * 2.0f * pi / numShips);
+    return posAngle + pi;  // Face toward center
+}
+
+int World::getTeam (int shipIndex) const
+{
+    return getTeamForMode (mode, shipIndex);
+}
+
+int World::getTeamForMode (GameMode mode, int shipIndex)
+{
+    if (mode == GameMode::Battle)
+    {
+        // Battle mode: ships 0-5 on team 0, ships 6-11 on team 1
+        return shipIndex < 6 ? 0 : 1;
+    }
+    // Teams/other modes: ships 0, 1 on team 0, ships 2, 3 on team 1
+    return shipIndex < 2 ? 0 : 1;
+}
+
+bool World::areEnemies (int playerA, int playerB) const
+{
+    if (mode == GameMode::FFA || mode == GameMode::Duel)
+        return playerA != playerB;  // Everyone is an enemy in FFA and Duel
+
+    return getTeam (playerA) != getTeam (playerB);
+}
+
+int World::getNumShipsForMode (GameMode mode)
+{
+    if (mode == GameMode::Duel)
+        return 2;
+    if (mode == GameMode::Triple)
+        return 3;
+    if (mode == GameMode::Battle)
+        return 12;
+    return 4;  // FFA and Teams
+}
+
+int World::getShipIndexForPlayer (GameMode mode, int playerIndex)
+{
+    if (mode == GameMode::Battle)
+    {
+        // In Battle mode:
+        // Player 0 -> Ship 0 (team 1)
+        // Player 1 -> Ship 1 (team 1)
+        // Player 2 -> Ship 6 (team 2)
+        // Player 3 -> Ship 7 (team 2)
+        if (playerIndex < 2)
+            return playerIndex;
+        else
+            return playerIndex + 4;  // 2->6, 3->7
+    }
+    // Other modes: direct mapping
+    return playerIndex;
+}
+
+int World::getPlayerIndexForShip (GameMode mode, int shipIndex)
+{
+    if (mode == GameMode::Battle)
+    {
+        // In Battle mode, only ships 0, 1, 6, 7 can be human-controlled
+        if (shipIndex == 0)
+            return 0;
+        if (shipIndex == 1)
+            return 1;
+        if (shipIndex == 6)
+            return 2;
+        if (shipIndex == 7)
+            return 3;
+        return -1;  // AI controlled
+    }
+    // Other modes: direct mapping (if within player count)
+    if (shipIndex < MAX_PLAYERS)
+        return shipIndex;
+    return -1;
+}
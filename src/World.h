@@ -0,0 +1,263 @@
+#pragma once
+
+#include "AIController.h"
+#include "Config.h"
+#include "Fleet.h"
+#include "Island.h"
+#include "MatchArena.h"
+#include "ParticlePool.h"
+#include "Random.h"
+#include "Shell.h"
+#include "Ship.h"
+#include "ShipHulls.h"
+#include "StateHash.h"
+#include <array>
+#include <memory>
+#include <vector>
+
+enum class GameMode
+{
+    FFA,      // Free for all - every ship for themselves
+    Teams,    // 2v2 - ships 0,1 vs ships 2,3
+    Duel,     // 1v1 - ship 0 vs ship 1
+    Triple,   // 1v1v1 - 3 ships
+    Battle    // 6v6 - ships 0-5 vs ships 6-11, up to 2 humans per team
+};
+
+// Control input for one ship for one simulation step
+struct ShipInput
+{
+    bool human = false;         // True if a human is driving this ship, otherwise the AI does
+    Vec2 move;
+    Vec2 aim;
+    bool fire = false;
+    bool hasCrosshair = false;  // Mouse aiming - crosshair is set directly
+    Vec2 crosshair;
+};
+
+// Something that happened during a step that the presentation layer may react to (sounds etc.)
+struct WorldEvent
+{
+    enum class Type
+    {
+        Fire,       // position = firing ship, magnitude = shells fired
+        Hit,        // position = shell impact, magnitude = damage
+        Splash,     // position = shell impact
+        Collision,  // position = contact point, magnitude = impact speed
+        Grounding,  // position = ship, magnitude = impact speed. Only damaging ones
+        Sink,       // position = ship
+        MatchEnd    // ship = winning ship or team (-1 for a draw), magnitude = match time
+    };
+
+    Type type = Type::Fire;
+    Vec2 position;
+    float magnitude = 0.0f;
+    int ship = -1;      // The ship it happened to, or the shooter for Fire and Splash
+    int other = -1;     // The shooter for Hit, the other ship for Collision, the last attacker for Sink
+};
+
+struct WorldSnapshot;
+
+// =============================================================================
+// World
+// The simulation of a single match: ships, shells, islands, AI and collisions.
+// Has no window, input or GPU dependency so it can also run headless.
+// =============================================================================
+
+class World
+{
+public:
+    static constexpr int MAX_SHIPS = Fleet::MAX_SHIPS;  // Maximum ships (for Battle mode 6v6)
+    static constexpr int MAX_PLAYERS = 4;     // Maximum human players
+    static constexpr int MAX_ISLANDS = 5;
+
+    // Logical arena size used when nothing else sets one (headless runs)
+    static constexpr float DEFAULT_ARENA_WIDTH = 1280.0f;
+    static constexpr float DEFAULT_ARENA_HEIGHT = 720.0f;
+
+    using ShipTypes = std::array<int, MAX_SHIPS>;
+    using ShipInputs = std::array<ShipInput, MAX_SHIPS>;
+
+    explicit World (const ShipHulls& hulls);
+    ~World();
+
+    void setArenaSize (float width, float height);
+    float getArenaWidth() const                 { return arenaWidth; }
+    float getArenaHeight() const                { return arenaHeight; }
+
+    // Bubbles, smoke and explosions only affect what is drawn, so they can be
+    // skipped when nobody is watching (fast-forward, headless). Gameplay is unchanged
+    void setCosmeticsEnabled (bool enabled);
+    bool areCosmeticsEnabled() const            { return cosmeticsEnabled; }
+
+    // Time spent in AI decisions and ship updates since profiling was turned on, for benchmarks
+    struct UpdateTimes
+    {
+        double aiSeconds = 0.0;
+        double shipSeconds = 0.0;
+        uint64_t aiUpdates = 0;
+        uint64_t shipUpdates = 0;
+    };
+
+    void setProfiling (bool enabled)            { profiling = enabled; updateTimes = {}; }
+    const UpdateTimes& getUpdateTimes() const   { return updateTimes; }
+
+    // AI decisions per second. Replays play back at the rate they were recorded with,
+    // without touching the global config. 0 follows config.simAIRate
+    void setAIRate (float rate)                 { aiRate = rate; }
+
+    // Tuning for the AI driving a ship, kept from match to match. Takes effect at the next start()
+    void setAIParams (int shipIndex, const AIParams& params);
+    const AIParams& getAIParams (int shipIndex) const  { return aiControllers[shipIndex]->getParams(); }
+
+    // Start a new match. shipTypes: 0-3, or -1 to pick at random.
+    // All randomness in the match is derived from matchSeed, so the same seed
+    // and inputs replay the same match.
+    void start (GameMode mode, const ShipTypes& shipTypes, uint64_t matchSeed);
+    void clear();
+
+    // Advance the match. Ships without a human input are driven by their AI controller
+    void update (float dt, const ShipInputs& inputs);
+
+    // After the match is decided: ships coast, shells land and effects play out
+    void updateAftermath (float dt);
+
+    // Rebakes the ships' stats after the config values behind them have changed
+    void refreshShipStats();
+
+    bool isOver() const                         { return over; }
+    int getWinnerIndex() const                  { return winnerIndex; }  // FFA: ship index, Teams: team index, -1 = draw
+    float getMatchTime() const                  { return matchTime; }
+    uint64_t getMatchSeed() const               { return matchSeed; }
+    GameMode getMode() const                    { return mode; }
+    int getNumShips() const                     { return getNumShipsForMode (mode); }
+
+    const std::array<MatchArena::Ptr<Ship>, MAX_SHIPS>& getShips() const { return ships; }
+    const std::vector<Shell>& getShells() const             { return shells; }
+    const ParticlePool& getParticles() const                { return particles; }  // Bubbles, smoke, splashes and explosions
+    const Fleet& getFleet() const                           { return fleet; }
+    const std::vector<Island>& getIslands() const           { return islands; }
+    const std::vector<WorldEvent>& getEvents() const        { return events; }  // Events from the last step
+    const MatchArena& getMatchMemory() const                { return matchMemory; }
+    const ShipInputs& getAppliedInputs() const              { return appliedInputs; }  // What each ship steered by in the last step, human or AI
+    Vec2 getWind() const                        { return wind; }
+    Vec2 getCurrent() const                     { return current; }
+
+    // Feeds all gameplay state into the hasher (for determinism checks)
+    void hashState (StateHasher& hasher) const;
+
+    // Copies the match state into / out of a snapshot without allocating.
+    // save fails if there are more shells than a snapshot holds, restore fails
+    // if the snapshot is from a different match.
+    bool saveSnapshot (WorldSnapshot& snapshot) const;
+    bool restoreSnapshot (const WorldSnapshot& snapshot);
+
+    int getTeam (int shipIndex) const;  // Returns 0 or 1 for team mode
+    bool areEnemies (int shipA, int shipB) const;
+
+    static int getNumShipsForMode (GameMode mode);
+    static int getTeamForMode (GameMode mode, int shipIndex);
+    static int getShipIndexForPlayer (GameMode mode, int playerIndex);  // Maps player slot to ship index
+    static int getPlayerIndexForShip (GameMode mode, int shipIndex);    // Maps ship index to player slot (-1 if AI)
+
+private:
+    const ShipHulls& hulls;
+
+    float arenaWidth = DEFAULT_ARENA_WIDTH;
+    float arenaHeight = DEFAULT_ARENA_HEIGHT;
+    bool cosmeticsEnabled = true;
+
+    GameMode mode = GameMode::FFA;
+    uint64_t matchSeed = 0;
+    bool over = false;
+    int winnerIndex = -1;
+    float matchTime = 0.0f;
+    float startDelay = 0.0f; // Delay before accepting fire input after the match starts
+    float aiTimer = 0.0f;    // Time until the next AI decision
+    float aiElapsed = 0.0f;  // Time since the last AI decision
+    float aiRate = 0.0f;     // 0 follows the config
+    bool profiling = false;
+    UpdateTimes updateTimes;
+
+    MatchArena matchMemory;  // Ships and islands come from here, so it's declared before them to outlive them
+    Fleet fleet;             // The ships' moving state, row i for ship i
+    std::array<MatchArena::Ptr<Ship>, MAX_SHIPS> ships;
+    std::array<std::unique_ptr<AIController>, MAX_SHIPS> aiControllers;
+    std::vector<Shell> shells;
+    ParticlePool particles;
+    std::vector<Island> islands;
+    std::vector<WorldEvent> events;
+    ShipInputs appliedInputs = {};
+
+    // Scratch lists handed to each AI decision, kept so deciding doesn't allocate
+    std::vector<const Ship*> aiEnemies;
+    std::vector<const Ship*> aiFriendlies;
+
+    // Match-wide random streams (ships and AI own their own)
+    Random setupRandom;
+    Random windRandom;
+    Random currentRandom;
+
+    // Wind system
+    Vec2 wind; // Current wind direction and strength (length = strength 0-1)
+    Vec2 targetWind; // Wind is slowly moving toward this target
+    float windChangeTimer = 0.0f;
+
+    // Current system (affects ship movement)
+    Vec2 current; // Current direction and strength (length = strength 0-1)
+    Vec2 targetCurrent; // Current is slowly moving toward this target
+    float currentChangeTimer = 0.0f;
+
+    void spawnIslands();
+    void updateWind (float dt);
+    void updateCurrent (float dt);
+    void updateShells (float dt);
+    void spawnExplosion (Vec2 position, bool isHit, float maxRadius, float duration);
+    void checkCollisions();
+    void checkGameOver();
+
+    Vec2 getShipStartPosition (int index) const;
+    float getShipStartAngle (int index) const;
+};
+
+// =============================================================================
+// WorldSnapshot
+// The gameplay state of a match at one step, for branching it (AI lookahead,
+// rollback, what-if tests). Plain data in fixed size arrays, so it can live in
+// preallocated buffers and be copied like any other value. Islands don't change
+// during a match and cosmetics (bubbles, smoke, explosions) are left out.
+// =============================================================================
+
+struct WorldSnapshot
+{
+    static constexpr int MAX_SHELLS = 512;
+
+    uint64_t matchSeed = 0;
+    GameMode mode = GameMode::FFA;
+    uint32_t shipMask = 0;  // Which ship slots are in use
+
+    bool over = false;
+    int winnerIndex = -1;
+    float matchTime = 0.0f;
+    float startDelay = 0.0f;
+    float aiTimer = 0.0f;
+    float aiElapsed = 0.0f;
+
+    Vec2 wind;
+    Vec2 targetWind;
+    float windChangeTimer = 0.0f;
+    Vec2 current;
+    Vec2 targetCurrent;
+    float currentChangeTimer = 0.0f;
+
+    Random setupRandom;
+    Random windRandom;
+    Random currentRandom;
+
+    Fleet fleet;
+    std::array<Ship::State, World::MAX_SHIPS> ships;
+    std::array<AIController, World::MAX_SHIPS> ai;
+
+    int numShells = 0;
+    std::array<Shell, MAX_SHELLS> shells;
+};
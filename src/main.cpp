@@ -1,8 +1,15 @@
 #include "Config.h"
 #include "Game.h"
+#include "Headless.h"
+#include <cstdio>
+#include <cstring>
 
-int runGame()
+int runGame (int argc, char* argv[])
 {
+    for (int i = 1; i < argc; ++i)
+        if (strcmp (argv[i], "--headless") == 0 || strcmp (argv[i], "--batch") == 0)
+            return runHeadless (argc, argv);
+
     //if (! config.load())
     //    config.save();
     config.startWatching();
@@ -14,6 +21,17 @@ int runGame()
         return 1;
     }
 
+    // --replay <file> watches a recorded match
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (strcmp (argv[i], "--replay") == 0 && ! game.playReplay (argv[i + 1]))
+        {
+            fprintf (stderr, "Couldn't load replay: %s\n", argv[i + 1]);
+            game.shutdown();
+            return 1;
+        }
+    }
+
     game.run();
     game.shutdown();
 
@@ -24,10 +42,7 @@ int runGame()
 
 int main (int argc, char* argv[])
 {
-    (void) argc;
-    (void) argv;
-
-    return runGame();
+    return runGame (argc, argv);
 }
 
 #endif